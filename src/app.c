@@ -5,10 +5,19 @@
  * Production-quality Zigbee Sleepy End Device with SHT31 sensor
  */
 
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_APP
+
 #include "app.h"
 #include "button.h"
 #include "sht31.h"
 #include "battery.h"
+#include "energy.h"
+#include "em_stats.h"
+#include "wake_trace.h"
+#include "wake_sched.h"
+#include "deferred_work.h"
+#include "report_filter.h"
 
 #include "af.h"
 #include "app/framework/plugin/network-steering/network-steering.h"
@@ -20,9 +29,6 @@
 #include "sl_simple_led_instances.h"
 #endif
 
-#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
-#include "sl_power_manager.h"
-#endif
 
 //==============================================================================
 // Private Variables
@@ -37,15 +43,54 @@ static AppContext_t appContext = {
   .buttonPressed = false
 };
 
-static sl_sleeptimer_timer_handle_t sensorTimer;
-static sl_sleeptimer_timer_handle_t fastPollTimer;
+static WakeSchedTask_t sensorTask;
+
+// Last health state written to the attribute (none yet)
+static uint8_t reportedSensorHealth = 0xFF;
+static WakeSchedTask_t fastPollTask;
+static WakeSchedTask_t batteryTask;
+static WakeSchedTask_t batteryWaitTask;
+static WakeSchedTask_t alertStopTask;
+
+// Measured-value write suppression
+static ReportFilter_t temperatureFilter =
+  REPORT_FILTER_INIT(APP_TEMP_QUANTUM_CENTI, APP_TEMP_HYSTERESIS_CENTI);
+static ReportFilter_t humidityFilter =
+  REPORT_FILTER_INIT(APP_HUMIDITY_QUANTUM_CENTI, APP_HUMIDITY_HYSTERESIS_CENTI);
+
+// Battery sample pending until the next transmission (or the wait timeout)
+static bool batterySampleDue = false;
+
+// ALERT wakeups requested (config or CLI); only armed while joined
+static bool sensorAlertWanted = false;
 
 //==============================================================================
 // Forward Declarations
 //==============================================================================
 
-static void sensor_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
-static void fast_poll_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void sensor_timer_callback(WakeSchedTask_t *task, void *data);
+static void sensor_alert_callback(void);
+static void sensor_alert_work(uint32_t arg0, uint32_t arg1);
+static void sensor_measurement_done(bool success,
+                                    int16_t temperature_centi,
+                                    uint16_t humidity_centi);
+static void sensor_data_work(uint32_t success, uint32_t packed);
+static void enter_state(AppState_t state);
+static bool state_is_joined(AppState_t state);
+static void start_sensor_schedule(void);
+static void stop_sensor_schedule(void);
+static void stop_sensor_alert(void);
+static void arm_sensor_alert_window(void);
+static void alert_stop_retry_callback(WakeSchedTask_t *task, void *data);
+static void start_sensor_timer(void);
+static void battery_timer_callback(WakeSchedTask_t *task, void *data);
+static void battery_wait_timer_callback(WakeSchedTask_t *task, void *data);
+static void request_battery_sample(void);
+static void battery_measurement_done(uint16_t voltage_mv);
+static void battery_data_work(uint32_t voltage, uint32_t unused);
+static void update_energy_attributes(uint8_t percentage);
+static void take_battery_sample(bool loaded);
+static void fast_poll_timer_callback(WakeSchedTask_t *task, void *data);
 static void transition_to_normal_poll(void);
 static void print_network_info(void);
 static void print_reset_info(void);
@@ -63,15 +108,6 @@ void emberAfMainInitCallback(void)
   app_init();
 }
 
-/**
- * @brief Main application tick
- * Called periodically
- */
-void emberAfMainTickCallback(void)
-{
-  app_process_action();
-}
-
 /**
  * @brief Stack status callback
  */
@@ -93,35 +129,95 @@ void emberAfPluginNetworkSteeringCompleteCallback(EmberStatus status,
 
   if (status == EMBER_SUCCESS) {
     APP_LOG("Successfully joined network!");
-    appContext.state = APP_STATE_JOINED_FAST_POLL;
     appContext.joinTimestamp = halCommonGetInt32uMillisecondTick();
 
-    // Enable fast polling for smooth interview
-    app_set_fast_poll(true);
-
-    // Start fast poll timeout timer (30 seconds)
-    sl_sleeptimer_start_timer_ms(&fastPollTimer,
-                                  APP_FAST_POLL_TIMEOUT_MS,
-                                  fast_poll_timer_callback,
-                                  NULL,
-                                  0,
-                                  0);
+    // Fast poll for a smooth interview, sensor and battery schedules start
+    enter_state(APP_STATE_JOINED_FAST_POLL);
 
-    APP_LOG("Fast poll enabled for %d seconds", APP_FAST_POLL_TIMEOUT_MS / 1000);
+    // First battery value goes out with the interview traffic
+    request_battery_sample();
 
   } else {
     APP_LOG("Join failed with status 0x%02X", status);
-    appContext.state = APP_STATE_NOT_JOINED;
+    enter_state(APP_STATE_NOT_JOINED);
     appContext.joinAttempts++;
   }
 }
 
+/**
+ * @brief Message sent callback
+ * Called once an outgoing message has left the radio (acked or not); a
+ * pending battery sample is taken here to see the supply under load.
+ */
+bool emberAfMessageSentCallback(EmberOutgoingMessageType type,
+                                uint16_t indexOrDestination,
+                                EmberApsFrame *apsFrame,
+                                uint16_t msgLen,
+                                uint8_t *message,
+                                EmberStatus status)
+{
+  (void)type;
+  (void)indexOrDestination;
+  (void)message;
+  (void)status;
+
+  em_stats_note_wake(EM_STATS_REASON_RADIO);
+  wake_sched_process();
+
+#if WAKE_TRACE_ENABLED
+  if (apsFrame->clusterId == ZCL_TEMP_MEASUREMENT_CLUSTER_ID
+      || apsFrame->clusterId == ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID) {
+    WAKE_TRACE_END(WAKE_PHASE_REPORT_TX);
+  }
+#else
+  (void)apsFrame;
+#endif
+
+  energy_add_radio_tx(msgLen);
+
+  if (batterySampleDue) {
+    take_battery_sample(true);
+  }
+
+  // Let the framework continue its own processing
+  return false;
+}
+
+/**
+ * @brief Pre-message received callback
+ * Accounts the receive airtime of every incoming APS frame
+ */
+bool emberAfPreMessageReceivedCallback(EmberAfIncomingMessage *incomingMessage)
+{
+  em_stats_note_wake(EM_STATS_REASON_RADIO);
+  energy_add_radio_rx(incomingMessage->msgLen);
+  wake_sched_process();
+
+  // Not handled here - let the framework process it
+  return false;
+}
+
+/**
+ * @brief Data poll completed callback (end device support plugin)
+ */
+void emberAfPluginEndDeviceSupportPollCompletedCallback(EmberStatus status)
+{
+  (void)status;
+
+  energy_add_radio_poll();
+
+  // Deadlines due by now ride on this wake instead of taking their own
+  wake_sched_process();
+}
+
 //==============================================================================
 // Public Functions - Application Logic
 //==============================================================================
 
 void app_init(void)
 {
+  app_log_init();
+
   APP_LOG("=================================================");
   APP_LOG("  EFR32MG1 Zigbee SED with SHT31");
   APP_LOG("  Version: %s", APP_SW_BUILD_ID);
@@ -131,6 +227,14 @@ void app_init(void)
 
   print_reset_info();
 
+  // Interrupt callbacks hand their work to the main loop through this
+  deferred_work_init();
+
+  // Start residency and charge accounting before anything draws current
+  em_stats_init();
+  energy_init();
+  wake_trace_init();
+
   // Initialize hardware drivers
   APP_LOG("Initializing hardware...");
 
@@ -143,75 +247,37 @@ void app_init(void)
   if (appContext.sensorInitialized) {
     APP_LOG("SHT31 sensor initialized on I2C (PC10/PC11)");
   } else {
-    APP_LOG("SHT31 sensor not found - using fallback values");
+    APP_LOG("SHT31 sensor not found - reporting invalid values until it responds");
   }
+  app_update_sensor_health();
 
   // Initialize battery monitor
   battery_init();
   APP_LOG("Battery monitor initialized");
 
-  // Start periodic sensor reading timer
-  sl_sleeptimer_start_periodic_timer_ms(&sensorTimer,
-                                         APP_SENSOR_READ_PERIOD_MS,
-                                         sensor_timer_callback,
-                                         NULL,
-                                         0,
-                                         0);
-  APP_LOG("Sensor timer started (period: %d ms)", APP_SENSOR_READ_PERIOD_MS);
+  // Wake on SHT31 ALERT instead of polling, if wired and enabled
+  sensorAlertWanted = APP_SENSOR_ALERT_MODE_ENABLED && appContext.sensorInitialized;
 
-  // Check network state
+  // Sensor and battery schedules run only while joined (enter_state())
   EmberNetworkStatus networkStatus = emberAfNetworkState();
   if (networkStatus == EMBER_JOINED_NETWORK) {
     APP_LOG("Already joined to network");
-    appContext.state = APP_STATE_JOINED_NORMAL;
+    enter_state(APP_STATE_JOINED_NORMAL);
     print_network_info();
 
     // Do initial sensor read
-    app_update_sensor_data();
+    app_start_sensor_measurement();
     app_update_battery_data();
 
   } else {
     APP_LOG("Not joined to any network");
-    appContext.state = APP_STATE_NOT_JOINED;
+    enter_state(APP_STATE_NOT_JOINED);
     APP_LOG("Press BTN0 short to join or long press to force join");
   }
 
   APP_LOG("Application initialization complete");
 }
 
-void app_process_action(void)
-{
-  // Process any pending button events
-  button_process();
-
-  // State-specific processing
-  switch (appContext.state) {
-    case APP_STATE_INIT:
-      // Should not stay here long
-      break;
-
-    case APP_STATE_NOT_JOINED:
-      // Waiting for user to trigger join
-      break;
-
-    case APP_STATE_JOINING:
-      // Network steering in progress
-      break;
-
-    case APP_STATE_JOINED_FAST_POLL:
-      // Fast poll active during interview
-      break;
-
-    case APP_STATE_JOINED_NORMAL:
-      // Normal operation
-      break;
-
-    case APP_STATE_LEAVING:
-      // Leaving network
-      break;
-  }
-}
-
 AppState_t app_get_state(void)
 {
   return appContext.state;
@@ -230,7 +296,7 @@ void app_start_join(void)
   }
 
   APP_LOG("Starting network join...");
-  appContext.state = APP_STATE_JOINING;
+  enter_state(APP_STATE_JOINING);
 
   // Use network steering plugin
   EmberStatus status = emberAfPluginNetworkSteeringStart();
@@ -238,7 +304,7 @@ void app_start_join(void)
     APP_LOG("Network steering started");
   } else {
     APP_LOG("Failed to start network steering: 0x%02X", status);
-    appContext.state = APP_STATE_NOT_JOINED;
+    enter_state(APP_STATE_NOT_JOINED);
   }
 }
 
@@ -250,12 +316,7 @@ void app_leave_network(void)
   }
 
   APP_LOG("Leaving network...");
-  appContext.state = APP_STATE_LEAVING;
-
-  // Stop fast poll if active
-  if (appContext.fastPollActive) {
-    app_set_fast_poll(false);
-  }
+  enter_state(APP_STATE_LEAVING);
 
   EmberStatus status = emberLeaveNetwork();
   if (status == EMBER_SUCCESS) {
@@ -285,69 +346,147 @@ void app_set_fast_poll(bool enable)
 void app_trigger_sensor_read(void)
 {
   APP_LOG("Manual sensor read triggered");
-  app_update_sensor_data();
+  app_start_sensor_measurement();
   app_update_battery_data();
 }
 
-void app_update_sensor_data(void)
+void app_start_sensor_measurement(void)
+{
+  // Result arrives in app_update_sensor_data() after the conversion time.
+  // The sample phase opens only here, so every path that ends it (timer,
+  // ALERT, CLI) has begun it too
+  if (!sht31_start_measurement(sensor_measurement_done)) {
+    APP_DEBUG("Sensor measurement already in progress");
+    return;
+  }
+  WAKE_TRACE_BEGIN(WAKE_PHASE_SAMPLE);
+}
+
+void app_update_sensor_data(bool success,
+                            int16_t temperature_centi,
+                            uint16_t humidity_centi)
 {
-  int16_t temperature_raw;
-  uint16_t humidity_raw;
-  float temperature_celsius;
-  float humidity_percent;
+  app_update_sensor_health();
+
+  if (success) {
+    appContext.sensorInitialized = true;
+    battery_set_temperature(temperature_centi);
+
+    // Values arrive in ZCL format (temperature: 0.01°C, humidity: 0.01%).
+    // Sign in the format rather than a %s argument, which the tokenized
+    // backend would copy into every record
+    if (temperature_centi < 0) {
+      APP_LOG("Sensor: temp=-%u.%02u°C, humidity=%u.%02u%%",
+              -temperature_centi / 100, -temperature_centi % 100,
+              humidity_centi / 100, humidity_centi % 100);
+    } else {
+      APP_LOG("Sensor: temp=%u.%02u°C, humidity=%u.%02u%%",
+              temperature_centi / 100, temperature_centi % 100,
+              humidity_centi / 100, humidity_centi % 100);
+    }
+
+    // Update ZCL attributes, skipping samples that only differ by noise
+    int32_t written;
+    bool changed = false;
+
+    WAKE_TRACE_BEGIN(WAKE_PHASE_ATTRIBUTE_WRITE);
+    if (report_filter_update(&temperatureFilter, temperature_centi, &written)) {
+      int16_t value = (int16_t)written;
+      emberAfWriteServerAttribute(APP_ENDPOINT,
+                                   ZCL_TEMP_MEASUREMENT_CLUSTER_ID,
+                                   ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID,
+                                   (uint8_t*)&value,
+                                   ZCL_INT16S_ATTRIBUTE_TYPE);
+      changed = true;
+    }
+
+    if (report_filter_update(&humidityFilter, humidity_centi, &written)) {
+      uint16_t value = (uint16_t)written;
+      emberAfWriteServerAttribute(APP_ENDPOINT,
+                                   ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID,
+                                   ZCL_RELATIVE_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID,
+                                   (uint8_t*)&value,
+                                   ZCL_INT16U_ATTRIBUTE_TYPE);
+      changed = true;
+    }
+    WAKE_TRACE_END(WAKE_PHASE_ATTRIBUTE_WRITE);
+
+    if (changed) {
+      // Reporting plugin sends from here if the change is reportable;
+      // nothing is sent when both writes were suppressed
+      WAKE_TRACE_BEGIN(WAKE_PHASE_REPORT_TX);
+    }
+
+    // Also after a suppressed sample: the ALERT that woke us must not stay
+    // asserted, or the next real move raises no edge
+    arm_sensor_alert_window();
+
+  } else {
+    // Keep the last good value; a dead sensor is flagged by the health state
+    APP_DEBUG("No sensor data this sample (health %d)", sht31_get_health());
+  }
+
+  WAKE_TRACE_END(WAKE_PHASE_SAMPLE);
+  WAKE_TRACE_BEGIN(WAKE_PHASE_RETURN_TO_SLEEP);
+}
+
+void app_update_sensor_health(void)
+{
+  uint8_t health = (uint8_t)sht31_get_health();
+
+  if (health == reportedSensorHealth) {
+    return;
+  }
 
-  // Read sensor
-  bool success = sht31_read(&temperature_celsius, &humidity_percent);
+  APP_LOG("Sensor health: %d -> %d", reportedSensorHealth, health);
+  reportedSensorHealth = health;
 
-  if (success || !appContext.sensorInitialized) {
-    // Convert to ZCL format (temperature: 0.01°C, humidity: 0.01%)
-    temperature_raw = (int16_t)(temperature_celsius * 100);
-    humidity_raw = (uint16_t)(humidity_percent * 100);
+  emberAfWriteManufacturerSpecificServerAttribute(APP_ENDPOINT,
+                                                  ZCL_TEMP_MEASUREMENT_CLUSTER_ID,
+                                                  APP_ATTR_SENSOR_HEALTH_ID,
+                                                  APP_MANUFACTURER_CODE,
+                                                  &health,
+                                                  ZCL_ENUM8_ATTRIBUTE_TYPE);
 
-    APP_LOG("Sensor: temp=%.2f°C, humidity=%.2f%%",
-            temperature_celsius, humidity_percent);
+  if (health == SHT31_HEALTH_NOT_RESPONDING) {
+    // ZCL "invalid measurement", reported once instead of stale or fake data
+    int16_t temperature_centi = SHT31_INVALID_TEMPERATURE;
+    uint16_t humidity_centi = SHT31_INVALID_HUMIDITY;
 
-    // Update ZCL attributes
     emberAfWriteServerAttribute(APP_ENDPOINT,
                                  ZCL_TEMP_MEASUREMENT_CLUSTER_ID,
                                  ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID,
-                                 (uint8_t*)&temperature_raw,
+                                 (uint8_t*)&temperature_centi,
                                  ZCL_INT16S_ATTRIBUTE_TYPE);
 
     emberAfWriteServerAttribute(APP_ENDPOINT,
                                  ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID,
                                  ZCL_RELATIVE_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID,
-                                 (uint8_t*)&humidity_raw,
+                                 (uint8_t*)&humidity_centi,
                                  ZCL_INT16U_ATTRIBUTE_TYPE);
 
-  } else {
-    APP_ERROR("Failed to read sensor");
+    // First good sample after recovery is written whatever its value
+    report_filter_invalidate(&temperatureFilter);
+    report_filter_invalidate(&humidityFilter);
   }
 }
 
-void app_update_battery_data(void)
+void app_set_sensor_alert_mode(bool enable)
 {
-  uint16_t voltage_mv = battery_read_voltage();
-  uint8_t percentage = battery_voltage_to_percentage(voltage_mv);
-
-  // ZCL format: voltage in 100mV units, percentage in 0.5% units (0-200)
-  uint8_t battery_voltage = voltage_mv / 100;
-  uint8_t battery_percentage = percentage * 2;  // Convert to 0-200 range
+  sensorAlertWanted = enable;
 
-  APP_LOG("Battery: %d mV (%d%%)", voltage_mv, percentage);
-
-  // Update ZCL attributes
-  emberAfWriteServerAttribute(APP_ENDPOINT,
-                               ZCL_POWER_CONFIG_CLUSTER_ID,
-                               ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID,
-                               &battery_voltage,
-                               ZCL_INT8U_ATTRIBUTE_TYPE);
+  // Unjoined: applied by enter_state() on the next join
+  if (state_is_joined(appContext.state)) {
+    start_sensor_schedule();
+  }
+}
 
-  emberAfWriteServerAttribute(APP_ENDPOINT,
-                               ZCL_POWER_CONFIG_CLUSTER_ID,
-                               ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
-                               &battery_percentage,
-                               ZCL_INT8U_ATTRIBUTE_TYPE);
+void app_update_battery_data(void)
+{
+  // Result arrives in battery_data_work() once the ADC interrupt posts it
+  if (!battery_start_measurement(battery_measurement_done)) {
+    APP_DEBUG("Battery measurement already in progress");
+  }
 }
 
 void app_stack_status_callback(EmberStatus status)
@@ -357,24 +496,20 @@ void app_stack_status_callback(EmberStatus status)
   switch (status) {
     case EMBER_NETWORK_UP:
       APP_LOG("Network UP");
-      if (appContext.state != APP_STATE_JOINED_FAST_POLL &&
-          appContext.state != APP_STATE_JOINED_NORMAL) {
-        appContext.state = APP_STATE_JOINED_NORMAL;
+      if (!state_is_joined(appContext.state)) {
+        enter_state(APP_STATE_JOINED_NORMAL);
         print_network_info();
       }
       break;
 
     case EMBER_NETWORK_DOWN:
       APP_LOG("Network DOWN");
-      appContext.state = APP_STATE_NOT_JOINED;
-      if (appContext.fastPollActive) {
-        app_set_fast_poll(false);
-      }
+      enter_state(APP_STATE_NOT_JOINED);
       break;
 
     case EMBER_JOIN_FAILED:
       APP_LOG("Join FAILED");
-      appContext.state = APP_STATE_NOT_JOINED;
+      enter_state(APP_STATE_NOT_JOINED);
       break;
 
     default:
@@ -382,26 +517,349 @@ void app_stack_status_callback(EmberStatus status)
   }
 }
 
+
+//==============================================================================
+// Private Functions - State Machine
+//==============================================================================
+
+/**
+ * @brief Change state and arm or disarm the timers that belong to it
+ * Sensor and battery schedules run only while joined; the fast-poll timeout
+ * only in APP_STATE_JOINED_FAST_POLL. An unjoined device takes no
+ * application wakes at all.
+ */
+static void enter_state(AppState_t state)
+{
+  AppState_t previous = appContext.state;
+  bool joined = state_is_joined(state);
+  bool wasJoined = state_is_joined(previous);
+
+  appContext.state = state;
+  APP_DEBUG("State %d -> %d", previous, state);
+
+  if (joined && !wasJoined) {
+    start_sensor_schedule();
+    wake_sched_start_periodic(&batteryTask,
+                              APP_BATTERY_SAMPLE_PERIOD_MS,
+                              APP_BATTERY_TOLERANCE_MS,
+                              battery_timer_callback,
+                              NULL);
+
+  } else if (!joined && wasJoined) {
+    stop_sensor_schedule();
+    wake_sched_stop(&batteryTask);
+    wake_sched_stop(&batteryWaitTask);
+    batterySampleDue = false;
+  }
+
+  if (state == APP_STATE_JOINED_FAST_POLL && previous != APP_STATE_JOINED_FAST_POLL) {
+    app_set_fast_poll(true);
+    wake_sched_start(&fastPollTask,
+                     APP_FAST_POLL_TIMEOUT_MS,
+                     APP_FAST_POLL_TOLERANCE_MS,
+                     fast_poll_timer_callback,
+                     NULL);
+    APP_LOG("Fast poll enabled for %d seconds", APP_FAST_POLL_TIMEOUT_MS / 1000);
+
+  } else if (state != APP_STATE_JOINED_FAST_POLL) {
+    wake_sched_stop(&fastPollTask);
+    if (appContext.fastPollActive) {
+      app_set_fast_poll(false);
+    }
+  }
+}
+
+static bool state_is_joined(AppState_t state)
+{
+  return state == APP_STATE_JOINED_FAST_POLL || state == APP_STATE_JOINED_NORMAL;
+}
+
+/**
+ * @brief Arm ALERT wakeups or periodic reads, whichever is wanted
+ */
+static void start_sensor_schedule(void)
+{
+  if (sensorAlertWanted) {
+    wake_sched_stop(&alertStopTask);
+    if (!sht31_alert_is_enabled()) {
+      if (sht31_alert_enable(APP_SENSOR_ALERT_RATE, sensor_alert_callback)) {
+        arm_sensor_alert_window();
+      } else {
+        APP_ERROR("Failed to enable sensor alert mode");
+      }
+    }
+  } else {
+    stop_sensor_alert();
+  }
+
+  // Period depends on the mode: polling interval or alert backstop
+  start_sensor_timer();
+}
+
+static void stop_sensor_schedule(void)
+{
+  // ALERT mode keeps the sensor converting; stop it along with the timer
+  stop_sensor_alert();
+
+  wake_sched_stop(&sensorTask);
+  APP_LOG("Sensor timer stopped");
+}
+
+/**
+ * @brief Return the sensor to single-shot mode if ALERT is on
+ * The sensor refuses while a measurement or a window update is in flight;
+ * try again shortly rather than leave it converting unattended.
+ */
+static void stop_sensor_alert(void)
+{
+  if (!sht31_alert_is_enabled() || sht31_alert_disable()) {
+    wake_sched_stop(&alertStopTask);
+    return;
+  }
+
+  APP_DEBUG("Sensor busy - alert disable retried in %d ms", APP_SENSOR_ALERT_RETRY_MS);
+  wake_sched_start(&alertStopTask,
+                   APP_SENSOR_ALERT_RETRY_MS,
+                   0,
+                   alert_stop_retry_callback,
+                   NULL);
+}
+
+/**
+ * @brief Centre the ALERT window on the last written values
+ * Next ALERT only once the value moves away from what was written. Without
+ * a written value yet the first sample arms it.
+ */
+static void arm_sensor_alert_window(void)
+{
+  if (!sht31_alert_is_enabled() || !temperatureFilter.valid || !humidityFilter.valid) {
+    return;
+  }
+
+  if (!sht31_set_alert_window((int16_t)temperatureFilter.written,
+                              (uint16_t)humidityFilter.written)) {
+    APP_DEBUG("Sensor busy - alert window kept until the next sample");
+  }
+}
+
 //==============================================================================
 // Private Functions
 //==============================================================================
 
-static void sensor_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+static void sensor_timer_callback(WakeSchedTask_t *task, void *data)
+{
+  (void)task;
+  (void)data;
+
+  em_stats_note_wake(EM_STATS_REASON_SENSOR);
+  WAKE_TRACE_BEGIN(WAKE_PHASE_TIMER_CALLBACK);
+
+  // Armed only while joined (enter_state())
+  app_start_sensor_measurement();
+
+  WAKE_TRACE_END(WAKE_PHASE_TIMER_CALLBACK);
+}
+
+static void alert_stop_retry_callback(WakeSchedTask_t *task, void *data)
 {
-  (void)handle;
+  (void)task;
   (void)data;
 
-  // Only update if joined to network
+  // Re-enabled by the CLI or a rejoin meanwhile
+  if (sensorAlertWanted && state_is_joined(appContext.state)) {
+    return;
+  }
+
+  stop_sensor_alert();
+
+  // The timer was armed with the backstop period while ALERT was still on
+  if (!sht31_alert_is_enabled() && state_is_joined(appContext.state)) {
+    start_sensor_timer();
+  }
+}
+
+/**
+ * @brief SHT31 ALERT edge, from the GPIO interrupt; the read starts from
+ * stack context
+ */
+static void sensor_alert_callback(void)
+{
+  em_stats_note_wake(EM_STATS_REASON_SENSOR);
+
+  // Dropped on a full ring: the backstop timer reads it later
+  deferred_work_post(sensor_alert_work, 0, 0);
+}
+
+static void sensor_alert_work(uint32_t arg0, uint32_t arg1)
+{
+  (void)arg0;
+  (void)arg1;
+
+  // Value left the alert window - report it if we are on a network
   if (appContext.state == APP_STATE_JOINED_FAST_POLL ||
       appContext.state == APP_STATE_JOINED_NORMAL) {
-    app_update_sensor_data();
-    app_update_battery_data();
+    app_start_sensor_measurement();
+  }
+}
+
+/**
+ * @brief SHT31 result, from the I2C interrupt; attribute writes wait for
+ * stack context
+ */
+static void sensor_measurement_done(bool success,
+                                    int16_t temperature_centi,
+                                    uint16_t humidity_centi)
+{
+  uint32_t packed = ((uint32_t)(uint16_t)temperature_centi << 16) | humidity_centi;
+
+  deferred_work_post(sensor_data_work, success, packed);
+}
+
+static void sensor_data_work(uint32_t success, uint32_t packed)
+{
+  app_update_sensor_data(success != 0,
+                         (int16_t)(uint16_t)(packed >> 16),
+                         (uint16_t)packed);
+}
+
+static void start_sensor_timer(void)
+{
+  uint32_t period = sht31_alert_is_enabled() ? APP_SENSOR_BACKSTOP_PERIOD_MS
+                                             : APP_SENSOR_READ_PERIOD_MS;
+
+  wake_sched_start_periodic(&sensorTask,
+                            period,
+                            APP_SENSOR_READ_TOLERANCE_MS,
+                            sensor_timer_callback,
+                            NULL);
+  APP_LOG("Sensor timer started (period: %lu ms)", period);
+}
+
+static void battery_timer_callback(WakeSchedTask_t *task, void *data)
+{
+  (void)task;
+  (void)data;
+
+  em_stats_note_wake(EM_STATS_REASON_BATTERY);
+
+  // Armed only while joined (enter_state())
+  request_battery_sample();
+}
+
+static void request_battery_sample(void)
+{
+#if APP_BATTERY_LOADED_SAMPLE_ENABLED
+  // Wait for the next transmission; sample at rest if none comes
+  batterySampleDue = true;
+  wake_sched_start(&batteryWaitTask,
+                   APP_BATTERY_LOADED_WAIT_MS,
+                   APP_BATTERY_TOLERANCE_MS,
+                   battery_wait_timer_callback,
+                   NULL);
+#else
+  take_battery_sample(false);
+#endif
+}
+
+static void battery_wait_timer_callback(WakeSchedTask_t *task, void *data)
+{
+  (void)task;
+  (void)data;
+
+  em_stats_note_wake(EM_STATS_REASON_BATTERY);
+
+  if (batterySampleDue) {
+    take_battery_sample(false);
+  }
+}
+
+static void take_battery_sample(bool loaded)
+{
+  batterySampleDue = false;
+  wake_sched_stop(&batteryWaitTask);
+
+  APP_DEBUG("Battery sample (%s)", loaded ? "after TX" : "at rest");
+  app_update_battery_data();
+}
+
+/**
+ * @brief Battery result, from the ADC interrupt; attribute writes wait for
+ * stack context
+ */
+static void battery_measurement_done(uint16_t voltage_mv)
+{
+  deferred_work_post(battery_data_work, voltage_mv, 0);
+}
+
+static void battery_data_work(uint32_t voltage, uint32_t unused)
+{
+  (void)unused;
+
+  uint16_t voltage_mv = (uint16_t)voltage;
+  uint8_t percentage = battery_voltage_to_percentage(voltage_mv);
+
+  // ZCL format: voltage in 100mV units, percentage in 0.5% units (0-200)
+  uint8_t battery_voltage = voltage_mv / 100;
+  uint8_t battery_percentage = percentage * 2;  // Convert to 0-200 range
+
+  APP_LOG("Battery: %d mV (%d%%)", voltage_mv, percentage);
+
+  // Update ZCL attributes
+  emberAfWriteServerAttribute(APP_ENDPOINT,
+                               ZCL_POWER_CONFIG_CLUSTER_ID,
+                               ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID,
+                               &battery_voltage,
+                               ZCL_INT8U_ATTRIBUTE_TYPE);
+
+  emberAfWriteServerAttribute(APP_ENDPOINT,
+                               ZCL_POWER_CONFIG_CLUSTER_ID,
+                               ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
+                               &battery_percentage,
+                               ZCL_INT8U_ATTRIBUTE_TYPE);
+
+  update_energy_attributes(percentage);
+}
+
+static void update_energy_attributes(uint8_t percentage)
+{
+  EnergyReport_t report;
+  energy_get_report(&report);
+  uint16_t lifeDays = energy_project_life_days(battery_get_capacity_mah(), percentage);
+
+  emberAfWriteManufacturerSpecificServerAttribute(APP_ENDPOINT,
+                                                  ZCL_POWER_CONFIG_CLUSTER_ID,
+                                                  APP_ATTR_ENERGY_TOTAL_ID,
+                                                  APP_MANUFACTURER_CODE,
+                                                  (uint8_t*)&report.totalUah,
+                                                  ZCL_INT32U_ATTRIBUTE_TYPE);
+
+  emberAfWriteManufacturerSpecificServerAttribute(APP_ENDPOINT,
+                                                  ZCL_POWER_CONFIG_CLUSTER_ID,
+                                                  APP_ATTR_ENERGY_AVG_CURRENT_ID,
+                                                  APP_MANUFACTURER_CODE,
+                                                  (uint8_t*)&report.averageCentiUa,
+                                                  ZCL_INT32U_ATTRIBUTE_TYPE);
+
+  emberAfWriteManufacturerSpecificServerAttribute(APP_ENDPOINT,
+                                                  ZCL_POWER_CONFIG_CLUSTER_ID,
+                                                  APP_ATTR_ENERGY_LIFE_DAYS_ID,
+                                                  APP_MANUFACTURER_CODE,
+                                                  (uint8_t*)&lifeDays,
+                                                  ZCL_INT16U_ATTRIBUTE_TYPE);
+
+  for (uint8_t i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++) {
+    emberAfWriteManufacturerSpecificServerAttribute(APP_ENDPOINT,
+                                                    ZCL_POWER_CONFIG_CLUSTER_ID,
+                                                    APP_ATTR_ENERGY_SUBSYSTEM_ID + i,
+                                                    APP_MANUFACTURER_CODE,
+                                                    (uint8_t*)&report.chargeUah[i],
+                                                    ZCL_INT32U_ATTRIBUTE_TYPE);
   }
 }
 
-static void fast_poll_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+static void fast_poll_timer_callback(WakeSchedTask_t *task, void *data)
 {
-  (void)handle;
+  (void)task;
   (void)data;
 
   APP_LOG("Fast poll timeout - transitioning to normal poll");
@@ -411,22 +869,17 @@ static void fast_poll_timer_callback(sl_sleeptimer_timer_handle_t *handle, void
 static void transition_to_normal_poll(void)
 {
   if (appContext.state == APP_STATE_JOINED_FAST_POLL) {
-    appContext.state = APP_STATE_JOINED_NORMAL;
-    app_set_fast_poll(false);
+    enter_state(APP_STATE_JOINED_NORMAL);
     APP_LOG("Transitioned to normal operation mode");
   }
 }
 
 static void print_network_info(void)
 {
-  EmberNodeId nodeId = emberAfGetNodeId();
-  EmberPanId panId = emberAfGetPanId();
-  int8_t radioChannel = emberAfGetRadioChannel();
-
   APP_LOG("Network Info:");
-  APP_LOG("  Node ID: 0x%04X", nodeId);
-  APP_LOG("  PAN ID: 0x%04X", panId);
-  APP_LOG("  Channel: %d", radioChannel);
+  APP_LOG("  Node ID: 0x%04X", emberAfGetNodeId());
+  APP_LOG("  PAN ID: 0x%04X", emberAfGetPanId());
+  APP_LOG("  Channel: %d", emberAfGetRadioChannel());
 }
 
 static void print_reset_info(void)
@@ -509,18 +962,303 @@ void cli_battery_read(sl_cli_command_arg_t *arguments)
   app_update_battery_data();
 }
 
+void cli_energy(sl_cli_command_arg_t *arguments)
+{
+  static const char * const subsystemNames[ENERGY_SUBSYSTEM_COUNT] = {
+    "EM0", "EM1", "EM2", "Radio TX", "Radio RX", "I2C", "ADC"
+  };
+
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    energy_reset();
+    APP_PRINT("Energy counters reset");
+    return;
+  }
+
+  EnergyReport_t report;
+  energy_get_report(&report);
+
+  APP_PRINT("=== Energy (estimated, %lu s) ===", report.elapsedS);
+  for (uint8_t i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++) {
+    APP_PRINT("%-9s %10lu ms %8lu uAh", subsystemNames[i],
+            (uint32_t)(report.timeUs[i] / 1000u), report.chargeUah[i]);
+  }
+  APP_PRINT("Total: %lu uAh, average %lu.%02lu uA", report.totalUah,
+          report.averageCentiUa / 100, report.averageCentiUa % 100);
+
+  if (battery_get_last_voltage() == 0) {
+    APP_PRINT("Projected life: no battery sample yet");
+    return;
+  }
+
+  uint8_t percentage = battery_voltage_to_percentage(battery_get_last_voltage());
+  uint16_t lifeDays = energy_project_life_days(battery_get_capacity_mah(), percentage);
+  if (lifeDays == 0xFFFF) {
+    APP_PRINT("Projected life: need at least 1 h of data");
+  } else {
+    APP_PRINT("Projected life: %u days at %d%%", lifeDays, percentage);
+  }
+}
+
+void cli_em_stats(sl_cli_command_arg_t *arguments)
+{
+  static const char * const modeNames[EM_STATS_MODE_COUNT] = { "EM0", "EM1", "EM2" };
+
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    em_stats_reset();
+    APP_PRINT("EM residency counters reset");
+    return;
+  }
+
+  EmStats_t stats;
+  em_stats_get(&stats);
+
+  uint64_t totalUs = 0;
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    totalUs += stats.residencyUs[i];
+  }
+
+  APP_PRINT("=== EM residency (%lu s) ===", (uint32_t)(totalUs / 1000000u));
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    // Hundredths of a percent, so EM0 at a few ppm still shows up
+    uint32_t share = (totalUs > 0) ? (uint32_t)(stats.residencyUs[i] * 10000u / totalUs) : 0;
+    APP_PRINT("%s %3lu.%02lu%% %10lu ms %8lu entries", modeNames[i],
+            share / 100, share % 100,
+            (uint32_t)(stats.residencyUs[i] / 1000u), stats.entries[i]);
+  }
+
+  for (uint8_t mode = EM_STATS_EM0; mode <= EM_STATS_EM1; mode++) {
+    const uint64_t *reasonUs = (mode == EM_STATS_EM0) ? stats.em0ReasonUs : stats.em1ReasonUs;
+    const uint32_t *reasonCount = (mode == EM_STATS_EM0) ? stats.em0ReasonCount
+                                                        : stats.em1ReasonCount;
+    bool listed[EM_STATS_REASON_COUNT] = { false };
+
+    APP_PRINT("Top %s reasons:", modeNames[mode]);
+    for (uint8_t rank = 0; rank < EM_STATS_TOP_REASONS; rank++) {
+      int8_t best = -1;
+      for (uint8_t r = 0; r < EM_STATS_REASON_COUNT; r++) {
+        if (!listed[r] && reasonUs[r] > 0 && (best < 0 || reasonUs[r] > reasonUs[best])) {
+          best = (int8_t)r;
+        }
+      }
+      if (best < 0) {
+        break;
+      }
+      listed[best] = true;
+      APP_PRINT("  %-8s %10lu ms %8lu times", em_stats_reason_name((EmStatsReason_t)best),
+              (uint32_t)(reasonUs[best] / 1000u), reasonCount[best]);
+    }
+  }
+}
+
+void cli_wake_trace(sl_cli_command_arg_t *arguments)
+{
+#if WAKE_TRACE_ENABLED
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    wake_trace_reset();
+    APP_PRINT("Wake trace reset");
+    return;
+  }
+
+  APP_PRINT("=== Wake phases (us) ===");
+  APP_PRINT("%-13s %6s %8s %8s %8s %6s", "phase", "count", "min", "avg", "max", "stale");
+  for (uint8_t i = 0; i < WAKE_PHASE_COUNT; i++) {
+    WakeTraceStats_t stats;
+    wake_trace_get_stats((WakeTracePhase_t)i, &stats);
+    if (stats.count > 0 || stats.discarded > 0) {
+      APP_PRINT("%-13s %6lu %8lu %8lu %8lu %6lu", wake_trace_phase_name((WakeTracePhase_t)i),
+              stats.count, stats.minUs, stats.avgUs, stats.maxUs, stats.discarded);
+    }
+  }
+
+  // Ring dump, times relative to the oldest mark
+  WakeTraceEntry_t first;
+  WakeTraceEntry_t entry;
+  if (!wake_trace_get_entry(0, &first)) {
+    APP_PRINT("Trace ring empty");
+    return;
+  }
+
+  APP_PRINT("=== Trace ring ===");
+  for (uint16_t i = 0; wake_trace_get_entry(i, &entry); i++) {
+    APP_PRINT("%10lu %s %s", wake_trace_to_us(entry.timestamp - first.timestamp),
+            entry.begin ? ">" : "<", wake_trace_phase_name((WakeTracePhase_t)entry.phase));
+  }
+#else
+  (void)arguments;
+  APP_PRINT("Wake trace not compiled in (WAKE_TRACE_ENABLED in wake_trace.h)");
+#endif
+}
+
+void cli_wake_sched(sl_cli_command_arg_t *arguments)
+{
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    wake_sched_reset_stats();
+    APP_PRINT("Wake scheduler counters reset");
+    return;
+  }
+
+  WakeSchedStats_t stats;
+  wake_sched_get_stats(&stats);
+
+  APP_PRINT("=== Wake scheduler ===");
+  APP_PRINT("Deadlines run: %lu", stats.deadlines);
+  APP_PRINT("Timer wakes:   %lu", stats.timerWakes);
+  APP_PRINT("Merged:        %lu (shared a timer wake)", stats.merged);
+  APP_PRINT("Piggybacked:   %lu (ran on another wake)", stats.piggybacked);
+  APP_PRINT("Wakes saved:   %lu", stats.merged + stats.piggybacked);
+}
+
+void cli_deferred_work(sl_cli_command_arg_t *arguments)
+{
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    deferred_work_reset_stats();
+    APP_PRINT("Deferred work counters reset");
+    return;
+  }
+
+  DeferredWorkStats_t stats;
+  deferred_work_get_stats(&stats);
+
+  APP_PRINT("=== Deferred work ===");
+  APP_PRINT("Posted:     %lu (from interrupts)", stats.posted);
+  APP_PRINT("Direct:     %lu (already in stack context)", stats.direct);
+  APP_PRINT("Overflows:  %lu (ring full, dropped)", stats.overflows);
+  APP_PRINT("High water: %u of %u", stats.highWater, DEFERRED_WORK_RING_SIZE);
+}
+
+void cli_report_filter(sl_cli_command_arg_t *arguments)
+{
+  if (sl_cli_get_argument_count(arguments) >= 1
+      && sl_cli_get_argument_uint8(arguments, 0) != 0) {
+    report_filter_reset_stats(&temperatureFilter);
+    report_filter_reset_stats(&humidityFilter);
+    APP_PRINT("Report filter counters reset");
+    return;
+  }
+
+  APP_PRINT("=== Report filter ===");
+  APP_PRINT("Temperature: %lu written, %lu suppressed (quantum %d, hysteresis %d)",
+            temperatureFilter.committed, temperatureFilter.suppressed,
+            APP_TEMP_QUANTUM_CENTI, APP_TEMP_HYSTERESIS_CENTI);
+  APP_PRINT("Humidity:    %lu written, %lu suppressed (quantum %d, hysteresis %d)",
+            humidityFilter.committed, humidityFilter.suppressed,
+            APP_HUMIDITY_QUANTUM_CENTI, APP_HUMIDITY_HYSTERESIS_CENTI);
+}
+
+void cli_log_level(sl_cli_command_arg_t *arguments)
+{
+  static const char * const levelNames[] = { "none", "error", "info", "debug" };
+
+  if (sl_cli_get_argument_count(arguments) >= 1) {
+    app_log_set_level(sl_cli_get_argument_uint8(arguments, 0));
+  }
+
+  APP_PRINT("Log level: %s (compile-time limit per module in app_log.h)",
+            levelNames[app_log_get_level()]);
+}
+
 void cli_network_status(sl_cli_command_arg_t *arguments)
 {
   (void)arguments;
 
-  APP_LOG("=== Network Status ===");
-  APP_LOG("State: %d", appContext.state);
+  APP_PRINT("=== Network Status ===");
+  APP_PRINT("State: %d", appContext.state);
 
   if (emberAfNetworkState() == EMBER_JOINED_NETWORK) {
     print_network_info();
-    APP_LOG("Fast poll: %s", appContext.fastPollActive ? "enabled" : "disabled");
+    APP_PRINT("Fast poll: %s", appContext.fastPollActive ? "enabled" : "disabled");
   } else {
-    APP_LOG("Not joined to network");
-    APP_LOG("Join attempts: %d", appContext.joinAttempts);
+    APP_PRINT("Not joined to network");
+    APP_PRINT("Join attempts: %d", appContext.joinAttempts);
   }
 }
+
+void cli_sensor_mode(sl_cli_command_arg_t *arguments)
+{
+  static const char * const rateNames[SHT31_RATE_COUNT] = {
+    "0.5", "1", "2", "4", "10"
+  };
+
+  if (sl_cli_get_argument_count(arguments) >= 2) {
+    Sht31Mode_t mode = (Sht31Mode_t)sl_cli_get_argument_uint8(arguments, 0);
+    Sht31Rate_t rate = (Sht31Rate_t)sl_cli_get_argument_uint8(arguments, 1);
+
+    if (mode > SHT31_MODE_PERIODIC || rate >= SHT31_RATE_COUNT) {
+      APP_PRINT("Usage: sensor_mode <0=single-shot|1=periodic> <rate 0-4>");
+      return;
+    }
+
+    if (!sht31_set_mode(mode, rate)) {
+      APP_ERROR("Failed to change sensor mode");
+      return;
+    }
+  }
+
+  APP_PRINT("Sensor mode: %s, rate: %s mps",
+          sht31_get_mode() == SHT31_MODE_PERIODIC ? "periodic" : "single-shot",
+          rateNames[sht31_get_rate()]);
+}
+
+void cli_sensor_adaptive(sl_cli_command_arg_t *arguments)
+{
+  uint16_t tempMargin;
+  uint16_t humMargin;
+  Sht31Stats_t stats;
+
+  int argc = sl_cli_get_argument_count(arguments);
+  if (argc == 1 && sl_cli_get_argument_uint8(arguments, 0) == 0) {
+    sht31_set_adaptive(false, SHT31_ADAPTIVE_TEMP_MARGIN_CENTI,
+                       SHT31_ADAPTIVE_HUM_MARGIN_CENTI);
+  } else if (argc >= 2) {
+    // Margins in 0.01 °C / 0.01 %RH; changing them restarts the counters
+    sht31_set_adaptive(true,
+                       sl_cli_get_argument_uint16(arguments, 0),
+                       sl_cli_get_argument_uint16(arguments, 1));
+    sht31_reset_stats();
+  }
+
+  bool enabled = sht31_get_adaptive(&tempMargin, &humMargin);
+  sht31_get_stats(&stats);
+
+  APP_PRINT("=== Adaptive Repeatability ===");
+  APP_PRINT("Enabled: %s", enabled ? "yes" : "no");
+  APP_PRINT("Margins: temp=%u (0.01 C), humidity=%u (0.01 %%RH)", tempMargin, humMargin);
+  APP_PRINT("Low-repeatability samples: %lu", stats.lowSamples);
+  APP_PRINT("Escalated to high: %lu", stats.highSamples);
+  APP_PRINT("Total conversion wait: %lu ms", stats.conversionMs);
+}
+
+void cli_sensor_alert(sl_cli_command_arg_t *arguments)
+{
+  if (sl_cli_get_argument_count(arguments) >= 1) {
+    app_set_sensor_alert_mode(sl_cli_get_argument_uint8(arguments, 0) != 0);
+  }
+
+  APP_PRINT("Sensor alert mode: %s", sht31_alert_is_enabled() ? "enabled" : "disabled");
+}
+
+void cli_battery_chemistry(sl_cli_command_arg_t *arguments)
+{
+  static const char * const chemistryNames[BATTERY_CHEMISTRY_COUNT] = {
+    "alkaline", "lithium (Li-FeS2)", "NiMH"
+  };
+
+  if (sl_cli_get_argument_count(arguments) >= 1) {
+    BatteryChemistry_t chemistry = (BatteryChemistry_t)sl_cli_get_argument_uint8(arguments, 0);
+
+    if (!battery_set_chemistry(chemistry)) {
+      APP_PRINT("Usage: battery_chemistry <0=alkaline|1=lithium|2=NiMH>");
+      return;
+    }
+
+    // Re-publish the percentage on the new curve
+    app_update_battery_data();
+  }
+
+  APP_PRINT("Battery chemistry: %s", chemistryNames[battery_get_chemistry()]);
+}
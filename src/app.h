@@ -19,6 +19,9 @@
 #include "af-types.h"
 #include "app/framework/include/af.h"
 
+// APP_LOG and friends (text or tokenized backend)
+#include "app_log.h"
+
 //==============================================================================
 // Application Configuration
 //==============================================================================
@@ -35,12 +38,53 @@
 #define APP_HW_VERSION                  1
 #define APP_ZCL_VERSION                 3
 
+// Manufacturer-specific attributes (declare them in the ZAP configuration)
+#define APP_MANUFACTURER_CODE           0x1002  // Silicon Labs
+#define APP_ATTR_SENSOR_HEALTH_ID       0xF000  // Temp Measurement, enum8 Sht31Health_t
+#define APP_ATTR_ENERGY_TOTAL_ID        0xF000  // Power Config, int32u uAh since boot
+#define APP_ATTR_ENERGY_AVG_CURRENT_ID  0xF001  // Power Config, int32u 0.01 uA
+#define APP_ATTR_ENERGY_LIFE_DAYS_ID    0xF002  // Power Config, int16u days (0xFFFF unknown)
+#define APP_ATTR_ENERGY_SUBSYSTEM_ID    0xF010  // Power Config, int32u uAh, + EnergySubsystem_t
+
 // Timing Configuration
 #define APP_SENSOR_READ_PERIOD_MS       10000   // 10 seconds
 #define APP_FAST_POLL_TIMEOUT_MS        30000   // 30 seconds fast poll after join
 #define APP_FAST_POLL_INTERVAL_QS       2       // 200ms (in quarter seconds)
 #define APP_NORMAL_POLL_INTERVAL_QS     30      // 7.5 seconds (in quarter seconds)
 
+// How late each deadline may run (wake_sched.h). Deadlines whose windows
+// overlap share one wake, and a deadline whose window opens while the
+// device is awake anyway costs no wake at all. 0 = exactly on time.
+#define APP_SENSOR_READ_TOLERANCE_MS    2500    // A quarter of the read period
+#define APP_FAST_POLL_TOLERANCE_MS      2000
+#define APP_BATTERY_TOLERANCE_MS        60000   // Sample and loaded-sample wait
+#define APP_IDENTIFY_TOLERANCE_MS       100     // Blink cadence stays visibly even
+
+// Measured-value writes (report_filter.h): samples are rounded to the
+// quantum and written only when they move more than the hysteresis from
+// the last written value. Both in 0.01 units; quantum 1 and hysteresis 0 write
+// every changed sample.
+#define APP_TEMP_QUANTUM_CENTI          10      // 0.1 °C
+#define APP_TEMP_HYSTERESIS_CENTI       20      // Inside the ±0.3 °C tolerance attribute
+#define APP_HUMIDITY_QUANTUM_CENTI      10      // 0.1 %RH
+#define APP_HUMIDITY_HYSTERESIS_CENTI   50      // Inside the ±2 %RH tolerance attribute
+
+// Battery sampling runs on its own schedule; voltage barely moves in an hour.
+// When a sample is due it is taken right after the next radio transmission
+// (loaded voltage, where a weak cell shows its sag), or at rest if nothing
+// is sent within the wait window.
+#define APP_BATTERY_SAMPLE_PERIOD_MS    14400000 // 4 hours
+#define APP_BATTERY_LOADED_SAMPLE_ENABLED 1
+#define APP_BATTERY_LOADED_WAIT_MS      600000  // 10 minutes
+
+// SHT31 ALERT mode: sensor acquires periodically and raises ALERT only when
+// the value leaves a window around the last report. The sensor timer then
+// only runs as a backstop to guarantee a report every max interval.
+#define APP_SENSOR_ALERT_MODE_ENABLED   0       // Requires ALERT wired (sht31.h)
+#define APP_SENSOR_ALERT_RATE           SHT31_RATE_0_5_MPS
+#define APP_SENSOR_BACKSTOP_PERIOD_MS   300000  // 5 minutes (default max report interval)
+#define APP_SENSOR_ALERT_RETRY_MS       100     // Disable again once the sensor is idle
+
 // Battery voltage range (2xAA: 2.0V - 3.2V)
 #define BATTERY_VOLTAGE_MIN_MV          2000
 #define BATTERY_VOLTAGE_MAX_MV          3200
@@ -78,12 +122,6 @@ typedef struct {
  */
 void app_init(void);
 
-/**
- * @brief Application process loop
- * Called periodically by the framework
- */
-void app_process_action(void);
-
 /**
  * @brief Get current application state
  * @return Current AppState_t
@@ -124,12 +162,45 @@ void app_stack_status_callback(EmberStatus status);
 void app_set_fast_poll(bool enable);
 
 /**
- * @brief Update sensor measurements and attributes
+ * @brief Start a non-blocking sensor measurement
+ * The result is delivered to app_update_sensor_data() once the SHT31
+ * conversion completes; the device sleeps in EM2 in between.
+ */
+void app_start_sensor_measurement(void);
+
+/**
+ * @brief Update sensor attributes from a completed measurement
+ * Runs in stack context: the sht31_start_measurement() completion posts it
+ * from the I2C interrupt (deferred_work.h)
+ *
+ * @param success true if values come from the real sensor; failed samples
+ *        are not written (see app_update_sensor_health()), and good ones
+ *        only when they pass the report filter
+ * @param temperature_centi Temperature in 0.01 °C (ZCL MeasuredValue)
+ * @param humidity_centi Relative humidity in 0.01 % (ZCL MeasuredValue)
+ */
+void app_update_sensor_data(bool success,
+                            int16_t temperature_centi,
+                            uint16_t humidity_centi);
+
+/**
+ * @brief Publish the SHT31 health state if it changed
+ * Writes the manufacturer-specific health attribute and, when the sensor
+ * stops responding, the ZCL invalid value to both MeasuredValues once.
+ */
+void app_update_sensor_health(void);
+
+/**
+ * @brief Switch between periodic polling and SHT31 ALERT wakeups
+ * Takes effect while joined; unjoined, the choice is kept for the next join.
+ * @param enable true to wake on ALERT with a backstop timer, false to
+ *        poll every APP_SENSOR_READ_PERIOD_MS
  */
-void app_update_sensor_data(void);
+void app_set_sensor_alert_mode(bool enable);
 
 /**
  * @brief Update battery measurements and attributes
+ * Called on the battery schedule and for manual reads (button, CLI)
  */
 void app_update_battery_data(void);
 
@@ -139,15 +210,17 @@ void app_update_battery_data(void);
 
 void cli_sensor_read(sl_cli_command_arg_t *arguments);
 void cli_battery_read(sl_cli_command_arg_t *arguments);
+void cli_energy(sl_cli_command_arg_t *arguments);
+void cli_em_stats(sl_cli_command_arg_t *arguments);
+void cli_wake_trace(sl_cli_command_arg_t *arguments);
+void cli_wake_sched(sl_cli_command_arg_t *arguments);
+void cli_deferred_work(sl_cli_command_arg_t *arguments);
+void cli_report_filter(sl_cli_command_arg_t *arguments);
+void cli_log_level(sl_cli_command_arg_t *arguments);
 void cli_network_status(sl_cli_command_arg_t *arguments);
-
-//==============================================================================
-// Logging Macros
-//==============================================================================
-
-#define APP_LOG(...)    emberAfCorePrintln(__VA_ARGS__)
-#define APP_INFO(...)   emberAfCorePrintln(__VA_ARGS__)
-#define APP_ERROR(...)  emberAfCorePrintln("ERROR: " __VA_ARGS__)
-#define APP_DEBUG(...)  emberAfDebugPrintln(__VA_ARGS__)
+void cli_sensor_mode(sl_cli_command_arg_t *arguments);
+void cli_sensor_adaptive(sl_cli_command_arg_t *arguments);
+void cli_sensor_alert(sl_cli_command_arg_t *arguments);
+void cli_battery_chemistry(sl_cli_command_arg_t *arguments);
 
 #endif // APP_H
@@ -0,0 +1,189 @@
+/**
+ * @file app_log.c
+ * @brief Application logging backend implementation
+ *
+ * Runtime level, plus the tokenized ring when APP_LOG_TOKENIZED is set.
+ */
+
+#include "app_log.h"
+
+//==============================================================================
+// Public Variables
+//==============================================================================
+
+uint8_t appLogLevel = APP_LOG_RUNTIME_LEVEL_DEFAULT;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void app_log_set_level(uint8_t level)
+{
+  appLogLevel = (level > APP_LOG_LEVEL_DEBUG) ? APP_LOG_LEVEL_DEBUG : level;
+}
+
+uint8_t app_log_get_level(void)
+{
+  return appLogLevel;
+}
+
+#if APP_LOG_TOKENIZED
+
+#include "em_core.h"
+#include "sl_iostream.h"
+#include "af.h"
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+#define APP_LOG_RECORD_HEADER   7       // Sync + token + argc + string mask
+
+static uint8_t ring[APP_LOG_RING_SIZE];
+static uint32_t ringHead = 0;           // Write position (free running)
+static uint32_t ringTail = 0;           // Read position (free running)
+
+static uint32_t droppedPending = 0;     // Not yet reported on the wire
+static uint32_t droppedTotal = 0;
+
+static sl_zigbee_event_t drainEvent;    // ISR event: records come from interrupts too
+static bool drainEventReady = false;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static bool put_record(uint32_t token, const uintptr_t *args, uint8_t argc, uint8_t strings);
+static uint8_t string_length(const char *text);
+static void put_u32(uint32_t value);
+static void drain_event_handler(sl_zigbee_event_t *event);
+
+//==============================================================================
+// Public Functions - Tokenized Ring
+//==============================================================================
+
+void app_log_write(uint32_t token, const uintptr_t *args, uint8_t argc, uint8_t strings)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  uintptr_t dropped = droppedPending;
+  if (droppedPending > 0 && put_record(0, &dropped, 1, 0)) {
+    droppedPending = 0;
+  }
+
+  if (droppedPending > 0 || !put_record(token, args, argc, strings)) {
+    // Keep order: nothing new goes in before the drop notice
+    droppedPending++;
+    droppedTotal++;
+  }
+
+  if (drainEventReady) {
+    sl_zigbee_event_set_active(&drainEvent);
+  }
+
+  CORE_EXIT_ATOMIC();
+}
+
+void app_log_init(void)
+{
+  sl_zigbee_af_isr_event_init(&drainEvent, drain_event_handler);
+  drainEventReady = true;
+  sl_zigbee_event_set_active(&drainEvent);
+}
+
+uint32_t app_log_get_dropped(void)
+{
+  return droppedTotal;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Send up to APP_LOG_DRAIN_CHUNK_BYTES queued bytes to the UART
+ * Runs again on the next pass while bytes remain.
+ */
+static void drain_event_handler(sl_zigbee_event_t *event)
+{
+  uint8_t chunk[APP_LOG_DRAIN_CHUNK_BYTES];
+  uint16_t len = 0;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  while (ringTail != ringHead && len < sizeof(chunk)) {
+    chunk[len++] = ring[ringTail++ & (APP_LOG_RING_SIZE - 1)];
+  }
+  bool more = (ringTail != ringHead);
+  CORE_EXIT_ATOMIC();
+
+  if (len > 0) {
+    sl_iostream_write(SL_IOSTREAM_STDOUT, chunk, len);
+  }
+
+  if (more) {
+    sl_zigbee_event_set_active(event);
+  }
+}
+
+/**
+ * @brief Append a whole record, or nothing if it does not fit
+ * Called with interrupts masked. String arguments are copied now: the
+ * caller's buffer may be gone by the time the ring drains.
+ */
+static bool put_record(uint32_t token, const uintptr_t *args, uint8_t argc, uint8_t strings)
+{
+  uint32_t size = APP_LOG_RECORD_HEADER;
+
+  for (uint8_t i = 0; i < argc; i++) {
+    size += (strings & (1u << i)) ? 1u + string_length((const char *)args[i]) : 4u;
+  }
+
+  if (APP_LOG_RING_SIZE - (ringHead - ringTail) < size) {
+    return false;
+  }
+
+  ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = APP_LOG_SYNC;
+  put_u32(token);
+  ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = argc;
+  ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = strings;
+  for (uint8_t i = 0; i < argc; i++) {
+    if (strings & (1u << i)) {
+      const char *text = (const char *)args[i];
+      uint8_t length = string_length(text);
+
+      ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = length;
+      for (uint8_t j = 0; j < length; j++) {
+        ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = (uint8_t)text[j];
+      }
+    } else {
+      put_u32((uint32_t)args[i]);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Bytes of @p text a record carries (NULL is empty)
+ */
+static uint8_t string_length(const char *text)
+{
+  uint8_t length = 0;
+
+  while (text != NULL && length < APP_LOG_MAX_STRING && text[length] != '\0') {
+    length++;
+  }
+
+  return length;
+}
+
+static void put_u32(uint32_t value)
+{
+  for (uint8_t i = 0; i < 4; i++) {
+    ring[ringHead++ & (APP_LOG_RING_SIZE - 1)] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+#endif // APP_LOG_TOKENIZED
@@ -0,0 +1,319 @@
+/**
+ * @file app_log.h
+ * @brief Application logging backend
+ *
+ * APP_LOG/APP_INFO/APP_ERROR/APP_DEBUG either print formatted text through
+ * the AF debug print (default) or, with APP_LOG_TOKENIZED, store a compact
+ * binary record in a RAM ring: a token naming the format string plus the
+ * call's arguments. Nothing is formatted on the device and the format
+ * strings are left out of the image. The ring is drained by a stack event
+ * that each write activates, i.e. only while the MCU (and the VCOM UART) is
+ * awake anyway.
+ *
+ * Record on the wire (little endian):
+ *   0xA5 | token (4) | argc (1) | string mask (1) | arguments
+ * An argument is a uint32_t, or, where bit n of the mask is set, a string:
+ * length (1) and up to APP_LOG_MAX_STRING bytes, copied when the call is
+ * made. The token is a hash of the module and the format string, computed
+ * by the compiler, so it does not move when unrelated code does.
+ *
+ * Every call also leaves a token table entry - token, module, level and the
+ * format string - in the .app_log_tokens section of the ELF. The section is
+ * not allocated, so it costs no flash and is not in the flashed image.
+ * tools/log_decode.py reads the table from the ELF the image was built
+ * with and turns the stream back into text; bytes outside records (CLI
+ * echo, prompts) pass through unchanged.
+ *
+ * Each call has a level (APP_ERROR: error, APP_LOG/APP_INFO: info,
+ * APP_DEBUG: debug). Calls above their module's compile-time level are
+ * removed by the preprocessor, string literals included. The calls that
+ * remain are filtered at runtime by app_log_set_level(). APP_PRINT is for
+ * output the user asked for (CLI) and is never filtered.
+ *
+ * Every source file that logs names its module before its first include,
+ * so the module's level is known when this header is processed:
+ *   #define APP_LOG_MODULE  APP_LOG_MODULE_SHT31
+ */
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define APP_LOG_TOKENIZED               0
+
+// Ring size in bytes (power of two); a record is 7 bytes, plus 4 per
+// number and 1 + length per string argument
+#define APP_LOG_RING_SIZE               512
+
+// Bytes handed to the UART per drain event run, so a backlog is spread
+// over main-loop passes instead of holding one
+#define APP_LOG_DRAIN_CHUNK_BYTES       64
+
+// Most arguments a tokenized call may pass
+#define APP_LOG_MAX_ARGS                8
+
+// Longest string argument copied into a record; longer ones are cut
+#define APP_LOG_MAX_STRING              32
+
+// Record sync byte (never part of ASCII console text)
+#define APP_LOG_SYNC                    0xA5
+
+// Levels
+#define APP_LOG_LEVEL_NONE              0
+#define APP_LOG_LEVEL_ERROR             1
+#define APP_LOG_LEVEL_INFO              2
+#define APP_LOG_LEVEL_DEBUG             3
+
+// Compile-time level per module; calls above it are not built in.
+// tools/log_size_report.sh builds each level and reports the flash saved.
+#define APP_LOG_LEVEL_DEFAULT           APP_LOG_LEVEL_DEBUG
+#define APP_LOG_LEVEL_APP               APP_LOG_LEVEL_DEFAULT
+#define APP_LOG_LEVEL_BUTTON            APP_LOG_LEVEL_DEFAULT
+#define APP_LOG_LEVEL_SHT31             APP_LOG_LEVEL_DEFAULT
+#define APP_LOG_LEVEL_BATTERY           APP_LOG_LEVEL_DEFAULT
+#define APP_LOG_LEVEL_I2C_BUS           APP_LOG_LEVEL_DEFAULT
+#define APP_LOG_LEVEL_ZCL               APP_LOG_LEVEL_DEFAULT
+
+// Runtime level at boot
+#define APP_LOG_RUNTIME_LEVEL_DEFAULT   APP_LOG_LEVEL_DEBUG
+
+// Module IDs, hashed into each token and kept in the token table. Token 0
+// is reserved for the dropped-records notice.
+#define APP_LOG_MODULE_APP              1
+#define APP_LOG_MODULE_BUTTON           2
+#define APP_LOG_MODULE_SHT31            3
+#define APP_LOG_MODULE_BATTERY          4
+#define APP_LOG_MODULE_I2C_BUS          5
+#define APP_LOG_MODULE_ZCL              6
+
+//==============================================================================
+// Module Level
+//==============================================================================
+
+#if !defined(APP_LOG_MODULE)
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_DEFAULT
+#elif APP_LOG_MODULE == APP_LOG_MODULE_APP
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_APP
+#elif APP_LOG_MODULE == APP_LOG_MODULE_BUTTON
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_BUTTON
+#elif APP_LOG_MODULE == APP_LOG_MODULE_SHT31
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_SHT31
+#elif APP_LOG_MODULE == APP_LOG_MODULE_BATTERY
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_BATTERY
+#elif APP_LOG_MODULE == APP_LOG_MODULE_I2C_BUS
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_I2C_BUS
+#elif APP_LOG_MODULE == APP_LOG_MODULE_ZCL
+#define APP_LOG_COMPILED_LEVEL  APP_LOG_LEVEL_ZCL
+#else
+#error "Unknown APP_LOG_MODULE"
+#endif
+
+//==============================================================================
+// Logging Macros
+//==============================================================================
+
+// Runtime level, see app_log_set_level()
+extern uint8_t appLogLevel;
+
+#define APP_LOG_IF(level, call)                                               \
+  do {                                                                        \
+    if (appLogLevel >= (level)) {                                             \
+      call;                                                                   \
+    }                                                                         \
+  } while (0)
+
+#if APP_LOG_COMPILED_LEVEL >= APP_LOG_LEVEL_ERROR
+#define APP_ERROR(...)  APP_LOG_IF(APP_LOG_LEVEL_ERROR, APP_LOG_OUT_ERROR(__VA_ARGS__))
+#else
+#define APP_ERROR(...)  ((void)0)
+#endif
+
+#if APP_LOG_COMPILED_LEVEL >= APP_LOG_LEVEL_INFO
+#define APP_LOG(...)    APP_LOG_IF(APP_LOG_LEVEL_INFO, APP_LOG_OUT_INFO(__VA_ARGS__))
+#define APP_INFO(...)   APP_LOG_IF(APP_LOG_LEVEL_INFO, APP_LOG_OUT_INFO(__VA_ARGS__))
+#else
+#define APP_LOG(...)    ((void)0)
+#define APP_INFO(...)   ((void)0)
+#endif
+
+#if APP_LOG_COMPILED_LEVEL >= APP_LOG_LEVEL_DEBUG
+#define APP_DEBUG(...)  APP_LOG_IF(APP_LOG_LEVEL_DEBUG, APP_LOG_OUT_DEBUG(__VA_ARGS__))
+#else
+#define APP_DEBUG(...)  ((void)0)
+#endif
+
+#if APP_LOG_TOKENIZED
+
+#define APP_PRINT(...)          APP_LOG_RECORD(APP_LOG_LEVEL_NONE, __VA_ARGS__)
+#define APP_LOG_OUT_ERROR(...)  APP_LOG_RECORD(APP_LOG_LEVEL_ERROR, "ERROR: " __VA_ARGS__)
+#define APP_LOG_OUT_INFO(...)   APP_LOG_RECORD(APP_LOG_LEVEL_INFO, __VA_ARGS__)
+#define APP_LOG_OUT_DEBUG(...)  APP_LOG_RECORD(APP_LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+#if defined(APP_LOG_MODULE)
+#define APP_LOG_MODULE_ID       APP_LOG_MODULE
+#else
+#define APP_LOG_MODULE_ID       0
+#endif
+
+// Token table entry, recognised in the section by its magic ("ALTK")
+#define APP_LOG_ENTRY_MAGIC     0x4B544C41u
+
+// The format string must be a literal (or a macro for one). Numbers go out
+// as uint32_t; char pointers are copied as strings. The token is a static
+// initializer so it is folded at -O0 too, not hashed at run time.
+#define APP_LOG_RECORD(level, ...)                                            \
+  do {                                                                        \
+    APP_LOG_ENTRY(level, APP_LOG_FIRST(__VA_ARGS__, _));                      \
+    static const uint32_t appLogToken_ =                                      \
+      APP_LOG_TOKEN(APP_LOG_FIRST(__VA_ARGS__, _));                           \
+    const uintptr_t appLogArgs_[] = { 0 APP_LOG_CAST(__VA_ARGS__) };          \
+    app_log_write(appLogToken_, &appLogArgs_[1], APP_LOG_ARGC(__VA_ARGS__),   \
+                  APP_LOG_STRINGS(__VA_ARGS__));                              \
+  } while (0)
+
+// Table entry in a section without the alloc flag: the assembler comment
+// character cuts off the flags the compiler appends after the name
+#if defined(__arm__)
+#define APP_LOG_SECTION         ".app_log_tokens,\"\",%progbits @"
+#else
+#define APP_LOG_SECTION         ".app_log_tokens,\"\",%progbits #"
+#endif
+
+#define APP_LOG_ENTRY(entryLevel, entryFormat)                                \
+  static const struct {                                                       \
+    uint32_t magic;                                                           \
+    uint32_t token;                                                           \
+    uint8_t module;                                                           \
+    uint8_t level;                                                            \
+    uint16_t length;                                                          \
+    char format[sizeof(entryFormat)];                                         \
+  } appLogEntry_ __attribute__((section(APP_LOG_SECTION), used, aligned(4))) = { \
+    APP_LOG_ENTRY_MAGIC, APP_LOG_TOKEN(entryFormat), APP_LOG_MODULE_ID,       \
+    (entryLevel), sizeof(entryFormat), entryFormat                            \
+  }
+
+// 65599 hash over the first 128 characters of the format, then its length
+// and the module; folded to a constant by the compiler. tools/log_decode.py
+// repeats it to check the table.
+#define APP_LOG_TOKEN(format)                                                 \
+  ((uint32_t)APP_LOG_MODULE_ID                                                \
+   + 65599u * ((uint32_t)(sizeof(format) - 1)                                 \
+               + 65599u * APP_LOG_HASH_64(format, 0, APP_LOG_HASH_64(format, 64, 0u))))
+
+#define APP_LOG_HASH_CHAR(s, i)                                               \
+  ((i) < sizeof(s) - 1 ? (uint32_t)(uint8_t)(s)[(i) < sizeof(s) ? (i) : 0] : 0u)
+#define APP_LOG_HASH_1(s, i, rest)  (APP_LOG_HASH_CHAR(s, i) + 65599u * (rest))
+#define APP_LOG_HASH_4(s, i, rest)                                            \
+  APP_LOG_HASH_1(s, i, APP_LOG_HASH_1(s, (i) + 1,                             \
+    APP_LOG_HASH_1(s, (i) + 2, APP_LOG_HASH_1(s, (i) + 3, rest))))
+#define APP_LOG_HASH_16(s, i, rest)                                           \
+  APP_LOG_HASH_4(s, i, APP_LOG_HASH_4(s, (i) + 4,                             \
+    APP_LOG_HASH_4(s, (i) + 8, APP_LOG_HASH_4(s, (i) + 12, rest))))
+#define APP_LOG_HASH_64(s, i, rest)                                           \
+  APP_LOG_HASH_16(s, i, APP_LOG_HASH_16(s, (i) + 16,                          \
+    APP_LOG_HASH_16(s, (i) + 32, APP_LOG_HASH_16(s, (i) + 48, rest))))
+
+#define APP_LOG_FIRST(f, ...)   f
+
+// Number of arguments after the format string (0..APP_LOG_MAX_ARGS)
+#define APP_LOG_ARGC(...)   APP_LOG_ARGC_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0, _)
+#define APP_LOG_ARGC_(f, a1, a2, a3, a4, a5, a6, a7, a8, n, ...)  n
+
+#define APP_LOG_CAT(a, b)   APP_LOG_CAT_(a, b)
+#define APP_LOG_CAT_(a, b)  a##b
+
+#define APP_LOG_CAST(...)   APP_LOG_CAT(APP_LOG_CAST_, APP_LOG_ARGC(__VA_ARGS__))(__VA_ARGS__)
+
+#define APP_LOG_ARG(x)      , (uintptr_t)(x)
+#define APP_LOG_CAST_0(f)
+#define APP_LOG_CAST_1(f, a)                      APP_LOG_ARG(a)
+#define APP_LOG_CAST_2(f, a, b)                   APP_LOG_ARG(a) APP_LOG_ARG(b)
+#define APP_LOG_CAST_3(f, a, b, c)                APP_LOG_CAST_2(f, a, b) APP_LOG_ARG(c)
+#define APP_LOG_CAST_4(f, a, b, c, d)             APP_LOG_CAST_3(f, a, b, c) APP_LOG_ARG(d)
+#define APP_LOG_CAST_5(f, a, b, c, d, e)          APP_LOG_CAST_4(f, a, b, c, d) APP_LOG_ARG(e)
+#define APP_LOG_CAST_6(f, a, b, c, d, e, g)       APP_LOG_CAST_5(f, a, b, c, d, e) APP_LOG_ARG(g)
+#define APP_LOG_CAST_7(f, a, b, c, d, e, g, h)    APP_LOG_CAST_6(f, a, b, c, d, e, g) APP_LOG_ARG(h)
+#define APP_LOG_CAST_8(f, a, b, c, d, e, g, h, i) APP_LOG_CAST_7(f, a, b, c, d, e, g, h) APP_LOG_ARG(i)
+
+// String mask: bit n set when argument n is a char pointer (or array)
+#define APP_LOG_STRINGS(...)                                                  \
+  ((uint8_t)(0u APP_LOG_CAT(APP_LOG_STRINGS_, APP_LOG_ARGC(__VA_ARGS__))(__VA_ARGS__)))
+
+#define APP_LOG_STR(x, n)   | (_Generic((x) + 0, char *: 1u, const char *: 1u, default: 0u) << (n))
+#define APP_LOG_STRINGS_0(f)
+#define APP_LOG_STRINGS_1(f, a)                   APP_LOG_STR(a, 0)
+#define APP_LOG_STRINGS_2(f, a, b)                APP_LOG_STRINGS_1(f, a) APP_LOG_STR(b, 1)
+#define APP_LOG_STRINGS_3(f, a, b, c)             APP_LOG_STRINGS_2(f, a, b) APP_LOG_STR(c, 2)
+#define APP_LOG_STRINGS_4(f, a, b, c, d)          APP_LOG_STRINGS_3(f, a, b, c) APP_LOG_STR(d, 3)
+#define APP_LOG_STRINGS_5(f, a, b, c, d, e)       APP_LOG_STRINGS_4(f, a, b, c, d) APP_LOG_STR(e, 4)
+#define APP_LOG_STRINGS_6(f, a, b, c, d, e, g)    APP_LOG_STRINGS_5(f, a, b, c, d, e) APP_LOG_STR(g, 5)
+#define APP_LOG_STRINGS_7(f, a, b, c, d, e, g, h) \
+  APP_LOG_STRINGS_6(f, a, b, c, d, e, g) APP_LOG_STR(h, 6)
+#define APP_LOG_STRINGS_8(f, a, b, c, d, e, g, h, i) \
+  APP_LOG_STRINGS_7(f, a, b, c, d, e, g, h) APP_LOG_STR(i, 7)
+
+#else
+
+#define APP_PRINT(...)          emberAfCorePrintln(__VA_ARGS__)
+#define APP_LOG_OUT_ERROR(...)  emberAfCorePrintln("ERROR: " __VA_ARGS__)
+#define APP_LOG_OUT_INFO(...)   emberAfCorePrintln(__VA_ARGS__)
+#define APP_LOG_OUT_DEBUG(...)  emberAfDebugPrintln(__VA_ARGS__)
+
+#endif // APP_LOG_TOKENIZED
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Set the runtime level
+ * Only lowers output below each module's compile-time level, never above.
+ *
+ * @param level APP_LOG_LEVEL_NONE..APP_LOG_LEVEL_DEBUG
+ */
+void app_log_set_level(uint8_t level);
+
+/**
+ * @brief Get the runtime level
+ * @return APP_LOG_LEVEL_NONE..APP_LOG_LEVEL_DEBUG
+ */
+uint8_t app_log_get_level(void);
+
+#if APP_LOG_TOKENIZED
+
+/**
+ * @brief Queue one record (use the APP_* macros)
+ * Interrupt safe. A record that does not fit is dropped and counted; the
+ * count is sent as a token 0 record once space frees up.
+ *
+ * @param token Format token
+ * @param args Arguments; string arguments are char pointers
+ * @param argc Number of arguments
+ * @param strings Bit n set: argument n is a string, copied into the record
+ */
+void app_log_write(uint32_t token, const uintptr_t *args, uint8_t argc, uint8_t strings);
+
+/**
+ * @brief Set up the drain event (call after stack init)
+ * Records written earlier stay queued and go out once it runs.
+ */
+void app_log_init(void);
+
+/**
+ * @brief Get the number of records dropped on a full ring since boot
+ */
+uint32_t app_log_get_dropped(void);
+
+#else
+
+#define app_log_init()          ((void)0)
+
+#endif // APP_LOG_TOKENIZED
+
+#endif // APP_LOG_H
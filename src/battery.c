@@ -2,25 +2,103 @@
  * @file battery.c
  * @brief Battery voltage monitoring implementation
  *
- * Uses ADC to measure AVDD (battery voltage) and converts to percentage
+ * Uses ADC to measure AVDD (battery voltage) and converts to percentage.
+ * Conversions are oversampled in hardware and completed from ADC0_IRQHandler.
+ * Percentages come from per-chemistry discharge tables.
  */
 
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_BATTERY
+
 #include "battery.h"
 #include "app.h"
+#include "energy.h"
+#include "em_stats.h"
 #include "em_adc.h"
 #include "em_cmu.h"
 
+
 //==============================================================================
 // Private Variables
 //==============================================================================
 
-// ADC resolution (12-bit)
-#define ADC_RESOLUTION      4096
-
 // AVDD reference voltage (mV) - typically 3.3V for internal reference
 // We'll measure AVDD relative to internal 1.25V reference
 #define ADC_REF_VOLTAGE_MV  1250
 
+static battery_callback_t measureCallback = NULL;
+static volatile bool measureBusy = false;
+static uint16_t lastVoltageMv = 0;
+
+// Discharge curve point: 2-cell pack voltage and remaining capacity
+typedef struct {
+  uint16_t voltage_mv;
+  uint8_t percentage;
+} BatteryCurvePoint_t;
+
+typedef struct {
+  const BatteryCurvePoint_t *points;
+  uint8_t count;
+  uint32_t capacityMah;
+} BatteryCurve_t;
+
+// Low-drain (tens of uA average) discharge curves for two cells in series,
+// ascending voltage. Approximated from manufacturer discharge curves
+// (Energizer E91, L91, generic low-self-discharge NiMH).
+static const BatteryCurvePoint_t alkalineCurve[] = {
+  { 2000,   0 },
+  { 2100,   5 },
+  { 2260,  10 },
+  { 2360,  20 },
+  { 2440,  30 },
+  { 2520,  40 },
+  { 2580,  50 },
+  { 2660,  60 },
+  { 2740,  70 },
+  { 2840,  80 },
+  { 2960,  90 },
+  { 3100, 100 }
+};
+
+static const BatteryCurvePoint_t lithiumCurve[] = {
+  { 2000,   0 },
+  { 2400,   3 },
+  { 2600,   8 },
+  { 2760,  15 },
+  { 2840,  30 },
+  { 2900,  50 },
+  { 2940,  70 },
+  { 3000,  85 },
+  { 3100,  95 },
+  { 3400, 100 }
+};
+
+static const BatteryCurvePoint_t nimhCurve[] = {
+  { 2000,   0 },
+  { 2200,   5 },
+  { 2280,  10 },
+  { 2360,  20 },
+  { 2420,  35 },
+  { 2460,  50 },
+  { 2500,  70 },
+  { 2560,  85 },
+  { 2640,  95 },
+  { 2800, 100 }
+};
+
+#define CURVE(points, capacity) \
+  { points, (uint8_t)(sizeof(points) / sizeof(points[0])), capacity }
+
+static const BatteryCurve_t dischargeCurves[BATTERY_CHEMISTRY_COUNT] = {
+  CURVE(alkalineCurve, BATTERY_CAPACITY_ALKALINE_MAH),
+  CURVE(lithiumCurve, BATTERY_CAPACITY_LITHIUM_MAH),
+  CURVE(nimhCurve, BATTERY_CAPACITY_NIMH_MAH)
+};
+
+static BatteryChemistry_t chemistry = BATTERY_DEFAULT_CHEMISTRY;
+static battery_temp_compensation_t tempCompensation = NULL;
+static int16_t lastTemperature = 2500;              // 25 °C until told otherwise
+
 //==============================================================================
 // Public Functions
 //==============================================================================
@@ -32,8 +110,11 @@ void battery_init(void)
   // Enable ADC clock
   CMU_ClockEnable(cmuClock_ADC0, true);
 
-  // Initialize ADC for single conversion
+  // Initialize ADC for single conversion; references are powered only
+  // while converting (normal warm-up mode)
   ADC_Init_TypeDef adcInit = ADC_INIT_DEFAULT;
+  adcInit.ovsRateSel = BATTERY_ADC_OVERSAMPLING;
+  adcInit.warmUpMode = adcWarmupNormal;
   adcInit.timebase = ADC_TimebaseCalc(0);
   adcInit.prescale = ADC_PrescaleCalc(1000000, 0);  // 1 MHz ADC clock
   ADC_Init(ADC0, &adcInit);
@@ -42,51 +123,150 @@ void battery_init(void)
   ADC_InitSingle_TypeDef singleInit = ADC_INITSINGLE_DEFAULT;
   singleInit.input = adcSingleInputAVDD;         // Measure AVDD
   singleInit.reference = adcRef1V25;             // 1.25V internal reference
-  singleInit.resolution = adcRes12Bit;           // 12-bit resolution
-  singleInit.acqTime = adcAcqTime256;            // Longer acquisition for stability
+  singleInit.resolution = adcResOVS;             // Oversampled, 16-bit result
+  singleInit.acqTime = BATTERY_ADC_ACQ_TIME;
   ADC_InitSingle(ADC0, &singleInit);
 
+  ADC_IntClear(ADC0, ADC_IF_SINGLE);
+  ADC_IntEnable(ADC0, ADC_IEN_SINGLE);
+  NVIC_ClearPendingIRQ(ADC0_IRQn);
+  NVIC_EnableIRQ(ADC0_IRQn);
+
+  // Configuration is retained while the clock is gated
+  CMU_ClockEnable(cmuClock_ADC0, false);
+
   APP_LOG("Battery monitor initialized (ADC0, AVDD measurement)");
 }
 
-uint16_t battery_read_voltage(void)
+bool battery_start_measurement(battery_callback_t callback)
 {
-  // Start ADC conversion
-  ADC_Start(ADC0, adcStartSingle);
+  if (measureBusy) {
+    return false;
+  }
 
-  // Wait for conversion to complete
-  while (ADC0->STATUS & ADC_STATUS_SINGLEACT);
+  measureBusy = true;
+  measureCallback = callback;
 
-  // Read ADC result
-  uint32_t adcResult = ADC_DataSingleGet(ADC0);
+  // ADC0 runs from HFPERCLK here, which is off in EM2
+  em_stats_require_em1(EM_STATS_REASON_ADC);
 
-  // Calculate voltage in mV
-  // AVDD = (ADC_result * REF_voltage * scale) / ADC_max
-  // For AVDD input, scale factor is 3 (AVDD is divided by 3 internally)
-  uint32_t voltage_mv = (adcResult * ADC_REF_VOLTAGE_MV * 3) / ADC_RESOLUTION;
+  energy_begin(ENERGY_ADC);
+  CMU_ClockEnable(cmuClock_ADC0, true);
+  ADC_Start(ADC0, adcStartSingle);
 
-  APP_DEBUG("ADC: raw=%lu, voltage=%lu mV", adcResult, voltage_mv);
+  return true;
+}
 
-  return (uint16_t)voltage_mv;
+bool battery_is_busy(void)
+{
+  return measureBusy;
+}
+
+uint16_t battery_get_last_voltage(void)
+{
+  return lastVoltageMv;
 }
 
 uint8_t battery_voltage_to_percentage(uint16_t voltage_mv)
 {
-  // 2xAA battery range: 2.0V (empty) to 3.2V (full)
-  // Linear approximation (good enough for alkaline AA batteries)
+  const BatteryCurve_t *curve = &dischargeCurves[chemistry];
+
+  if (tempCompensation != NULL) {
+    voltage_mv = tempCompensation(chemistry, voltage_mv, lastTemperature);
+  }
+
+  if (voltage_mv <= curve->points[0].voltage_mv) {
+    return curve->points[0].percentage;
+  }
 
-  if (voltage_mv >= BATTERY_VOLTAGE_MAX_MV) {
-    return 100;
+  if (voltage_mv >= curve->points[curve->count - 1].voltage_mv) {
+    return curve->points[curve->count - 1].percentage;
   }
 
-  if (voltage_mv <= BATTERY_VOLTAGE_MIN_MV) {
-    return 0;
+  // Binary search for the segment with lo.voltage <= v < hi.voltage
+  uint8_t lo = 0;
+  uint8_t hi = curve->count - 1;
+  while (hi - lo > 1) {
+    uint8_t mid = (uint8_t)((lo + hi) / 2);
+    if (curve->points[mid].voltage_mv <= voltage_mv) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
   }
 
-  // Linear interpolation
-  uint32_t range = BATTERY_VOLTAGE_MAX_MV - BATTERY_VOLTAGE_MIN_MV;
-  uint32_t delta = voltage_mv - BATTERY_VOLTAGE_MIN_MV;
-  uint8_t percentage = (uint8_t)((delta * 100) / range);
+  // Linear interpolation within the segment
+  const BatteryCurvePoint_t *a = &curve->points[lo];
+  const BatteryCurvePoint_t *b = &curve->points[hi];
+  uint32_t span = b->voltage_mv - a->voltage_mv;
+  uint32_t delta = voltage_mv - a->voltage_mv;
+
+  return (uint8_t)(a->percentage
+                   + (delta * (uint32_t)(b->percentage - a->percentage)) / span);
+}
 
-  return percentage;
+bool battery_set_chemistry(BatteryChemistry_t newChemistry)
+{
+  if (newChemistry >= BATTERY_CHEMISTRY_COUNT) {
+    return false;
+  }
+
+  chemistry = newChemistry;
+  return true;
+}
+
+BatteryChemistry_t battery_get_chemistry(void)
+{
+  return chemistry;
+}
+
+uint32_t battery_get_capacity_mah(void)
+{
+  return dischargeCurves[chemistry].capacityMah;
+}
+
+void battery_set_temp_compensation(battery_temp_compensation_t hook)
+{
+  tempCompensation = hook;
+}
+
+void battery_set_temperature(int16_t temperature_centi)
+{
+  lastTemperature = temperature_centi;
+}
+
+//==============================================================================
+// Interrupt Handlers
+//==============================================================================
+
+void ADC0_IRQHandler(void)
+{
+  ADC_IntClear(ADC0, ADC_IF_SINGLE);
+
+  // Read ADC result (16 averaged 12-bit conversions, 16-bit scale)
+  uint32_t adcResult = ADC_DataSingleGet(ADC0);
+
+  // Power down until the next measurement
+  CMU_ClockEnable(cmuClock_ADC0, false);
+  energy_end(ENERGY_ADC);
+
+  em_stats_release_em1(EM_STATS_REASON_ADC);
+
+  // Calculate voltage in mV
+  // AVDD = (ADC_result * REF_voltage * scale) / ADC_max
+  // For AVDD input, scale factor is 3 (AVDD is divided by 3 internally)
+  uint32_t voltage_mv = (adcResult * ADC_REF_VOLTAGE_MV * 3 + BATTERY_ADC_FULL_SCALE / 2)
+                        / BATTERY_ADC_FULL_SCALE;
+
+  APP_DEBUG("ADC: raw=%lu, voltage=%lu mV", adcResult, voltage_mv);
+
+  lastVoltageMv = (uint16_t)voltage_mv;
+
+  battery_callback_t callback = measureCallback;
+  measureCallback = NULL;
+  measureBusy = false;
+
+  if (callback != NULL) {
+    callback((uint16_t)voltage_mv);
+  }
 }
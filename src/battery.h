@@ -11,29 +11,130 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Hardware oversampling: 16 conversions averaged into one 16-bit result
+#define BATTERY_ADC_OVERSAMPLING    adcOvsRateSel16
+#define BATTERY_ADC_FULL_SCALE      65536       // 16-bit oversampled result
+
+// Per-conversion acquisition time; 16 x (64 + 13) ADC clocks ~ 1.2 ms at 1 MHz
+#define BATTERY_ADC_ACQ_TIME        adcAcqTime64
+
+// Cell chemistry used for the percentage curve (changeable at runtime)
+#define BATTERY_DEFAULT_CHEMISTRY   BATTERY_CHEMISTRY_ALKALINE
+
+// Nominal AA capacity at low drain, for the remaining-life projection
+#define BATTERY_CAPACITY_ALKALINE_MAH   2500
+#define BATTERY_CAPACITY_LITHIUM_MAH    3000
+#define BATTERY_CAPACITY_NIMH_MAH       2000
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  BATTERY_CHEMISTRY_ALKALINE,   // Zn/MnO2: sloped discharge, cliff below 1.1 V/cell
+  BATTERY_CHEMISTRY_LITHIUM,    // Li-FeS2: flat ~1.45 V/cell plateau, sharp knee
+  BATTERY_CHEMISTRY_NIMH,       // NiMH: flat ~1.2 V/cell plateau
+  BATTERY_CHEMISTRY_COUNT
+} BatteryChemistry_t;
+
+/**
+ * @brief Temperature compensation hook
+ * Maps a measured pack voltage to the voltage the discharge table expects
+ * at room temperature (cells read low in the cold at the same charge).
+ *
+ * @param chemistry Active chemistry
+ * @param voltage_mv Measured pack voltage in millivolts
+ * @param temperature_centi Last known temperature in 0.01 °C
+ * @return Compensated pack voltage in millivolts
+ */
+typedef uint16_t (*battery_temp_compensation_t)(BatteryChemistry_t chemistry,
+                                                uint16_t voltage_mv,
+                                                int16_t temperature_centi);
+
+/**
+ * @brief Battery measurement completion callback
+ * Called from ADC0 interrupt context
+ *
+ * @param voltage_mv Battery voltage in millivolts
+ */
+typedef void (*battery_callback_t)(uint16_t voltage_mv);
+
 //==============================================================================
 // Public Functions
 //==============================================================================
 
 /**
  * @brief Initialize battery monitoring
- * Configures ADC for AVDD measurement
+ * Configures ADC for oversampled AVDD measurement and gates its clock
  */
 void battery_init(void);
 
 /**
- * @brief Read battery voltage
- * @return Voltage in millivolts
+ * @brief Start a non-blocking battery measurement
+ * Clocks ADC0, runs one oversampled conversion and delivers the result to
+ * @p callback from the completion interrupt. ADC0 is unclocked again and
+ * its references are off (normal warm-up mode) between measurements.
+ *
+ * @param callback Completion callback (must not be NULL)
+ * @return true if started, false if a measurement is already in progress
  */
-uint16_t battery_read_voltage(void);
+bool battery_start_measurement(battery_callback_t callback);
+
+/**
+ * @brief Check if a measurement is in progress
+ * @return true while ADC0 is converting
+ */
+bool battery_is_busy(void);
+
+/**
+ * @brief Get the result of the last completed measurement
+ * @return Voltage in millivolts, 0 if none yet
+ */
+uint16_t battery_get_last_voltage(void);
 
 /**
  * @brief Convert voltage to percentage
- * For 2xAA batteries (2.0V - 3.2V range)
+ * Piecewise-linear lookup in the 2-cell discharge table of the active
+ * chemistry, after temperature compensation if a hook is installed.
  *
  * @param voltage_mv Voltage in millivolts
  * @return Battery percentage (0-100)
  */
 uint8_t battery_voltage_to_percentage(uint16_t voltage_mv);
 
+/**
+ * @brief Select the discharge curve
+ * @param chemistry Cell chemistry
+ * @return true if valid
+ */
+bool battery_set_chemistry(BatteryChemistry_t chemistry);
+
+/**
+ * @brief Get the active discharge curve
+ * @return Cell chemistry
+ */
+BatteryChemistry_t battery_get_chemistry(void);
+
+/**
+ * @brief Get the nominal capacity of a full battery of the active chemistry
+ * @return Capacity in mAh
+ */
+uint32_t battery_get_capacity_mah(void);
+
+/**
+ * @brief Install a temperature compensation hook
+ * @param hook Compensation function, or NULL to use voltages as measured
+ */
+void battery_set_temp_compensation(battery_temp_compensation_t hook);
+
+/**
+ * @brief Provide the temperature used for compensation
+ * @param temperature_centi Temperature in 0.01 °C
+ */
+void battery_set_temperature(int16_t temperature_centi);
+
 #endif // BATTERY_H
@@ -3,14 +3,24 @@
  * @brief Button driver implementation
  *
  * Implements robust button handling with debouncing and press type detection.
+ * The state machine runs from two stack events: an ISR event the GPIO
+ * interrupt activates on each edge, and an ordinary event it delays to the
+ * end of a debounce or to the long-press threshold. Only the ISR event is
+ * touched from interrupt context. Between presses it costs nothing.
  */
 
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_BUTTON
+
 #include "button.h"
 #include "app.h"
+#include "em_stats.h"
 #include "em_gpio.h"
 #include "em_cmu.h"
 #include "gpiointerrupt.h"
 #include "sl_sleeptimer.h"
+#include "af.h"
+
 
 //==============================================================================
 // Private Types
@@ -44,11 +54,17 @@ static ButtonContext_t buttonContext = {
   .longPressTriggered = false
 };
 
+static sl_zigbee_event_t edgeEvent;          // Activated by the GPIO interrupt
+static sl_zigbee_event_t stepEvent;          // Debounce and long-press deadlines
+
 //==============================================================================
 // Forward Declarations
 //==============================================================================
 
 static void button_gpio_callback(uint8_t intNo);
+static void button_event_handler(sl_zigbee_event_t *event);
+static void run_state_machine(void);
+static void schedule_next_step(uint32_t currentTime);
 static bool is_button_physically_pressed(void);
 static uint32_t get_time_ms(void);
 
@@ -58,6 +74,9 @@ static uint32_t get_time_ms(void);
 
 void button_init(void)
 {
+  sl_zigbee_af_isr_event_init(&edgeEvent, button_event_handler);
+  sl_zigbee_event_init(&stepEvent, button_event_handler);
+
   // Enable GPIO clock
   CMU_ClockEnable(cmuClock_GPIO, true);
 
@@ -77,7 +96,31 @@ void button_init(void)
           'A' + BUTTON_PORT, BUTTON_PIN);
 }
 
-void button_process(void)
+bool button_is_pressed(void)
+{
+  return is_button_physically_pressed();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Button event handler, for both the edge and the step event
+ */
+static void button_event_handler(sl_zigbee_event_t *event)
+{
+  (void)event;
+
+  em_stats_note_wake(EM_STATS_REASON_BUTTON);
+  run_state_machine();
+}
+
+/**
+ * @brief Advance the state machine
+ * Runs on an edge or when a debounce or the long-press threshold is over.
+ */
+static void run_state_machine(void)
 {
   uint32_t currentTime = get_time_ms();
   uint32_t pressedDuration;
@@ -178,17 +221,10 @@ void button_process(void)
       }
       break;
   }
-}
 
-bool button_is_pressed(void)
-{
-  return is_button_physically_pressed();
+  schedule_next_step(currentTime);
 }
 
-//==============================================================================
-// Private Functions
-//==============================================================================
-
 /**
  * @brief GPIO interrupt callback
  * Called by GPIO interrupt handler on both edges
@@ -197,8 +233,47 @@ static void button_gpio_callback(uint8_t intNo)
 {
   (void)intNo;
 
-  // Set flag for processing in main loop
+  em_stats_note_wake(EM_STATS_REASON_BUTTON);
+
+  // State machine runs from the main loop
   buttonContext.interruptPending = true;
+  sl_zigbee_event_set_active(&edgeEvent);
+}
+
+/**
+ * @brief Delay the step event to the end of the debounce or the long-press
+ * threshold; idle states wait for the next edge instead
+ */
+static void schedule_next_step(uint32_t currentTime)
+{
+  uint32_t dueTime;
+
+  switch (buttonContext.state) {
+    case BUTTON_STATE_DEBOUNCE_PRESS:
+      dueTime = buttonContext.pressTimestamp + BUTTON_DEBOUNCE_MS;
+      break;
+
+    case BUTTON_STATE_DEBOUNCE_RELEASE:
+      dueTime = buttonContext.releaseTimestamp + BUTTON_DEBOUNCE_MS;
+      break;
+
+    case BUTTON_STATE_PRESSED:
+      dueTime = buttonContext.pressTimestamp + BUTTON_LONG_PRESS_MS;
+      break;
+
+    default:
+      // Waiting for an edge; the GPIO interrupt activates the edge event
+      sl_zigbee_event_set_inactive(&stepEvent);
+      return;
+  }
+
+  int32_t remaining = (int32_t)(dueTime - currentTime);
+  if (remaining < 0) {
+    remaining = 0;
+  }
+
+  // An edge meanwhile runs the state machine earlier, which is fine
+  sl_zigbee_event_set_delay_ms(&stepEvent, (uint32_t)remaining);
 }
 
 /**
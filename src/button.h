@@ -31,16 +31,11 @@
 
 /**
  * @brief Initialize button driver
- * Configures GPIO with pull-up and interrupt
+ * Configures GPIO with pull-up and interrupt, and the stack event that runs
+ * the state machine (call after stack init)
  */
 void button_init(void);
 
-/**
- * @brief Process button state machine
- * Must be called periodically from main loop
- */
-void button_process(void);
-
 /**
  * @brief Check if button is currently pressed
  * @return true if button is pressed (active low)
@@ -0,0 +1,132 @@
+/**
+ * @file deferred_work.c
+ * @brief Deferred work ring implementation
+ *
+ * Free-running head and tail indices: the producer writes only the head,
+ * the consumer only the tail, and each slot is published or released with
+ * a barrier between the item and the index. The producer never masks
+ * interrupts. The drain event is an ISR event, the kind an interrupt may
+ * activate.
+ */
+
+#include "deferred_work.h"
+#include "em_core.h"
+#include "af.h"
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+#define DEFERRED_WORK_RING_MASK     (DEFERRED_WORK_RING_SIZE - 1u)
+
+#if (DEFERRED_WORK_RING_SIZE & DEFERRED_WORK_RING_MASK) != 0
+#error "DEFERRED_WORK_RING_SIZE must be a power of two"
+#endif
+
+typedef struct {
+  DeferredWorkHandler_t handler;
+  uint32_t arg0;
+  uint32_t arg1;
+} DeferredWorkItem_t;
+
+static DeferredWorkItem_t ring[DEFERRED_WORK_RING_SIZE];
+static volatile uint32_t ringHead = 0;      // Producer only
+static volatile uint32_t ringTail = 0;      // Consumer only
+
+static sl_zigbee_event_t drainEvent;
+
+// posted, overflows and highWater belong to the producer, direct to thread
+// context
+static DeferredWorkStats_t stats;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void drain_event_handler(sl_zigbee_event_t *event);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void deferred_work_init(void)
+{
+  sl_zigbee_af_isr_event_init(&drainEvent, drain_event_handler);
+}
+
+bool deferred_work_post(DeferredWorkHandler_t handler, uint32_t arg0, uint32_t arg1)
+{
+  if (!CORE_InIrqContext()) {
+    stats.direct++;
+    handler(arg0, arg1);
+    return true;
+  }
+
+  uint32_t head = ringHead;
+  uint32_t depth = head - ringTail;
+
+  // Never run stack work here; the producer copes with the loss
+  if (depth >= DEFERRED_WORK_RING_SIZE) {
+    stats.overflows++;
+    return false;
+  }
+
+  DeferredWorkItem_t *item = &ring[head & DEFERRED_WORK_RING_MASK];
+  item->handler = handler;
+  item->arg0 = arg0;
+  item->arg1 = arg1;
+
+  __DMB();      // Item written before the consumer can see it
+  ringHead = head + 1u;
+
+  stats.posted++;
+  if (depth + 1u > stats.highWater) {
+    stats.highWater = (uint8_t)(depth + 1u);
+  }
+
+  sl_zigbee_event_set_active(&drainEvent);
+  return true;
+}
+
+void deferred_work_get_stats(DeferredWorkStats_t *out)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = stats;
+  CORE_EXIT_ATOMIC();
+}
+
+void deferred_work_reset_stats(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  stats = (DeferredWorkStats_t){ 0 };
+  CORE_EXIT_ATOMIC();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Run every queued item, including ones posted meanwhile
+ */
+static void drain_event_handler(sl_zigbee_event_t *event)
+{
+  (void)event;
+
+  for (;;) {
+    uint32_t tail = ringTail;
+
+    if (tail == ringHead) {
+      break;
+    }
+
+    __DMB();    // Head read before the item it publishes
+    DeferredWorkItem_t item = ring[tail & DEFERRED_WORK_RING_MASK];
+    __DMB();    // Item copied before the slot is handed back
+    ringTail = tail + 1u;
+
+    item.handler(item.arg0, item.arg1);
+  }
+}
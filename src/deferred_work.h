@@ -0,0 +1,79 @@
+/**
+ * @file deferred_work.h
+ * @brief Deferred work ring from interrupt to stack context
+ *
+ * Sleeptimer, I2C, ADC and GPIO callbacks run in interrupt context, where
+ * ZCL attribute writes, reporting and the log must not run. They post a
+ * small work item here instead; a stack event drains the ring from the main
+ * loop before the device sleeps again. Work never runs in interrupt
+ * context: if the ring is full the item is dropped and counted, so a
+ * producer must tolerate losing one (check the return value, or rely on
+ * the next sample).
+ *
+ * The ring is lock-free single producer, single consumer: interrupt
+ * handlers produce, the stack event consumes. All producers share one NVIC
+ * priority (the Gecko SDK default for sleeptimer, I2C, ADC and GPIO), so
+ * they never preempt each other and act as one producer. A handler at a
+ * different priority must not post.
+ */
+
+#ifndef DEFERRED_WORK_H
+#define DEFERRED_WORK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Ring slots (power of two). A wake posts at most a timer expiry and a
+// driver completion or two; see the high-water mark before shrinking it
+#define DEFERRED_WORK_RING_SIZE     8
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef void (*DeferredWorkHandler_t)(uint32_t arg0, uint32_t arg1);
+
+typedef struct {
+  uint32_t posted;              // Items queued from interrupt context
+  uint32_t direct;              // Posts from thread context, run at once
+  uint32_t overflows;           // Ring full, item dropped
+  uint8_t highWater;            // Deepest the ring has been
+} DeferredWorkStats_t;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Set up the drain event; call before any producer can post
+ */
+void deferred_work_init(void);
+
+/**
+ * @brief Run a handler in stack context
+ * From interrupt context the item is queued and the handler runs from the
+ * next main-loop pass; from thread context it runs at once. If the ring is
+ * full the item is dropped and counted as an overflow.
+ * @param handler Work to run
+ * @param arg0 Passed to the handler
+ * @param arg1 Passed to the handler
+ * @return false if the item was dropped
+ */
+bool deferred_work_post(DeferredWorkHandler_t handler, uint32_t arg0, uint32_t arg1);
+
+/**
+ * @brief Get queue counters since boot or the last reset
+ * @param[out] stats Counters to fill
+ */
+void deferred_work_get_stats(DeferredWorkStats_t *stats);
+
+/**
+ * @brief Clear the queue counters and the high-water mark
+ */
+void deferred_work_reset_stats(void);
+
+#endif // DEFERRED_WORK_H
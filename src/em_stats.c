@@ -0,0 +1,212 @@
+/**
+ * @file em_stats.c
+ * @brief Energy-mode residency counters implementation
+ *
+ * Totals only ever grow; em_stats_reset() snapshots them as a baseline so
+ * other consumers (energy accounting) are not disturbed by a CLI reset.
+ */
+
+#include "em_stats.h"
+#include "wake_trace.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "sl_component_catalog.h"
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+#include "sl_power_manager.h"
+#endif
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static EmStats_t totals;
+static EmStats_t baseline;
+
+static EmStatsMode_t currentMode = EM_STATS_EM0;
+static uint64_t modeEnterTick = 0;
+
+// Reason for the current awake period (cleared when entering EM2)
+static bool wakeReasonNoted = false;
+static EmStatsReason_t wakeReason = EM_STATS_REASON_STACK;
+
+static uint64_t holdStartTick[EM_STATS_REASON_COUNT];
+
+static const char * const reasonNames[EM_STATS_REASON_COUNT] = {
+  "stack", "sensor", "battery", "radio", "button", "i2c", "adc"
+};
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+static sl_power_manager_em_transition_event_handle_t emEventHandle;
+#endif
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static uint64_t ticks_to_us(uint64_t ticks);
+static void close_interval(uint64_t now);
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+static void em_transition_callback(sl_power_manager_em_t from, sl_power_manager_em_t to);
+#endif
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void em_stats_init(void)
+{
+  modeEnterTick = sl_sleeptimer_get_tick_count64();
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  static const sl_power_manager_em_transition_event_info_t emEventInfo = {
+    .event_mask = SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM0
+                  | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM1
+                  | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM2
+                  | SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM3,
+    .on_event = em_transition_callback
+  };
+
+  sl_power_manager_subscribe_em_transition_event(&emEventHandle, &emEventInfo);
+#endif
+}
+
+void em_stats_note_wake(EmStatsReason_t reason)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (!wakeReasonNoted) {
+    wakeReasonNoted = true;
+    wakeReason = reason;
+    totals.em0ReasonCount[reason]++;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+void em_stats_require_em1(EmStatsReason_t reason)
+{
+  holdStartTick[reason] = sl_sleeptimer_get_tick_count64();
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+}
+
+void em_stats_release_em1(EmStatsReason_t reason)
+{
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+  sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+#endif
+
+  uint64_t held = sl_sleeptimer_get_tick_count64() - holdStartTick[reason];
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  totals.em1ReasonUs[reason] += ticks_to_us(held);
+  totals.em1ReasonCount[reason]++;
+  CORE_EXIT_ATOMIC();
+}
+
+void em_stats_get(EmStats_t *stats)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  close_interval(sl_sleeptimer_get_tick_count64());
+  EmStats_t now = totals;
+  CORE_EXIT_ATOMIC();
+
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    stats->residencyUs[i] = now.residencyUs[i] - baseline.residencyUs[i];
+    stats->entries[i] = now.entries[i] - baseline.entries[i];
+  }
+
+  for (uint8_t i = 0; i < EM_STATS_REASON_COUNT; i++) {
+    stats->em0ReasonUs[i] = now.em0ReasonUs[i] - baseline.em0ReasonUs[i];
+    stats->em0ReasonCount[i] = now.em0ReasonCount[i] - baseline.em0ReasonCount[i];
+    stats->em1ReasonUs[i] = now.em1ReasonUs[i] - baseline.em1ReasonUs[i];
+    stats->em1ReasonCount[i] = now.em1ReasonCount[i] - baseline.em1ReasonCount[i];
+  }
+}
+
+uint64_t em_stats_get_total_us(EmStatsMode_t mode)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  close_interval(sl_sleeptimer_get_tick_count64());
+  uint64_t total = totals.residencyUs[mode];
+  CORE_EXIT_ATOMIC();
+
+  return total;
+}
+
+void em_stats_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  close_interval(sl_sleeptimer_get_tick_count64());
+  baseline = totals;
+  CORE_EXIT_ATOMIC();
+}
+
+const char *em_stats_reason_name(EmStatsReason_t reason)
+{
+  return (reason < EM_STATS_REASON_COUNT) ? reasonNames[reason] : "?";
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Convert sleeptimer ticks to microseconds
+ */
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+  return (ticks * 1000000u) / sl_sleeptimer_get_timer_frequency();
+}
+
+/**
+ * @brief Fold the time since the last transition into the current mode
+ * Called with interrupts masked.
+ */
+static void close_interval(uint64_t now)
+{
+  uint64_t us = ticks_to_us(now - modeEnterTick);
+
+  totals.residencyUs[currentMode] += us;
+  if (currentMode == EM_STATS_EM0) {
+    totals.em0ReasonUs[wakeReasonNoted ? wakeReason : EM_STATS_REASON_STACK] += us;
+  }
+
+  modeEnterTick = now;
+}
+
+#ifdef SL_CATALOG_POWER_MANAGER_PRESENT
+/**
+ * @brief Power-manager EM transition
+ * Called with interrupts disabled just before sleeping and after waking.
+ */
+static void em_transition_callback(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  (void)from;
+
+  close_interval(sl_sleeptimer_get_tick_count64());
+
+  // EM3 is not used by this application; count anything deeper as EM2
+  currentMode = (to == SL_POWER_MANAGER_EM0) ? EM_STATS_EM0
+                : (to == SL_POWER_MANAGER_EM1) ? EM_STATS_EM1
+                : EM_STATS_EM2;
+  totals.entries[currentMode]++;
+
+  if (currentMode == EM_STATS_EM2) {
+    WAKE_TRACE_END(WAKE_PHASE_RETURN_TO_SLEEP);
+
+    // A real sleep ends the awake period
+    if (!wakeReasonNoted) {
+      totals.em0ReasonCount[EM_STATS_REASON_STACK]++;
+    }
+    wakeReasonNoted = false;
+  }
+}
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file em_stats.h
+ * @brief Energy-mode residency counters
+ *
+ * Subscribes to power-manager EM transition events and keeps residency
+ * time and entry counts per energy mode, plus the reasons the device was
+ * kept in EM0 (who woke it) and EM1 (who held an EM1 requirement). Meant to
+ * catch changes that quietly keep the device awake.
+ */
+
+#ifndef EM_STATS_H
+#define EM_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Reasons listed by the CLI for each of EM0 and EM1
+#define EM_STATS_TOP_REASONS    3
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  EM_STATS_EM0,
+  EM_STATS_EM1,
+  EM_STATS_EM2,
+  EM_STATS_MODE_COUNT
+} EmStatsMode_t;
+
+typedef enum {
+  EM_STATS_REASON_STACK,        // Awake with no application reason noted
+  EM_STATS_REASON_SENSOR,       // Sensor timer or ALERT
+  EM_STATS_REASON_BATTERY,      // Battery schedule
+  EM_STATS_REASON_RADIO,        // Incoming or sent message
+  EM_STATS_REASON_BUTTON,       // Button press
+  EM_STATS_REASON_I2C,          // I2C transfer in flight (EM1 requirement)
+  EM_STATS_REASON_ADC,          // ADC conversion in flight (EM1 requirement)
+  EM_STATS_REASON_COUNT
+} EmStatsReason_t;
+
+typedef struct {
+  uint64_t residencyUs[EM_STATS_MODE_COUNT];      // Time spent in each mode
+  uint32_t entries[EM_STATS_MODE_COUNT];          // Transitions into each mode
+  uint64_t em0ReasonUs[EM_STATS_REASON_COUNT];    // EM0 time by wake reason
+  uint32_t em0ReasonCount[EM_STATS_REASON_COUNT];
+  uint64_t em1ReasonUs[EM_STATS_REASON_COUNT];    // EM1 requirement hold time
+  uint32_t em1ReasonCount[EM_STATS_REASON_COUNT];
+} EmStats_t;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Subscribe to power-manager EM transitions
+ * No-op without the power manager component
+ */
+void em_stats_init(void);
+
+/**
+ * @brief Attribute the current awake period to a reason
+ * The first reason noted after a wakeup wins; call it at the top of timer,
+ * GPIO and stack callbacks. Interrupt safe.
+ *
+ * @param reason Why the device is awake
+ */
+void em_stats_note_wake(EmStatsReason_t reason);
+
+/**
+ * @brief Add an EM1 requirement on behalf of a reason
+ * Wraps sl_power_manager_add_em_requirement() and starts timing the hold.
+ * Interrupt safe. Requirements of one reason must not nest.
+ *
+ * @param reason Holder of the requirement
+ */
+void em_stats_require_em1(EmStatsReason_t reason);
+
+/**
+ * @brief Remove an EM1 requirement added with em_stats_require_em1()
+ * @param reason Holder of the requirement
+ */
+void em_stats_release_em1(EmStatsReason_t reason);
+
+/**
+ * @brief Get counters since the last em_stats_reset()
+ * @param[out] stats Counters to fill
+ */
+void em_stats_get(EmStats_t *stats);
+
+/**
+ * @brief Get total residency in a mode since boot (never reset)
+ * For consumers that keep their own baseline, such as energy accounting.
+ *
+ * @param mode Energy mode
+ * @return Residency in microseconds
+ */
+uint64_t em_stats_get_total_us(EmStatsMode_t mode);
+
+/**
+ * @brief Restart the counters reported by em_stats_get()
+ */
+void em_stats_reset(void);
+
+/**
+ * @brief Get a printable reason name
+ * @param reason Reason
+ * @return Short name
+ */
+const char *em_stats_reason_name(EmStatsReason_t reason);
+
+#endif // EM_STATS_H
@@ -0,0 +1,184 @@
+/**
+ * @file energy.c
+ * @brief Software coulomb counter implementation
+ *
+ * EM residency comes from em_stats (against a baseline taken at reset);
+ * peripheral time from begin/end hooks in the drivers; radio time from frame
+ * lengths.
+ */
+
+#include "energy.h"
+#include "em_stats.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+// Projection needs at least this much history to mean anything
+#define ENERGY_MIN_PROJECTION_S     3600
+
+static const uint16_t currentTableUa[ENERGY_SUBSYSTEM_COUNT] = {
+  ENERGY_CURRENT_EM0_UA,
+  ENERGY_CURRENT_EM1_UA,
+  ENERGY_CURRENT_EM2_UA,
+  ENERGY_CURRENT_RADIO_TX_UA,
+  ENERGY_CURRENT_RADIO_RX_UA,
+  ENERGY_CURRENT_I2C_UA,
+  ENERGY_CURRENT_ADC_UA
+};
+
+static uint64_t timeUs[ENERGY_SUBSYSTEM_COUNT];
+static uint64_t activityStartTick[ENERGY_SUBSYSTEM_COUNT];
+static uint64_t resetTick = 0;
+
+// em_stats totals at the last reset; EnergySubsystem_t EM entries share its order
+static uint64_t emBaselineUs[EM_STATS_MODE_COUNT];
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static uint64_t ticks_to_us(uint64_t ticks);
+static uint32_t radio_airtime_us(uint16_t bytes);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void energy_init(void)
+{
+  energy_reset();
+}
+
+void energy_begin(EnergySubsystem_t subsystem)
+{
+  activityStartTick[subsystem] = sl_sleeptimer_get_tick_count64();
+}
+
+void energy_end(EnergySubsystem_t subsystem)
+{
+  uint64_t elapsed = sl_sleeptimer_get_tick_count64() - activityStartTick[subsystem];
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  timeUs[subsystem] += ticks_to_us(elapsed);
+  CORE_EXIT_ATOMIC();
+}
+
+void energy_add_radio_tx(uint16_t payload_bytes)
+{
+  uint32_t txUs = radio_airtime_us(payload_bytes + ENERGY_RADIO_FRAME_OVERHEAD);
+  uint32_t rxUs = ENERGY_RADIO_TURNAROUND_US + radio_airtime_us(ENERGY_RADIO_ACK_BYTES);
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  timeUs[ENERGY_RADIO_TX] += txUs;
+  timeUs[ENERGY_RADIO_RX] += rxUs;
+  CORE_EXIT_ATOMIC();
+}
+
+void energy_add_radio_rx(uint16_t payload_bytes)
+{
+  uint32_t rxUs = radio_airtime_us(payload_bytes + ENERGY_RADIO_FRAME_OVERHEAD);
+  uint32_t txUs = ENERGY_RADIO_TURNAROUND_US + radio_airtime_us(ENERGY_RADIO_ACK_BYTES);
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  timeUs[ENERGY_RADIO_RX] += rxUs;
+  timeUs[ENERGY_RADIO_TX] += txUs;
+  CORE_EXIT_ATOMIC();
+}
+
+void energy_add_radio_poll(void)
+{
+  uint32_t txUs = radio_airtime_us(ENERGY_RADIO_POLL_TX_BYTES);
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  timeUs[ENERGY_RADIO_TX] += txUs;
+  timeUs[ENERGY_RADIO_RX] += ENERGY_RADIO_POLL_RX_US;
+  CORE_EXIT_ATOMIC();
+}
+
+void energy_get_report(EnergyReport_t *report)
+{
+  uint64_t now = sl_sleeptimer_get_tick_count64();
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  for (uint8_t i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++) {
+    report->timeUs[i] = timeUs[i];
+  }
+  CORE_EXIT_ATOMIC();
+
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    report->timeUs[ENERGY_EM0 + i] = em_stats_get_total_us((EmStatsMode_t)i) - emBaselineUs[i];
+  }
+
+  uint64_t chargeUaUs = 0;
+  report->totalUah = 0;
+  for (uint8_t i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++) {
+    uint64_t uaUs = report->timeUs[i] * currentTableUa[i];
+    report->chargeUah[i] = (uint32_t)(uaUs / 3600000000ull);
+    report->totalUah += report->chargeUah[i];
+    chargeUaUs += uaUs;
+  }
+
+  uint64_t elapsedUs = ticks_to_us(now - resetTick);
+  report->elapsedS = (uint32_t)(elapsedUs / 1000000u);
+  report->averageCentiUa = (elapsedUs >= 100u)
+                           ? (uint32_t)(chargeUaUs / (elapsedUs / 100u))
+                           : 0;
+}
+
+void energy_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  for (uint8_t i = 0; i < ENERGY_SUBSYSTEM_COUNT; i++) {
+    timeUs[i] = 0;
+  }
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    emBaselineUs[i] = em_stats_get_total_us((EmStatsMode_t)i);
+  }
+  resetTick = sl_sleeptimer_get_tick_count64();
+  CORE_EXIT_ATOMIC();
+}
+
+uint16_t energy_project_life_days(uint32_t capacity_mah, uint8_t percentage)
+{
+  EnergyReport_t report;
+  energy_get_report(&report);
+
+  if (report.elapsedS < ENERGY_MIN_PROJECTION_S || report.averageCentiUa == 0) {
+    return 0xFFFF;
+  }
+
+  // Remaining charge in 0.01 uAh over average current in 0.01 uA = hours
+  uint64_t remainingCentiUah = (uint64_t)capacity_mah * 1000u * percentage;
+  uint64_t days = remainingCentiUah / report.averageCentiUa / 24u;
+
+  return (days >= 0xFFFF) ? 0xFFFE : (uint16_t)days;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Convert sleeptimer ticks to microseconds
+ */
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+  return (ticks * 1000000u) / sl_sleeptimer_get_timer_frequency();
+}
+
+/**
+ * @brief On-air time of a frame, including the PHY header
+ */
+static uint32_t radio_airtime_us(uint16_t bytes)
+{
+  return (uint32_t)(bytes + ENERGY_RADIO_PHY_BYTES) * ENERGY_RADIO_US_PER_BYTE;
+}
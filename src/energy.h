@@ -0,0 +1,130 @@
+/**
+ * @file energy.h
+ * @brief Software coulomb counter
+ *
+ * Accumulates time spent in each energy mode and in each active subsystem
+ * (radio, I2C, ADC) and weights it by a current table to estimate the
+ * charge drawn since boot or the last reset.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Current table in uA. EM entries are whole-chip currents at 3 V
+// (EFR32MG1 datasheet typicals, 38.4 MHz HFXO); the others are drawn on top
+// of the EM the core is in meanwhile. Calibrate against a power analyzer.
+#define ENERGY_CURRENT_EM0_UA           2400    // 63 uA/MHz
+#define ENERGY_CURRENT_EM1_UA           1350    // 35 uA/MHz
+#define ENERGY_CURRENT_EM2_UA           3       // RTCC running, full RAM retained
+#define ENERGY_CURRENT_RADIO_TX_UA      7100    // 0 dBm, on top of EM1
+#define ENERGY_CURRENT_RADIO_RX_UA      8500    // On top of EM1
+#define ENERGY_CURRENT_I2C_UA           800     // SHT31 active + pull-ups
+#define ENERGY_CURRENT_ADC_UA           150     // ADC0 + 1.25 V reference
+
+// 802.15.4 airtime: 32 us per byte at 250 kbps, plus the 6-byte PHY
+// preamble/header and the 192 us RX/TX turnaround
+#define ENERGY_RADIO_US_PER_BYTE        32
+#define ENERGY_RADIO_PHY_BYTES          6
+#define ENERGY_RADIO_TURNAROUND_US      192
+
+// MAC + NWK + NWK security + APS overhead around an APS payload
+#define ENERGY_RADIO_FRAME_OVERHEAD     41
+#define ENERGY_RADIO_ACK_BYTES          5
+
+// Data poll: MAC Data Request out, ACK plus a short listen for pending data
+#define ENERGY_RADIO_POLL_TX_BYTES      18
+#define ENERGY_RADIO_POLL_RX_US         1000
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  ENERGY_EM0,
+  ENERGY_EM1,
+  ENERGY_EM2,
+  ENERGY_RADIO_TX,
+  ENERGY_RADIO_RX,
+  ENERGY_I2C,
+  ENERGY_ADC,
+  ENERGY_SUBSYSTEM_COUNT
+} EnergySubsystem_t;
+
+typedef struct {
+  uint64_t timeUs[ENERGY_SUBSYSTEM_COUNT];      // Time attributed to each entry
+  uint32_t chargeUah[ENERGY_SUBSYSTEM_COUNT];   // Estimated charge per entry
+  uint32_t totalUah;                            // Sum of all entries
+  uint32_t elapsedS;                            // Time since energy_reset()
+  uint32_t averageCentiUa;                      // Average current, 0.01 uA
+} EnergyReport_t;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Start accounting
+ * EM residency is taken from em_stats; call em_stats_init() first
+ */
+void energy_init(void);
+
+/**
+ * @brief Mark the start of a subsystem activity (I2C transfer, ADC conversion)
+ * Interrupt safe. Activities of one subsystem must not overlap.
+ *
+ * @param subsystem ENERGY_I2C or ENERGY_ADC
+ */
+void energy_begin(EnergySubsystem_t subsystem);
+
+/**
+ * @brief Mark the end of an activity started with energy_begin()
+ * @param subsystem ENERGY_I2C or ENERGY_ADC
+ */
+void energy_end(EnergySubsystem_t subsystem);
+
+/**
+ * @brief Account one transmitted APS frame and its MAC ACK
+ * @param payload_bytes APS payload length
+ */
+void energy_add_radio_tx(uint16_t payload_bytes);
+
+/**
+ * @brief Account one received APS frame
+ * @param payload_bytes APS payload length
+ */
+void energy_add_radio_rx(uint16_t payload_bytes);
+
+/**
+ * @brief Account one data poll (request out, ACK and listen window in)
+ */
+void energy_add_radio_poll(void);
+
+/**
+ * @brief Fill a report with times and estimated charge
+ * @param[out] report Report to fill
+ */
+void energy_get_report(EnergyReport_t *report);
+
+/**
+ * @brief Clear all counters and restart the elapsed time
+ */
+void energy_reset(void);
+
+/**
+ * @brief Project the remaining battery life
+ * Divides the remaining capacity by the average current measured so far.
+ *
+ * @param capacity_mah Nominal capacity of a full battery
+ * @param percentage Remaining capacity in percent (0-100)
+ * @return Projected days, 0xFFFF if not enough data yet
+ */
+uint16_t energy_project_life_days(uint32_t capacity_mah, uint8_t percentage);
+
+#endif // ENERGY_H
@@ -0,0 +1,359 @@
+/**
+ * @file i2c_bus.c
+ * @brief Interrupt-driven I2C0 transfer engine implementation
+ *
+ * emlib's I2C_Transfer() state machine is stepped from I2C0_IRQHandler
+ * instead of a polling loop. A one-shot sleeptimer enforces the deadline.
+ */
+
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_I2C_BUS
+
+#include "i2c_bus.h"
+#include "app.h"
+#include "energy.h"
+#include "em_stats.h"
+#include "em_i2c.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_emu.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "sl_udelay.h"
+
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+// Interrupt sources that advance the emlib transfer state machine
+#define I2C_BUS_IRQ_FLAGS   (I2C_IF_ACK | I2C_IF_NACK | I2C_IF_RXDATAV \
+                             | I2C_IF_MSTOP | I2C_IF_ARBLOST | I2C_IF_BUSERR)
+
+typedef struct {
+  bool busy;
+  bool suspended;
+  i2c_bus_callback_t callback;
+  void *context;
+} I2cBusContext_t;
+
+static I2cBusContext_t busContext = {
+  .busy = false,
+  .suspended = false,
+  .callback = NULL,
+  .context = NULL
+};
+
+static sl_sleeptimer_timer_handle_t deadlineTimer;
+
+// Completion state for i2c_bus_transfer_blocking()
+static volatile bool blockingDone = false;
+static volatile I2cBusStatus_t blockingStatus = I2C_BUS_OK;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void i2c_peripheral_init(void);
+static bool is_bus_stuck(void);
+static void complete_transfer(I2cBusStatus_t status);
+static I2cBusStatus_t map_transfer_result(I2C_TransferReturn_TypeDef ret);
+static void deadline_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void blocking_callback(I2cBusStatus_t status, void *context);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void i2c_bus_init(void)
+{
+  // Enable clocks
+  CMU_ClockEnable(cmuClock_GPIO, true);
+  CMU_ClockEnable(cmuClock_I2C0, true);
+
+  i2c_peripheral_init();
+
+  if (is_bus_stuck()) {
+    APP_LOG("I2C bus held low at init - recovering");
+    i2c_bus_recover();
+  }
+
+  NVIC_ClearPendingIRQ(I2C0_IRQn);
+  NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+bool i2c_bus_transfer(I2C_TransferSeq_TypeDef *seq,
+                      uint32_t timeout_ms,
+                      i2c_bus_callback_t callback,
+                      void *context)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (busContext.busy) {
+    CORE_EXIT_ATOMIC();
+    return false;
+  }
+  busContext.busy = true;
+  busContext.callback = callback;
+  busContext.context = context;
+  CORE_EXIT_ATOMIC();
+
+  energy_begin(ENERGY_I2C);
+
+  // I2C0 runs from HFPERCLK, which is off in EM2
+  em_stats_require_em1(EM_STATS_REASON_I2C);
+
+  // Bring the bus back just in time if it was gated
+  i2c_bus_resume();
+
+  // A slave left holding SDA (e.g. after a brown-out mid-read) blocks START
+  if (is_bus_stuck()) {
+    APP_ERROR("I2C bus held low - recovering");
+    if (!i2c_bus_recover()) {
+      complete_transfer(I2C_BUS_ERROR);
+      return true;
+    }
+  }
+
+  sl_sleeptimer_start_timer_ms(&deadlineTimer,
+                               timeout_ms,
+                               deadline_timer_callback,
+                               NULL,
+                               0,
+                               0);
+
+  I2C_IntClear(I2C0, _I2C_IF_MASK);
+  I2C_TransferReturn_TypeDef ret = I2C_TransferInit(I2C0, seq);
+  if (ret != i2cTransferInProgress) {
+    complete_transfer(map_transfer_result(ret));
+    return true;
+  }
+
+  I2C_IntEnable(I2C0, I2C_BUS_IRQ_FLAGS);
+  return true;
+}
+
+I2cBusStatus_t i2c_bus_transfer_blocking(I2C_TransferSeq_TypeDef *seq,
+                                         uint32_t timeout_ms)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  blockingDone = false;
+  if (!i2c_bus_transfer(seq, timeout_ms, blocking_callback, NULL)) {
+    return I2C_BUS_BUSY;
+  }
+
+  // Sleep in EM1 until the IRQ or the deadline completes the transfer.
+  // Checking the flag with interrupts masked avoids missing the wakeup.
+  CORE_ENTER_CRITICAL();
+  while (!blockingDone) {
+    EMU_EnterEM1();
+    CORE_EXIT_CRITICAL();
+    CORE_ENTER_CRITICAL();
+  }
+  CORE_EXIT_CRITICAL();
+
+  return blockingStatus;
+}
+
+bool i2c_bus_is_busy(void)
+{
+  return busContext.busy;
+}
+
+void i2c_bus_suspend(bool park_pins)
+{
+  if (busContext.busy || busContext.suspended) {
+    return;
+  }
+
+  I2C_Enable(I2C0, false);
+  I2C0->ROUTEPEN = 0;
+  CMU_ClockEnable(cmuClock_I2C0, false);
+
+  if (park_pins) {
+    // High-Z without pull-up so an unpowered sensor is not back-fed
+    GPIO_PinModeSet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, gpioModeDisabled, 0);
+    GPIO_PinModeSet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, gpioModeDisabled, 0);
+  }
+
+  busContext.suspended = true;
+}
+
+void i2c_bus_resume(void)
+{
+  if (!busContext.suspended) {
+    return;
+  }
+
+  CMU_ClockEnable(cmuClock_I2C0, true);
+  i2c_peripheral_init();
+  busContext.suspended = false;
+}
+
+bool i2c_bus_recover(void)
+{
+  // Take the pins away from the peripheral and bit-bang them
+  I2C0->ROUTEPEN = 0;
+  GPIO_PinModeSet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, gpioModeWiredAndPullUp, 1);
+  GPIO_PinModeSet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, gpioModeWiredAndPullUp, 1);
+
+  // Clock out whatever byte the slave thinks it is still sending
+  for (uint8_t i = 0; i < I2C_BUS_RECOVERY_PULSES; i++) {
+    GPIO_PinOutClear(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN);
+    sl_udelay_wait(I2C_BUS_RECOVERY_HALF_US);
+    GPIO_PinOutSet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN);
+    sl_udelay_wait(I2C_BUS_RECOVERY_HALF_US);
+  }
+
+  // STOP: SDA low -> high while SCL is high
+  GPIO_PinOutClear(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN);
+  sl_udelay_wait(I2C_BUS_RECOVERY_HALF_US);
+  GPIO_PinOutSet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN);
+  sl_udelay_wait(I2C_BUS_RECOVERY_HALF_US);
+
+  bool released = !is_bus_stuck();
+
+  // Hand the pins back and bring the peripheral to a known idle state
+  i2c_peripheral_init();
+
+  if (!released) {
+    APP_ERROR("I2C bus recovery failed (SCL=%d, SDA=%d)",
+              GPIO_PinInGet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN),
+              GPIO_PinInGet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN));
+  }
+
+  return released;
+}
+
+//==============================================================================
+// Interrupt Handlers
+//==============================================================================
+
+void I2C0_IRQHandler(void)
+{
+  I2C_TransferReturn_TypeDef ret = I2C_Transfer(I2C0);
+
+  if (ret != i2cTransferInProgress) {
+    complete_transfer(map_transfer_result(ret));
+  }
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Configure pins, routing and I2C0 master mode
+ */
+static void i2c_peripheral_init(void)
+{
+  // Configure GPIO pins for I2C
+  GPIO_PinModeSet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, gpioModeWiredAndPullUpFilter, 1);
+  GPIO_PinModeSet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, gpioModeWiredAndPullUpFilter, 1);
+
+  // Initialize I2C
+  I2C_Init_TypeDef i2cInit = I2C_INIT_DEFAULT;
+  i2cInit.freq = I2C_FREQ_STANDARD_MAX;  // 100 kHz
+  i2cInit.clhr = i2cClockHLRStandard;
+
+  // Route I2C pins
+  I2C0->ROUTEPEN = I2C_ROUTEPEN_SDAPEN | I2C_ROUTEPEN_SCLPEN;
+  I2C0->ROUTELOC0 = (I2C_BUS_SDA_LOC) | (I2C_BUS_SCL_LOC);
+
+  I2C_Init(I2C0, &i2cInit);
+
+  // Make sure the master state machine is idle
+  if (I2C0->STATE & I2C_STATE_BUSY) {
+    I2C0->CMD = I2C_CMD_ABORT;
+  }
+}
+
+/**
+ * @brief Check for a slave (or short) holding SCL or SDA low
+ */
+static bool is_bus_stuck(void)
+{
+  return (GPIO_PinInGet(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN) == 0)
+         || (GPIO_PinInGet(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN) == 0);
+}
+
+/**
+ * @brief Finish the current transfer exactly once
+ * Races between the I2C IRQ and the deadline timer are resolved here.
+ */
+static void complete_transfer(I2cBusStatus_t status)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (!busContext.busy) {
+    CORE_EXIT_ATOMIC();
+    return;
+  }
+  i2c_bus_callback_t callback = busContext.callback;
+  void *context = busContext.context;
+  busContext.busy = false;
+  busContext.callback = NULL;
+  busContext.context = NULL;
+  CORE_EXIT_ATOMIC();
+
+  I2C_IntDisable(I2C0, I2C_BUS_IRQ_FLAGS);
+  sl_sleeptimer_stop_timer(&deadlineTimer);
+  energy_end(ENERGY_I2C);
+
+  em_stats_release_em1(EM_STATS_REASON_I2C);
+
+  if (callback != NULL) {
+    callback(status, context);
+  }
+}
+
+/**
+ * @brief Map an emlib transfer result to a bus status
+ */
+static I2cBusStatus_t map_transfer_result(I2C_TransferReturn_TypeDef ret)
+{
+  switch (ret) {
+    case i2cTransferDone:
+      return I2C_BUS_OK;
+    case i2cTransferNack:
+      return I2C_BUS_NACK;
+    default:
+      return I2C_BUS_ERROR;
+  }
+}
+
+/**
+ * @brief Transfer deadline expired
+ * Aborts the transfer and recovers the bus before reporting the timeout.
+ */
+static void deadline_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  if (!busContext.busy) {
+    return;
+  }
+
+  I2C_IntDisable(I2C0, I2C_BUS_IRQ_FLAGS);
+  I2C0->CMD = I2C_CMD_ABORT;
+
+  APP_ERROR("I2C transfer timed out");
+  i2c_bus_recover();
+
+  complete_transfer(I2C_BUS_TIMEOUT);
+}
+
+/**
+ * @brief Completion callback used by i2c_bus_transfer_blocking()
+ */
+static void blocking_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  blockingStatus = status;
+  blockingDone = true;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file i2c_bus.h
+ * @brief Interrupt-driven I2C0 transfer engine
+ *
+ * Shared I2C0 master for all sensors on the bus. Transfers run from the
+ * I2C0 interrupt while the core waits in EM1, every transfer has a
+ * deadline, and a stuck bus is recovered with 9 SCL pulses and a STOP.
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_i2c.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// I2C0 pins (PC10/PC11, location 14)
+#define I2C_BUS_SDA_PORT            gpioPortC
+#define I2C_BUS_SDA_PIN             10          // PC10 (Pin 24)
+#define I2C_BUS_SCL_PORT            gpioPortC
+#define I2C_BUS_SCL_PIN             11          // PC11 (Pin 25)
+#define I2C_BUS_SDA_LOC             _I2C_ROUTELOC0_SDALOC_LOC14
+#define I2C_BUS_SCL_LOC             _I2C_ROUTELOC0_SCLLOC_LOC14
+
+// Default per-transfer deadline (a 6-byte read at 100 kHz takes < 1 ms)
+#define I2C_BUS_DEFAULT_TIMEOUT_MS  10
+
+// Bus recovery: SCL pulses to free a slave holding SDA low
+#define I2C_BUS_RECOVERY_PULSES     9
+#define I2C_BUS_RECOVERY_HALF_US    5           // 100 kHz half period
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  I2C_BUS_OK,
+  I2C_BUS_NACK,
+  I2C_BUS_ERROR,
+  I2C_BUS_TIMEOUT,
+  I2C_BUS_BUSY
+} I2cBusStatus_t;
+
+/**
+ * @brief Transfer completion callback
+ * Called from interrupt context (I2C0 IRQ or deadline sleeptimer)
+ *
+ * @param status Transfer result
+ * @param context User pointer passed to i2c_bus_transfer()
+ */
+typedef void (*i2c_bus_callback_t)(I2cBusStatus_t status, void *context);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Initialize I2C0 master and its interrupt
+ * Enables clocks, routes PC10/PC11 and recovers the bus if it is held low
+ */
+void i2c_bus_init(void);
+
+/**
+ * @brief Start an interrupt-driven transfer
+ * The sequence and its buffers must stay valid until the callback runs.
+ * EM2 is blocked (I2C0 is not clocked there) until the transfer completes.
+ *
+ * @param seq Transfer sequence
+ * @param timeout_ms Deadline after which the transfer is aborted
+ * @param callback Completion callback (must not be NULL)
+ * @param context User pointer handed back to the callback
+ * @return true if the transfer was started, false if the bus is busy
+ */
+bool i2c_bus_transfer(I2C_TransferSeq_TypeDef *seq,
+                      uint32_t timeout_ms,
+                      i2c_bus_callback_t callback,
+                      void *context);
+
+/**
+ * @brief Run a transfer and wait for it in EM1
+ * Thread context only (not from interrupts or sleeptimer callbacks)
+ *
+ * @param seq Transfer sequence
+ * @param timeout_ms Deadline after which the transfer is aborted
+ * @return Transfer result
+ */
+I2cBusStatus_t i2c_bus_transfer_blocking(I2C_TransferSeq_TypeDef *seq,
+                                         uint32_t timeout_ms);
+
+/**
+ * @brief Check if a transfer is in progress
+ * @return true while the engine owns the bus
+ */
+bool i2c_bus_is_busy(void);
+
+/**
+ * @brief Gate I2C0 between transfers
+ * Disables the I2C0 clock. With @p park_pins the SDA/SCL pins are also
+ * disabled (no pull-up), which is required when the sensor VDD is switched
+ * off so the pins do not back-power it. The next i2c_bus_transfer()
+ * resumes the bus automatically.
+ *
+ * @param park_pins true to disconnect SDA/SCL as well
+ */
+void i2c_bus_suspend(bool park_pins);
+
+/**
+ * @brief Re-enable I2C0 after i2c_bus_suspend()
+ * Restores the clock, pins and routing. No-op if not suspended.
+ */
+void i2c_bus_resume(void);
+
+/**
+ * @brief Recover a stuck bus
+ * Clocks SCL 9 times and issues a STOP, then re-initializes I2C0
+ *
+ * @return true if both SCL and SDA are released afterwards
+ */
+bool i2c_bus_recover(void);
+
+#endif // I2C_BUS_H
@@ -0,0 +1,71 @@
+/**
+ * @file report_filter.c
+ * @brief Measured-value write suppression implementation
+ */
+
+#include "report_filter.h"
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static int32_t quantize(int32_t value, int32_t quantum);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+bool report_filter_update(ReportFilter_t *filter, int32_t value, int32_t *out)
+{
+  int32_t quantized = quantize(value, filter->quantum);
+
+  if (filter->valid) {
+    int32_t delta = quantized - filter->written;
+
+    if (delta < 0) {
+      delta = -delta;
+    }
+    // Inclusive: noise flipping the rounding by one quantum either side
+    // spans two quanta, so a hysteresis of two quanta must hold it
+    if (delta <= filter->hysteresis) {
+      filter->suppressed++;
+      return false;
+    }
+  }
+
+  filter->written = quantized;
+  filter->valid = true;
+  filter->committed++;
+  *out = quantized;
+  return true;
+}
+
+void report_filter_invalidate(ReportFilter_t *filter)
+{
+  filter->valid = false;
+}
+
+void report_filter_reset_stats(ReportFilter_t *filter)
+{
+  filter->committed = 0;
+  filter->suppressed = 0;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Round to the nearest multiple of @p quantum, halves away from zero
+ */
+static int32_t quantize(int32_t value, int32_t quantum)
+{
+  if (quantum <= 1) {
+    return value;
+  }
+
+  int32_t magnitude = (value < 0) ? -value : value;
+  int32_t rounded = ((magnitude + quantum / 2) / quantum) * quantum;
+
+  return (value < 0) ? -rounded : rounded;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file report_filter.h
+ * @brief Measured-value write suppression with quantization and hysteresis
+ *
+ * Each filter guards one attribute. A new sample is rounded to the
+ * attribute's quantum and written only if it differs from the last written
+ * value by more than the hysteresis, so conversion noise in the last digits
+ * neither rewrites the attribute nor retriggers the reporting plugin's
+ * reportable-change check. The written value stays within hysteresis plus
+ * half a quantum of the true one.
+ */
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef struct {
+  int32_t quantum;              // Written values are multiples of this (>= 1)
+  int32_t hysteresis;           // Largest move from the last written value skipped
+  int32_t written;              // Last written value
+  bool valid;                   // written holds a value from this filter
+  uint32_t committed;           // Samples written
+  uint32_t suppressed;          // Samples skipped as unchanged
+} ReportFilter_t;
+
+#define REPORT_FILTER_INIT(quantum, hysteresis) \
+  { (quantum), (hysteresis), 0, false, 0, 0 }
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Decide whether a sample should be written
+ * The first sample after init or report_filter_invalidate() is always
+ * written.
+ * @param filter Filter for the attribute
+ * @param value Sample in attribute units
+ * @param[out] out Quantized value to write; set only when returning true
+ * @return true to write @p out, false to skip the write
+ */
+bool report_filter_update(ReportFilter_t *filter, int32_t value, int32_t *out);
+
+/**
+ * @brief Forget the last written value
+ * Call when something else wrote the attribute (e.g. an invalid
+ * measurement), so the next sample is written whatever its value.
+ * @param filter Filter for the attribute
+ */
+void report_filter_invalidate(ReportFilter_t *filter);
+
+/**
+ * @brief Clear the committed and suppressed counters
+ * @param filter Filter for the attribute
+ */
+void report_filter_reset_stats(ReportFilter_t *filter);
+
+#endif // REPORT_FILTER_H
@@ -0,0 +1,158 @@
+/**
+ * @file sensor_power.c
+ * @brief Sensor bus power gating implementation
+ *
+ * Between samples I2C0 is unclocked; with VDD gating the pins are parked
+ * high-Z as well so the unpowered sensor is not fed through them.
+ */
+
+#include "sensor_power.h"
+#include "app.h"
+#include "i2c_bus.h"
+#include "em_gpio.h"
+#include "sl_sleeptimer.h"
+
+//==============================================================================
+// Private Types
+//==============================================================================
+
+typedef enum {
+  SENSOR_POWER_OFF,
+  SENSOR_POWER_STARTING,
+  SENSOR_POWER_ON
+} SensorPowerState_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static SensorPowerState_t powerState = SENSOR_POWER_OFF;
+static sensor_power_ready_callback_t readyCallback = NULL;
+static sl_sleeptimer_timer_handle_t powerUpTimer;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void vdd_set(bool on);
+static void power_up_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void sensor_power_init(void)
+{
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+  GPIO_PinModeSet(SENSOR_POWER_VDD_PORT, SENSOR_POWER_VDD_PIN, gpioModePushPull, 0);
+#endif
+
+  sensor_power_up_blocking();
+}
+
+void sensor_power_request(sensor_power_ready_callback_t ready)
+{
+  if (powerState == SENSOR_POWER_ON) {
+    ready();
+    return;
+  }
+
+  readyCallback = ready;
+
+  if (powerState == SENSOR_POWER_STARTING) {
+    // Already waiting for the supply; the timer will deliver
+    return;
+  }
+
+  vdd_set(true);
+  powerState = SENSOR_POWER_STARTING;
+
+  // Sleep through the sensor power-up time instead of spinning
+  sl_sleeptimer_start_timer_ms(&powerUpTimer,
+                               SENSOR_POWER_UP_DELAY_MS,
+                               power_up_timer_callback,
+                               NULL,
+                               0,
+                               0);
+}
+
+void sensor_power_up_blocking(void)
+{
+  if (powerState == SENSOR_POWER_ON) {
+    return;
+  }
+
+  sl_sleeptimer_stop_timer(&powerUpTimer);
+  vdd_set(true);
+  sl_sleeptimer_delay_millisecond(SENSOR_POWER_UP_DELAY_MS);
+  powerState = SENSOR_POWER_ON;
+
+  // A request that was waiting on the timer is satisfied now
+  if (readyCallback != NULL) {
+    sensor_power_ready_callback_t callback = readyCallback;
+    readyCallback = NULL;
+    callback();
+  }
+}
+
+void sensor_power_release(bool keep_vdd)
+{
+#if SENSOR_POWER_GATING_ENABLED
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+  if (!keep_vdd) {
+    // Park the pins before cutting VDD so nothing back-feeds the sensor
+    i2c_bus_suspend(true);
+    vdd_set(false);
+    powerState = SENSOR_POWER_OFF;
+    return;
+  }
+#else
+  (void)keep_vdd;
+#endif
+  i2c_bus_suspend(false);
+#else
+  (void)keep_vdd;
+#endif
+}
+
+bool sensor_power_is_ready(void)
+{
+  return (powerState == SENSOR_POWER_ON);
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Drive the sensor supply GPIO
+ */
+static void vdd_set(bool on)
+{
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+  if (on) {
+    GPIO_PinOutSet(SENSOR_POWER_VDD_PORT, SENSOR_POWER_VDD_PIN);
+  } else {
+    GPIO_PinOutClear(SENSOR_POWER_VDD_PORT, SENSOR_POWER_VDD_PIN);
+  }
+#else
+  (void)on;
+#endif
+}
+
+/**
+ * @brief Sensor power-up time elapsed
+ */
+static void power_up_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  powerState = SENSOR_POWER_ON;
+
+  if (readyCallback != NULL) {
+    sensor_power_ready_callback_t callback = readyCallback;
+    readyCallback = NULL;
+    callback();
+  }
+}
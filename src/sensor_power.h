@@ -0,0 +1,78 @@
+/**
+ * @file sensor_power.h
+ * @brief Sensor bus power gating between measurements
+ *
+ * Gates the I2C0 clock and, optionally, the SHT31 supply from a GPIO
+ * between samples, and restores both just in time for the next one.
+ */
+
+#ifndef SENSOR_POWER_H
+#define SENSOR_POWER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Gate I2C0 (clock off) between samples
+#define SENSOR_POWER_GATING_ENABLED     1
+
+// Switch the SHT31 VDD from a GPIO (board must supply the sensor from it)
+#define SENSOR_POWER_VDD_GPIO_ENABLED   0
+#define SENSOR_POWER_VDD_PORT           gpioPortD
+#define SENSOR_POWER_VDD_PIN            15      // PD15
+
+// SHT31 power-up time is 1 ms max; one extra ms covers sleeptimer rounding
+#define SENSOR_POWER_UP_DELAY_MS        2
+
+//==============================================================================
+// Types
+//==============================================================================
+
+/**
+ * @brief Sensor ready callback
+ * Called once the sensor supply is stable (sleeptimer context, or directly
+ * from sensor_power_request() when already powered).
+ */
+typedef void (*sensor_power_ready_callback_t)(void);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Initialize the supply GPIO and power the sensor (blocking)
+ */
+void sensor_power_init(void);
+
+/**
+ * @brief Power the sensor for a measurement (non-blocking)
+ * If the supply was switched off, @p ready runs after the power-up time;
+ * the device can sleep in EM2 meanwhile.
+ *
+ * @param ready Called when the sensor is usable
+ */
+void sensor_power_request(sensor_power_ready_callback_t ready);
+
+/**
+ * @brief Power the sensor and wait for it (blocking)
+ * For infrequent configuration paths (mode changes, reset).
+ */
+void sensor_power_up_blocking(void);
+
+/**
+ * @brief Gate the bus (and supply) after a measurement
+ * @param keep_vdd true if the sensor must stay powered (periodic or ALERT
+ *        mode); only the I2C0 clock is gated then
+ */
+void sensor_power_release(bool keep_vdd);
+
+/**
+ * @brief Check if the sensor supply is on and settled
+ * @return true if a transfer can start right away
+ */
+bool sensor_power_is_ready(void);
+
+#endif // SENSOR_POWER_H
@@ -2,32 +2,137 @@
  * @file sht31.c
  * @brief SHT31 sensor driver implementation
  *
- * Implements I2C communication with SHT31 sensor and fallback mode
+ * Implements I2C communication with SHT31 sensor. A sensor that stops
+ * responding is re-probed with exponential backoff from the sample path.
  */
 
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_SHT31
+
 #include "sht31.h"
 #include "app.h"
-#include "em_i2c.h"
-#include "em_cmu.h"
+#include "i2c_bus.h"
+#include "sensor_power.h"
+#include "wake_trace.h"
 #include "em_gpio.h"
+#include "gpiointerrupt.h"
 #include "sl_sleeptimer.h"
-#include <math.h>
+
 
 //==============================================================================
 // Private Variables
 //==============================================================================
 
 static bool sensorPresent = false;
-static uint32_t fallbackReadCount = 0;
+
+// Recovery: re-probe with backoff while the sensor does not respond
+static Sht31Health_t sensorHealth = SHT31_HEALTH_NOT_RESPONDING;
+static uint32_t reprobeIntervalMs = SHT31_REPROBE_MIN_MS;
+static uint32_t lastProbeTick = 0;
+
+// Acquisition mode
+static Sht31Mode_t sensorMode = SHT31_DEFAULT_MODE;
+static Sht31Rate_t sensorRate = SHT31_DEFAULT_RATE;
+
+// Periodic acquisition commands (high repeatability), indexed by Sht31Rate_t
+static const uint8_t periodicCommands[SHT31_RATE_COUNT][2] = {
+  { 0x20, 0x32 },   // 0.5 mps
+  { 0x21, 0x30 },   // 1 mps
+  { 0x22, 0x36 },   // 2 mps
+  { 0x23, 0x34 },   // 4 mps
+  { 0x27, 0x37 }    // 10 mps
+};
+
+// Time between periodic results, indexed by Sht31Rate_t
+static const uint16_t periodicIntervalMs[SHT31_RATE_COUNT] = {
+  2000, 1000, 500, 250, 100
+};
+
+// Periodic mode: last fetch that returned a result, or the start of
+// acquisition
+static uint32_t lastResultTick = 0;
+
+// Single-shot commands and conversion waits, indexed by Sht31Repeatability_t
+static const uint8_t singleShotLsb[SHT31_REPEATABILITY_COUNT] = {
+  SHT31_CMD_READ_LOW_LSB,
+  SHT31_CMD_READ_MEDIUM_LSB,
+  SHT31_CMD_READ_LSB
+};
+static const uint8_t singleShotDelayMs[SHT31_REPEATABILITY_COUNT] = {
+  SHT31_MEASURE_DELAY_LOW_MS,
+  SHT31_MEASURE_DELAY_MEDIUM_MS,
+  SHT31_MEASURE_DELAY_MS
+};
+
+// Adaptive repeatability policy
+static bool adaptiveEnabled = SHT31_ADAPTIVE_DEFAULT_ENABLED;
+static uint16_t adaptiveTempMargin = SHT31_ADAPTIVE_TEMP_MARGIN_CENTI;
+static uint16_t adaptiveHumMargin = SHT31_ADAPTIVE_HUM_MARGIN_CENTI;
+static bool referenceValid = false;
+static int16_t referenceTemperature = 0;
+static uint16_t referenceHumidity = 0;
+static Sht31Stats_t sensorStats = { 0 };
+
+// Non-blocking measurement state
+static sl_sleeptimer_timer_handle_t measureTimer;
+static sht31_measurement_callback_t measureCallback = NULL;
+static bool measureBusy = false;
+static Sht31Repeatability_t measureRepeatability = SHT31_REPEATABILITY_HIGH;
+
+// Transfer buffers for the interrupt-driven path (must outlive the call)
+static I2C_TransferSeq_TypeDef measureSeq;
+static uint8_t measureCmd[2];
+static uint8_t measureData[6];
+
+// ALERT mode: Break, 4 limit writes, restart periodic - one frame each
+#define ALERT_FRAME_COUNT   6
+#define ALERT_FRAME_MAX     5           // Command + 16-bit limit + CRC
+
+static bool alertEnabled = false;
+static sht31_alert_callback_t alertCallback = NULL;
+static bool alertBusy = false;
+static uint8_t alertStep = 0;
+static uint8_t alertFrames[ALERT_FRAME_COUNT][ALERT_FRAME_MAX];
+static uint8_t alertFrameLen[ALERT_FRAME_COUNT];
+static I2C_TransferSeq_TypeDef alertSeq;
+static sl_sleeptimer_timer_handle_t alertTimer;
 
 //==============================================================================
 // Forward Declarations
 //==============================================================================
 
+static bool read_blocking(int16_t *temperature_centi, uint16_t *humidity_centi);
+static bool reset_blocking(void);
+static bool begin_measurement(void);
+static void power_ready_callback(void);
+static void release_sensor(void);
 static bool i2c_write_command(uint8_t cmd_msb, uint8_t cmd_lsb);
-static bool i2c_read_data(uint8_t *data, uint8_t len);
+static I2cBusStatus_t i2c_read_data(uint8_t *data, uint8_t len);
+static bool start_periodic_mode(Sht31Rate_t rate);
+static bool start_single_shot(Sht31Repeatability_t repeatability);
+static bool needs_escalation(int16_t temperature_centi, uint16_t humidity_centi);
 static uint8_t calculate_crc(const uint8_t *data, uint8_t len);
-static void generate_fallback_values(float *temperature_c, float *humidity_rh);
+static bool parse_measurement(const uint8_t *data, int16_t *temperature_centi, uint16_t *humidity_centi);
+static void finish_measurement(bool success, int16_t temperature_centi, uint16_t humidity_centi);
+static void fail_measurement(void);
+static void drop_measurement(void);
+static void mark_not_responding(void);
+static bool reprobe_due(void);
+static bool fetch_overdue(void);
+static bool start_probe(void);
+static void probe_done_callback(I2cBusStatus_t status, void *context);
+static void probe_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void restart_done_callback(I2cBusStatus_t status, void *context);
+static void command_done_callback(I2cBusStatus_t status, void *context);
+static void measure_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void read_done_callback(I2cBusStatus_t status, void *context);
+static uint16_t encode_alert_limit(int32_t temperature_centi, int32_t humidity_centi,
+                                   bool round_up);
+static void set_alert_frame(uint8_t index, uint8_t cmd_lsb, uint16_t limit);
+static void alert_send_step(void);
+static void alert_write_callback(I2cBusStatus_t status, void *context);
+static void alert_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void alert_gpio_callback(uint8_t intNo);
 static void delay_ms(uint32_t ms);
 
 //==============================================================================
@@ -38,102 +143,265 @@ bool sht31_init(void)
 {
   APP_LOG("Initializing SHT31 sensor...");
 
-  // Enable clocks
-  CMU_ClockEnable(cmuClock_GPIO, true);
-  CMU_ClockEnable(cmuClock_I2C0, true);
+  // Bring up the shared I2C0 engine (clocks, pins, IRQ)
+  i2c_bus_init();
 
-  // Configure GPIO pins for I2C
-  GPIO_PinModeSet(SHT31_SDA_PORT, SHT31_SDA_PIN, gpioModeWiredAndPullUpFilter, 1);
-  GPIO_PinModeSet(SHT31_SCL_PORT, SHT31_SCL_PIN, gpioModeWiredAndPullUpFilter, 1);
+  // Power the sensor and wait out its power-up time
+  sensor_power_init();
 
-  // Initialize I2C
-  I2C_Init_TypeDef i2cInit = I2C_INIT_DEFAULT;
-  i2cInit.freq = I2C_FREQ_STANDARD_MAX;  // 100 kHz
-  i2cInit.clhr = i2cClockHLRStandard;
-
-  // Route I2C pins
-  I2C0->ROUTEPEN = I2C_ROUTEPEN_SDAPEN | I2C_ROUTEPEN_SCLPEN;
-  I2C0->ROUTELOC0 = (SHT31_SDA_LOC) | (SHT31_SCL_LOC);
-
-  I2C_Init(I2C0, &i2cInit);
-
-  // Small delay for sensor power-up
-  delay_ms(10);
-
-  // Try to reset sensor to check if present
+  // Try to reset sensor to check if present (gates the bus afterwards)
   sensorPresent = sht31_reset();
 
   if (sensorPresent) {
+    sensorHealth = SHT31_HEALTH_OK;
     APP_LOG("SHT31 sensor detected at address 0x%02X", SHT31_I2C_ADDR);
   } else {
-    APP_LOG("SHT31 sensor NOT detected - using fallback mode");
+    mark_not_responding();
+    APP_LOG("SHT31 sensor NOT detected - re-probing in %lu ms", reprobeIntervalMs);
   }
 
   return sensorPresent;
 }
 
-bool sht31_read(float *temperature_c, float *humidity_rh)
+bool sht31_read(int16_t *temperature_centi, uint16_t *humidity_centi)
 {
   if (!sensorPresent) {
-    // Use fallback values
-    generate_fallback_values(temperature_c, humidity_rh);
+    *temperature_centi = SHT31_INVALID_TEMPERATURE;
+    *humidity_centi = SHT31_INVALID_HUMIDITY;
     return false;
   }
 
-  // Send measurement command (high repeatability)
-  if (!i2c_write_command(SHT31_CMD_READ_MSB, SHT31_CMD_READ_LSB)) {
-    APP_ERROR("Failed to send measurement command");
-    sensorPresent = false;
-    generate_fallback_values(temperature_c, humidity_rh);
+  WAKE_TRACE_BEGIN(WAKE_PHASE_BLOCKING_READ);
+  sensor_power_up_blocking();
+  bool result = read_blocking(temperature_centi, humidity_centi);
+  release_sensor();
+  WAKE_TRACE_END(WAKE_PHASE_BLOCKING_READ);
+
+  return result;
+}
+
+bool sht31_start_measurement(sht31_measurement_callback_t callback)
+{
+  if (measureBusy || alertBusy) {
     return false;
   }
 
-  // Wait for measurement to complete
-  delay_ms(SHT31_MEASURE_DELAY_MS);
+  if (!sensorPresent && !reprobe_due()) {
+    // Between probes the bus is left alone - report invalid right away
+    callback(false, SHT31_INVALID_TEMPERATURE, SHT31_INVALID_HUMIDITY);
+    return true;
+  }
 
-  // Read 6 bytes: temp_msb, temp_lsb, temp_crc, hum_msb, hum_lsb, hum_crc
-  uint8_t data[6];
-  if (!i2c_read_data(data, 6)) {
-    APP_ERROR("Failed to read measurement data");
-    sensorPresent = false;
-    generate_fallback_values(temperature_c, humidity_rh);
+  measureBusy = true;
+  measureCallback = callback;
+
+  if (!sensor_power_is_ready()) {
+    // Supply was gated - start once the sensor has powered up
+    sensor_power_request(power_ready_callback);
+    return true;
+  }
+
+  if (!begin_measurement()) {
+    // Bus owned by another transfer - try again on the next sample
+    measureBusy = false;
+    measureCallback = NULL;
     return false;
   }
 
-  // Verify CRC for temperature
-  uint8_t temp_crc = calculate_crc(&data[0], 2);
-  if (temp_crc != data[2]) {
-    APP_ERROR("Temperature CRC mismatch: expected 0x%02X, got 0x%02X", temp_crc, data[2]);
-    generate_fallback_values(temperature_c, humidity_rh);
+  return true;
+}
+
+bool sht31_set_mode(Sht31Mode_t mode, Sht31Rate_t rate)
+{
+  if (rate >= SHT31_RATE_COUNT || measureBusy || alertBusy) {
     return false;
   }
 
-  // Verify CRC for humidity
-  uint8_t hum_crc = calculate_crc(&data[3], 2);
-  if (hum_crc != data[5]) {
-    APP_ERROR("Humidity CRC mismatch: expected 0x%02X, got 0x%02X", hum_crc, data[5]);
-    generate_fallback_values(temperature_c, humidity_rh);
+  // ALERT only works while the sensor acquires periodically
+  if (alertEnabled && mode != SHT31_MODE_PERIODIC) {
     return false;
   }
 
-  // Convert temperature (formula from datasheet)
-  uint16_t temp_raw = (data[0] << 8) | data[1];
-  *temperature_c = -45.0f + (175.0f * temp_raw / 65535.0f);
+  if (!sensorPresent) {
+    // Remember the choice; it is applied when the sensor is probed again
+    sensorMode = mode;
+    sensorRate = rate;
+    return true;
+  }
 
-  // Convert humidity (formula from datasheet)
-  uint16_t hum_raw = (data[3] << 8) | data[4];
-  *humidity_rh = 100.0f * hum_raw / 65535.0f;
+  sensor_power_up_blocking();
+
+  // Periodic mode only accepts Fetch Data and Break
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    if (!i2c_write_command(SHT31_CMD_BREAK_MSB, SHT31_CMD_BREAK_LSB)) {
+      APP_ERROR("Failed to stop periodic mode");
+      release_sensor();
+      return false;
+    }
+    delay_ms(SHT31_COMMAND_DELAY_MS);
+    sensorMode = SHT31_MODE_SINGLE_SHOT;
+  }
 
-  // Clamp humidity to valid range
-  if (*humidity_rh < 0.0f) *humidity_rh = 0.0f;
-  if (*humidity_rh > 100.0f) *humidity_rh = 100.0f;
+  if (mode == SHT31_MODE_PERIODIC) {
+    if (!start_periodic_mode(rate)) {
+      APP_ERROR("Failed to start periodic mode");
+      release_sensor();
+      return false;
+    }
+  }
 
+  sensorMode = mode;
+  sensorRate = rate;
+
+  // Single-shot may drop the supply; periodic keeps it and gates the clock
+  release_sensor();
+  return true;
+}
+
+void sht31_set_adaptive(bool enable,
+                        uint16_t temp_margin_centi,
+                        uint16_t hum_margin_centi)
+{
+  adaptiveEnabled = enable;
+  adaptiveTempMargin = temp_margin_centi;
+  adaptiveHumMargin = hum_margin_centi;
+}
+
+bool sht31_get_adaptive(uint16_t *temp_margin_centi, uint16_t *hum_margin_centi)
+{
+  *temp_margin_centi = adaptiveTempMargin;
+  *hum_margin_centi = adaptiveHumMargin;
+  return adaptiveEnabled;
+}
+
+void sht31_get_stats(Sht31Stats_t *stats)
+{
+  *stats = sensorStats;
+}
+
+void sht31_reset_stats(void)
+{
+  sensorStats.lowSamples = 0;
+  sensorStats.highSamples = 0;
+  sensorStats.conversionMs = 0;
+}
+
+Sht31Mode_t sht31_get_mode(void)
+{
+  return sensorMode;
+}
+
+Sht31Rate_t sht31_get_rate(void)
+{
+  return sensorRate;
+}
+
+bool sht31_alert_enable(Sht31Rate_t rate, sht31_alert_callback_t callback)
+{
+  if (!sht31_set_mode(SHT31_MODE_PERIODIC, rate)) {
+    return false;
+  }
+
+  alertCallback = callback;
+  alertEnabled = true;
+
+  // ALERT is push-pull from the sensor; no pull needed
+  GPIO_PinModeSet(SHT31_ALERT_PORT, SHT31_ALERT_PIN, gpioModeInput, 0);
+  GPIOINT_CallbackRegister(SHT31_ALERT_PIN, alert_gpio_callback);
+  GPIO_ExtIntConfig(SHT31_ALERT_PORT, SHT31_ALERT_PIN, SHT31_ALERT_PIN,
+                    true, false, true);
+
+  APP_LOG("SHT31 alert mode enabled on port %c pin %d",
+          'A' + SHT31_ALERT_PORT, SHT31_ALERT_PIN);
+  return true;
+}
+
+bool sht31_alert_disable(void)
+{
+  if (!alertEnabled) {
+    return true;
+  }
+
+  // A measurement or limit update owns the sensor; leave ALERT as it is
+  if (measureBusy || alertBusy) {
+    return false;
+  }
+
+  // set_mode() refuses single-shot while ALERT is enabled
+  alertEnabled = false;
+  if (!sht31_set_mode(SHT31_MODE_SINGLE_SHOT, sensorRate)) {
+    alertEnabled = true;
+    return false;
+  }
+
+  GPIO_ExtIntConfig(SHT31_ALERT_PORT, SHT31_ALERT_PIN, SHT31_ALERT_PIN,
+                    true, false, false);
+  GPIOINT_CallbackUnRegister(SHT31_ALERT_PIN);
+  GPIO_PinModeSet(SHT31_ALERT_PORT, SHT31_ALERT_PIN, gpioModeDisabled, 0);
+  alertCallback = NULL;
+
+  APP_LOG("SHT31 alert mode disabled");
   return true;
 }
 
+bool sht31_alert_is_enabled(void)
+{
+  return alertEnabled;
+}
+
+bool sht31_set_alert_window(int16_t temperature_centi, uint16_t humidity_centi)
+{
+  if (!alertEnabled || !sensorPresent || alertBusy || measureBusy) {
+    return false;
+  }
+
+  int32_t t = temperature_centi;
+  int32_t h = humidity_centi;
+
+  // Break first: limits are written with periodic acquisition stopped
+  alertFrames[0][0] = SHT31_CMD_BREAK_MSB;
+  alertFrames[0][1] = SHT31_CMD_BREAK_LSB;
+  alertFrameLen[0] = 2;
+
+  // Limits round away from the value: no move inside the margin asserts
+  // ALERT, and the clear limits never meet around the re-centred value
+  set_alert_frame(1, SHT31_CMD_ALERT_HIGH_SET_LSB,
+                  encode_alert_limit(t + SHT31_ALERT_TEMP_MARGIN_CENTI,
+                                     h + SHT31_ALERT_HUM_MARGIN_CENTI, true));
+  set_alert_frame(2, SHT31_CMD_ALERT_HIGH_CLEAR_LSB,
+                  encode_alert_limit(t + SHT31_ALERT_TEMP_MARGIN_CENTI / 2,
+                                     h + SHT31_ALERT_HUM_MARGIN_CENTI / 2, true));
+  set_alert_frame(3, SHT31_CMD_ALERT_LOW_CLEAR_LSB,
+                  encode_alert_limit(t - SHT31_ALERT_TEMP_MARGIN_CENTI / 2,
+                                     h - SHT31_ALERT_HUM_MARGIN_CENTI / 2, false));
+  set_alert_frame(4, SHT31_CMD_ALERT_LOW_SET_LSB,
+                  encode_alert_limit(t - SHT31_ALERT_TEMP_MARGIN_CENTI,
+                                     h - SHT31_ALERT_HUM_MARGIN_CENTI, false));
+
+  // Resume periodic acquisition
+  alertFrames[5][0] = periodicCommands[sensorRate][0];
+  alertFrames[5][1] = periodicCommands[sensorRate][1];
+  alertFrameLen[5] = 2;
+
+  alertBusy = true;
+  alertStep = 0;
+  alert_send_step();
+
+  return true;
+}
+
+bool sht31_is_busy(void)
+{
+  return measureBusy || alertBusy;
+}
+
 bool sht31_reset(void)
 {
-  return i2c_write_command(SHT31_CMD_SOFT_RESET_MSB, SHT31_CMD_SOFT_RESET_LSB);
+  sensor_power_up_blocking();
+  bool result = reset_blocking();
+  release_sensor();
+
+  return result;
 }
 
 bool sht31_is_present(void)
@@ -141,12 +409,175 @@ bool sht31_is_present(void)
   return sensorPresent;
 }
 
+Sht31Health_t sht31_get_health(void)
+{
+  return sensorHealth;
+}
+
+uint32_t sht31_get_reprobe_interval_ms(void)
+{
+  return reprobeIntervalMs;
+}
+
+int16_t sht31_raw_to_centi_celsius(uint16_t raw)
+{
+  // T = -45 + 175 * raw / 65535 [°C]; 17500 * 65535 still fits in 32 bits.
+  // 65535 is odd, so adding half the divisor rounds to nearest with no ties.
+  uint32_t scaled = ((uint32_t)raw * 17500u + 32767u) / 65535u;
+  return (int16_t)((int32_t)scaled - 4500);
+}
+
+uint16_t sht31_raw_to_centi_rh(uint16_t raw)
+{
+  // RH = 100 * raw / 65535 [%]; never exceeds 10000, so no clamp is needed
+  return (uint16_t)(((uint32_t)raw * 10000u + 32767u) / 65535u);
+}
+
 //==============================================================================
 // Private Functions
 //==============================================================================
 
 /**
- * @brief Write 2-byte command to SHT31
+ * @brief Blocking measurement; caller powers the sensor
+ */
+static bool read_blocking(int16_t *temperature_centi, uint16_t *humidity_centi)
+{
+  *temperature_centi = SHT31_INVALID_TEMPERATURE;
+  *humidity_centi = SHT31_INVALID_HUMIDITY;
+
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    // Latest periodic result is ready to fetch
+    if (!i2c_write_command(SHT31_CMD_FETCH_MSB, SHT31_CMD_FETCH_LSB)) {
+      APP_ERROR("Failed to send fetch command");
+      mark_not_responding();
+      return false;
+    }
+  } else {
+    // Send measurement command (high repeatability)
+    if (!i2c_write_command(SHT31_CMD_READ_MSB, SHT31_CMD_READ_LSB)) {
+      APP_ERROR("Failed to send measurement command");
+      mark_not_responding();
+      return false;
+    }
+
+    // Wait for measurement to complete
+    delay_ms(SHT31_MEASURE_DELAY_MS);
+  }
+
+  // Read 6 bytes: temp_msb, temp_lsb, temp_crc, hum_msb, hum_lsb, hum_crc
+  uint8_t data[6];
+  I2cBusStatus_t status = i2c_read_data(data, 6);
+
+  if (status == I2C_BUS_NACK && sensorMode == SHT31_MODE_PERIODIC && !fetch_overdue()) {
+    // No new result since the last fetch - the sensor itself is fine
+    APP_DEBUG("SHT31 fetch: no new data");
+    return false;
+  }
+
+  if (status != I2C_BUS_OK) {
+    APP_ERROR("Failed to read measurement data");
+    mark_not_responding();
+    return false;
+  }
+
+  lastResultTick = sl_sleeptimer_get_tick_count();
+
+  if (!parse_measurement(data, temperature_centi, humidity_centi)) {
+    sensorHealth = SHT31_HEALTH_DATA_ERROR;
+    return false;
+  }
+
+  sensorHealth = SHT31_HEALTH_OK;
+  return true;
+}
+
+/**
+ * @brief Soft reset; caller powers the sensor
+ */
+static bool reset_blocking(void)
+{
+  // Soft reset is not accepted while periodic acquisition is running
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    i2c_write_command(SHT31_CMD_BREAK_MSB, SHT31_CMD_BREAK_LSB);
+    delay_ms(SHT31_COMMAND_DELAY_MS);
+  }
+
+  if (!i2c_write_command(SHT31_CMD_SOFT_RESET_MSB, SHT31_CMD_SOFT_RESET_LSB)) {
+    return false;
+  }
+
+  // The sensor NACKs every command until the reset is done
+  delay_ms(SHT31_COMMAND_DELAY_MS);
+
+  // Reset returns the sensor to single-shot idle; restore periodic mode
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    return start_periodic_mode(sensorRate);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Start the transfer for a measurement (sensor powered, slot taken)
+ */
+static bool begin_measurement(void)
+{
+  if (!sensorPresent) {
+    // Re-probe due - the measurement continues once the sensor ACKs
+    return start_probe();
+  }
+
+  measureSeq.addr = SHT31_I2C_ADDR << 1;
+  measureSeq.buf[0].data = measureCmd;
+  measureSeq.buf[0].len = 2;
+
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    // Fetch Data + read-back in one repeated-start transaction
+    measureCmd[0] = SHT31_CMD_FETCH_MSB;
+    measureCmd[1] = SHT31_CMD_FETCH_LSB;
+    measureSeq.flags = I2C_FLAG_WRITE_READ;
+    measureSeq.buf[1].data = measureData;
+    measureSeq.buf[1].len = sizeof(measureData);
+    WAKE_TRACE_BEGIN(WAKE_PHASE_I2C_READ);
+    return i2c_bus_transfer(&measureSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                            read_done_callback, NULL);
+  }
+
+  // Cheap sample first when adaptive; escalated later only if it moved
+  return start_single_shot(adaptiveEnabled ? SHT31_REPEATABILITY_LOW
+                                           : SHT31_REPEATABILITY_HIGH);
+}
+
+/**
+ * @brief Sensor supply settled - start the deferred measurement
+ */
+static void power_ready_callback(void)
+{
+  if (!measureBusy) {
+    return;
+  }
+
+  if (!begin_measurement()) {
+    APP_ERROR("I2C bus busy - measurement dropped");
+    drop_measurement();
+  }
+}
+
+/**
+ * @brief Gate the sensor bus once no transfer sequence is pending
+ * Periodic and ALERT modes need the sensor powered; only I2C0 is gated then.
+ */
+static void release_sensor(void)
+{
+  if (measureBusy || alertBusy) {
+    return;
+  }
+
+  sensor_power_release(sensorMode == SHT31_MODE_PERIODIC || alertEnabled);
+}
+
+/**
+ * @brief Write 2-byte command to SHT31 (blocking, waits in EM1)
  */
 static bool i2c_write_command(uint8_t cmd_msb, uint8_t cmd_lsb)
 {
@@ -158,19 +589,14 @@ static bool i2c_write_command(uint8_t cmd_msb, uint8_t cmd_lsb)
   seq.buf[0].data = cmd;
   seq.buf[0].len = 2;
 
-  I2C_TransferReturn_TypeDef ret = I2C_TransferInit(I2C0, &seq);
-
-  while (ret == i2cTransferInProgress) {
-    ret = I2C_Transfer(I2C0);
-  }
-
-  return (ret == i2cTransferDone);
+  return (i2c_bus_transfer_blocking(&seq, I2C_BUS_DEFAULT_TIMEOUT_MS) == I2C_BUS_OK);
 }
 
 /**
- * @brief Read data from SHT31
+ * @brief Read data from SHT31 (blocking, waits in EM1)
+ * @return Bus status; in periodic mode a NACK can mean no new result yet
  */
-static bool i2c_read_data(uint8_t *data, uint8_t len)
+static I2cBusStatus_t i2c_read_data(uint8_t *data, uint8_t len)
 {
   I2C_TransferSeq_TypeDef seq;
 
@@ -179,13 +605,358 @@ static bool i2c_read_data(uint8_t *data, uint8_t len)
   seq.buf[0].data = data;
   seq.buf[0].len = len;
 
-  I2C_TransferReturn_TypeDef ret = I2C_TransferInit(I2C0, &seq);
+  return i2c_bus_transfer_blocking(&seq, I2C_BUS_DEFAULT_TIMEOUT_MS);
+}
 
-  while (ret == i2cTransferInProgress) {
-    ret = I2C_Transfer(I2C0);
+/**
+ * @brief Enter periodic acquisition at the given rate (blocking)
+ */
+static bool start_periodic_mode(Sht31Rate_t rate)
+{
+  // First result is one period away; fetches before then are NACKed
+  lastResultTick = sl_sleeptimer_get_tick_count();
+  return i2c_write_command(periodicCommands[rate][0], periodicCommands[rate][1]);
+}
+
+/**
+ * @brief Send a single-shot measurement command (interrupt-driven)
+ */
+static bool start_single_shot(Sht31Repeatability_t repeatability)
+{
+  measureRepeatability = repeatability;
+
+  measureCmd[0] = SHT31_CMD_READ_MSB;
+  measureCmd[1] = singleShotLsb[repeatability];
+  measureSeq.addr = SHT31_I2C_ADDR << 1;
+  measureSeq.flags = I2C_FLAG_WRITE;
+  measureSeq.buf[0].data = measureCmd;
+  measureSeq.buf[0].len = 2;
+
+  WAKE_TRACE_BEGIN(WAKE_PHASE_SENSOR_COMMAND);
+  return i2c_bus_transfer(&measureSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                          command_done_callback, NULL);
+}
+
+/**
+ * @brief Check a low-repeatability sample against the last delivered value
+ */
+static bool needs_escalation(int16_t temperature_centi, uint16_t humidity_centi)
+{
+  if (!referenceValid) {
+    // No baseline yet - establish one at full precision
+    return true;
+  }
+
+  int32_t tempDelta = (int32_t)temperature_centi - referenceTemperature;
+  int32_t humDelta = (int32_t)humidity_centi - referenceHumidity;
+  if (tempDelta < 0) tempDelta = -tempDelta;
+  if (humDelta < 0) humDelta = -humDelta;
+
+  return (tempDelta > adaptiveTempMargin) || (humDelta > adaptiveHumMargin);
+}
+
+/**
+ * @brief Verify and convert a 6-byte measurement result
+ * Layout: temp_msb, temp_lsb, temp_crc, hum_msb, hum_lsb, hum_crc
+ */
+static bool parse_measurement(const uint8_t *data, int16_t *temperature_centi, uint16_t *humidity_centi)
+{
+  // Verify CRC for temperature
+  uint8_t temp_crc = calculate_crc(&data[0], 2);
+  if (temp_crc != data[2]) {
+    APP_ERROR("Temperature CRC mismatch: expected 0x%02X, got 0x%02X", temp_crc, data[2]);
+    return false;
+  }
+
+  // Verify CRC for humidity
+  uint8_t hum_crc = calculate_crc(&data[3], 2);
+  if (hum_crc != data[5]) {
+    APP_ERROR("Humidity CRC mismatch: expected 0x%02X, got 0x%02X", hum_crc, data[5]);
+    return false;
+  }
+
+  // Convert straight to ZCL units
+  uint16_t temp_raw = (data[0] << 8) | data[1];
+  *temperature_centi = sht31_raw_to_centi_celsius(temp_raw);
+
+  uint16_t hum_raw = (data[3] << 8) | data[4];
+  *humidity_centi = sht31_raw_to_centi_rh(hum_raw);
+
+  return true;
+}
+
+/**
+ * @brief Release the measurement slot and deliver the result
+ */
+static void finish_measurement(bool success, int16_t temperature_centi, uint16_t humidity_centi)
+{
+  sht31_measurement_callback_t callback = measureCallback;
+
+  measureBusy = false;
+  measureCallback = NULL;
+  release_sensor();
+
+  if (callback != NULL) {
+    callback(success, temperature_centi, humidity_centi);
+  }
+}
+
+/**
+ * @brief Deliver invalid values after a failed transfer and start re-probing
+ */
+static void fail_measurement(void)
+{
+  mark_not_responding();
+  drop_measurement();
+}
+
+/**
+ * @brief Deliver invalid values without a verdict on the sensor
+ */
+static void drop_measurement(void)
+{
+  finish_measurement(false, SHT31_INVALID_TEMPERATURE, SHT31_INVALID_HUMIDITY);
+}
+
+/**
+ * @brief Sensor stopped responding - schedule the first re-probe
+ */
+static void mark_not_responding(void)
+{
+  if (sensorPresent) {
+    APP_ERROR("SHT31 not responding - re-probing in %lu ms",
+              (unsigned long)SHT31_REPROBE_MIN_MS);
+  }
+
+  sensorPresent = false;
+  sensorHealth = SHT31_HEALTH_NOT_RESPONDING;
+  reprobeIntervalMs = SHT31_REPROBE_MIN_MS;
+  lastProbeTick = sl_sleeptimer_get_tick_count();
+}
+
+/**
+ * @brief Check if the backoff interval since the last probe has elapsed
+ */
+static bool reprobe_due(void)
+{
+  uint32_t elapsedTicks = sl_sleeptimer_get_tick_count() - lastProbeTick;
+  return sl_sleeptimer_tick_to_ms(elapsedTicks) >= reprobeIntervalMs;
+}
+
+/**
+ * @brief Periodic mode: no result for SHT31_FETCH_MISSED_PERIODS periods
+ */
+static bool fetch_overdue(void)
+{
+  uint32_t elapsedTicks = sl_sleeptimer_get_tick_count() - lastResultTick;
+  return sl_sleeptimer_tick_to_ms(elapsedTicks)
+         >= (uint32_t)SHT31_FETCH_MISSED_PERIODS * periodicIntervalMs[sensorRate];
+}
+
+/**
+ * @brief Send a soft reset to see if the sensor is back (interrupt-driven)
+ * The cost of a dead sensor is one NACKed 2-byte write per interval.
+ */
+static bool start_probe(void)
+{
+  measureCmd[0] = SHT31_CMD_SOFT_RESET_MSB;
+  measureCmd[1] = SHT31_CMD_SOFT_RESET_LSB;
+  measureSeq.addr = SHT31_I2C_ADDR << 1;
+  measureSeq.flags = I2C_FLAG_WRITE;
+  measureSeq.buf[0].data = measureCmd;
+  measureSeq.buf[0].len = 2;
+
+  return i2c_bus_transfer(&measureSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                          probe_done_callback, NULL);
+}
+
+/**
+ * @brief Probe soft reset sent
+ * On NACK the interval doubles; on ACK wait out the reset time.
+ */
+static void probe_done_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  lastProbeTick = sl_sleeptimer_get_tick_count();
+
+  if (status != I2C_BUS_OK) {
+    reprobeIntervalMs = (reprobeIntervalMs > SHT31_REPROBE_MAX_MS / 2)
+                        ? SHT31_REPROBE_MAX_MS
+                        : reprobeIntervalMs * 2;
+    APP_DEBUG("SHT31 probe failed (status %d) - next in %lu ms",
+              status, reprobeIntervalMs);
+    drop_measurement();
+    return;
+  }
+
+  sl_sleeptimer_start_timer_ms(&measureTimer,
+                               SHT31_COMMAND_DELAY_MS,
+                               probe_timer_callback,
+                               NULL,
+                               0,
+                               0);
+}
+
+/**
+ * @brief Sensor reset after a successful probe
+ * Restores the acquisition mode, then continues with the measurement.
+ */
+static void probe_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  APP_LOG("SHT31 responding again");
+  sensorPresent = true;
+  sensorHealth = SHT31_HEALTH_OK;
+  reprobeIntervalMs = SHT31_REPROBE_MIN_MS;
+  referenceValid = false;
+
+  if (sensorMode == SHT31_MODE_PERIODIC) {
+    // Reset left the sensor idle; first result is one period away
+    measureCmd[0] = periodicCommands[sensorRate][0];
+    measureCmd[1] = periodicCommands[sensorRate][1];
+    measureSeq.flags = I2C_FLAG_WRITE;
+    measureSeq.buf[0].data = measureCmd;
+    measureSeq.buf[0].len = 2;
+    if (!i2c_bus_transfer(&measureSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                          restart_done_callback, NULL)) {
+      drop_measurement();
+    }
+    return;
+  }
+
+  if (!begin_measurement()) {
+    drop_measurement();
+  }
+}
+
+/**
+ * @brief Periodic acquisition restarted after a re-probe
+ */
+static void restart_done_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  if (status != I2C_BUS_OK) {
+    APP_ERROR("Failed to restart periodic mode (status %d)", status);
+    fail_measurement();
+    return;
+  }
+
+  lastResultTick = sl_sleeptimer_get_tick_count();
+  drop_measurement();
+}
+
+/**
+ * @brief Measurement command sent
+ * Arms the conversion timer so the device can sleep in EM2 meanwhile.
+ */
+static void command_done_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  WAKE_TRACE_END(WAKE_PHASE_SENSOR_COMMAND);
+
+  if (status != I2C_BUS_OK) {
+    APP_ERROR("Failed to send measurement command (status %d)", status);
+    fail_measurement();
+    return;
+  }
+
+  sensorStats.conversionMs += singleShotDelayMs[measureRepeatability];
+
+  WAKE_TRACE_BEGIN(WAKE_PHASE_CONVERSION);
+
+  sl_sleeptimer_start_timer_ms(&measureTimer,
+                               singleShotDelayMs[measureRepeatability],
+                               measure_timer_callback,
+                               NULL,
+                               0,
+                               0);
+}
+
+/**
+ * @brief Conversion timer callback
+ * Fires once the sensor has finished converting and starts the read-back.
+ */
+static void measure_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  WAKE_TRACE_END(WAKE_PHASE_CONVERSION);
+
+  measureSeq.addr = SHT31_I2C_ADDR << 1;
+  measureSeq.flags = I2C_FLAG_READ;
+  measureSeq.buf[0].data = measureData;
+  measureSeq.buf[0].len = sizeof(measureData);
+
+  WAKE_TRACE_BEGIN(WAKE_PHASE_I2C_READ);
+  if (!i2c_bus_transfer(&measureSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                        read_done_callback, NULL)) {
+    APP_ERROR("I2C bus busy - measurement dropped");
+    drop_measurement();
+  }
+}
+
+/**
+ * @brief Measurement data read back
+ * Verifies and converts the result and hands it to the completion callback.
+ */
+static void read_done_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  int16_t temperature_centi;
+  uint16_t humidity_centi;
+
+  WAKE_TRACE_END(WAKE_PHASE_I2C_READ);
+
+  if (status == I2C_BUS_NACK && sensorMode == SHT31_MODE_PERIODIC && !fetch_overdue()) {
+    // No new result since the last fetch - the sensor itself is fine
+    APP_DEBUG("SHT31 fetch: no new data");
+    drop_measurement();
+    return;
+  }
+
+  if (status != I2C_BUS_OK) {
+    APP_ERROR("Failed to read measurement data (status %d)", status);
+    fail_measurement();
+    return;
+  }
+
+  lastResultTick = sl_sleeptimer_get_tick_count();
+
+  if (!parse_measurement(measureData, &temperature_centi, &humidity_centi)) {
+    sensorHealth = SHT31_HEALTH_DATA_ERROR;
+    drop_measurement();
+    return;
   }
 
-  return (ret == i2cTransferDone);
+  sensorHealth = SHT31_HEALTH_OK;
+
+  if (sensorMode == SHT31_MODE_SINGLE_SHOT) {
+    if (measureRepeatability == SHT31_REPEATABILITY_LOW) {
+      if (needs_escalation(temperature_centi, humidity_centi)) {
+        // Value moved - re-measure at high repeatability before reporting
+        if (start_single_shot(SHT31_REPEATABILITY_HIGH)) {
+          return;
+        }
+        // Bus busy: deliver the low-repeatability value rather than nothing
+      }
+      sensorStats.lowSamples++;
+    } else {
+      sensorStats.highSamples++;
+    }
+  }
+
+  referenceValid = true;
+  referenceTemperature = temperature_centi;
+  referenceHumidity = humidity_centi;
+
+  finish_measurement(true, temperature_centi, humidity_centi);
 }
 
 /**
@@ -212,26 +983,135 @@ static uint8_t calculate_crc(const uint8_t *data, uint8_t len)
 }
 
 /**
- * @brief Generate realistic fallback sensor values
- * Uses slow drift pattern for testing when sensor is not present
+ * @brief Encode an alert limit word
+ * Bits 15:9 hold the 7 MSBs of raw RH, bits 8:0 the 9 MSBs of raw T. The
+ * sensor compares full results against the limit with the dropped bits at
+ * zero, so the limit is rounded to a whole step in the given direction.
+ */
+static uint16_t encode_alert_limit(int32_t temperature_centi, int32_t humidity_centi,
+                                   bool round_up)
+{
+  // Clamp to the sensor range before converting back to raw ticks
+  if (temperature_centi < -4500) temperature_centi = -4500;
+  if (temperature_centi > 13000) temperature_centi = 13000;
+  if (humidity_centi < 0) humidity_centi = 0;
+  if (humidity_centi > 10000) humidity_centi = 10000;
+
+  uint32_t tScaled = (uint32_t)(temperature_centi + 4500) * 65535u;
+  uint32_t hScaled = (uint32_t)humidity_centi * 65535u;
+  uint32_t tRaw;
+  uint32_t hRaw;
+
+  if (round_up) {
+    tRaw = (tScaled + 17499u) / 17500u + 0x7Fu;
+    hRaw = (hScaled + 9999u) / 10000u + 0x1FFu;
+    // Top of the range: the highest limit the word holds
+    if (tRaw > 0xFFFFu) tRaw = 0xFFFFu;
+    if (hRaw > 0xFFFFu) hRaw = 0xFFFFu;
+  } else {
+    tRaw = tScaled / 17500u;
+    hRaw = hScaled / 10000u;
+  }
+
+  return (uint16_t)((hRaw & 0xFE00u) | (tRaw >> 7));
+}
+
+/**
+ * @brief Build a limit write frame: command, limit MSB/LSB, CRC
+ */
+static void set_alert_frame(uint8_t index, uint8_t cmd_lsb, uint16_t limit)
+{
+  alertFrames[index][0] = SHT31_CMD_ALERT_WRITE_MSB;
+  alertFrames[index][1] = cmd_lsb;
+  alertFrames[index][2] = (uint8_t)(limit >> 8);
+  alertFrames[index][3] = (uint8_t)(limit & 0xFF);
+  alertFrames[index][4] = calculate_crc(&alertFrames[index][2], 2);
+  alertFrameLen[index] = 5;
+}
+
+/**
+ * @brief Send the current alert update frame (interrupt-driven)
+ */
+static void alert_send_step(void)
+{
+  alertSeq.addr = SHT31_I2C_ADDR << 1;
+  alertSeq.flags = I2C_FLAG_WRITE;
+  alertSeq.buf[0].data = alertFrames[alertStep];
+  alertSeq.buf[0].len = alertFrameLen[alertStep];
+
+  if (!i2c_bus_transfer(&alertSeq, I2C_BUS_DEFAULT_TIMEOUT_MS,
+                        alert_write_callback, NULL)) {
+    APP_ERROR("I2C bus busy - alert window not updated");
+    alertBusy = false;
+    release_sensor();
+  }
+}
+
+/**
+ * @brief Alert update frame written
+ * Waits out the Break settle time once, then walks through the frames.
+ */
+static void alert_write_callback(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  if (status != I2C_BUS_OK) {
+    APP_ERROR("Failed to update alert window (step %d, status %d)", alertStep, status);
+    alertBusy = false;
+    release_sensor();
+    return;
+  }
+
+  alertStep++;
+
+  if (alertStep == 1) {
+    // Sensor needs ~1 ms after Break before it accepts commands
+    sl_sleeptimer_start_timer_ms(&alertTimer,
+                                 SHT31_COMMAND_DELAY_MS,
+                                 alert_timer_callback,
+                                 NULL,
+                                 0,
+                                 0);
+    return;
+  }
+
+  if (alertStep < ALERT_FRAME_COUNT) {
+    alert_send_step();
+    return;
+  }
+
+  // Last frame restarted periodic acquisition
+  lastResultTick = sl_sleeptimer_get_tick_count();
+  alertBusy = false;
+  release_sensor();
+
+  // Value may already be outside the new window; no edge would follow
+  if (GPIO_PinInGet(SHT31_ALERT_PORT, SHT31_ALERT_PIN) && alertCallback != NULL) {
+    alertCallback();
+  }
+}
+
+/**
+ * @brief Break settle time elapsed - continue with the limit writes
  */
-static void generate_fallback_values(float *temperature_c, float *humidity_rh)
+static void alert_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
 {
-  fallbackReadCount++;
+  (void)handle;
+  (void)data;
 
-  // Generate slowly drifting fake values for realistic testing
-  // Temperature: 20-25°C with slow sine wave
-  float temp_base = 22.5f;
-  float temp_variation = 2.5f * sinf(fallbackReadCount * 0.1f);
-  *temperature_c = temp_base + temp_variation;
+  alert_send_step();
+}
 
-  // Humidity: 40-60% with different phase
-  float hum_base = 50.0f;
-  float hum_variation = 10.0f * sinf(fallbackReadCount * 0.15f + 1.57f);
-  *humidity_rh = hum_base + hum_variation;
+/**
+ * @brief ALERT rising edge
+ */
+static void alert_gpio_callback(uint8_t intNo)
+{
+  (void)intNo;
 
-  APP_DEBUG("Fallback values: temp=%.2f°C, humidity=%.2f%% (count=%lu)",
-            *temperature_c, *humidity_rh, fallbackReadCount);
+  if (alertEnabled && !alertBusy && alertCallback != NULL) {
+    alertCallback();
+  }
 }
 
 /**
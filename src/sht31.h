@@ -2,7 +2,7 @@
  * @file sht31.h
  * @brief SHT31 temperature and humidity sensor driver
  *
- * I2C driver for Sensirion SHT31 sensor with fallback mode
+ * I2C driver for Sensirion SHT31 sensor with re-probe on failure
  */
 
 #ifndef SHT31_H
@@ -15,14 +15,7 @@
 // Configuration
 //==============================================================================
 
-// I2C Configuration
-#define SHT31_I2C_PORT      0           // I2C0
-#define SHT31_SDA_PORT      gpioPortC
-#define SHT31_SDA_PIN       10          // PC10 (Pin 24)
-#define SHT31_SCL_PORT      gpioPortC
-#define SHT31_SCL_PIN       11          // PC11 (Pin 25)
-#define SHT31_SDA_LOC       _I2C_ROUTELOC0_SDALOC_LOC14
-#define SHT31_SCL_LOC       _I2C_ROUTELOC0_SCLLOC_LOC14
+// I2C bus pins and timeouts are owned by the shared engine (i2c_bus.h)
 
 // SHT31 I2C Address
 #define SHT31_I2C_ADDR      0x44        // Default address (ADDR pin to GND)
@@ -30,13 +23,122 @@
 // SHT31 Commands
 #define SHT31_CMD_READ_MSB  0x24        // Measurement: high repeatability
 #define SHT31_CMD_READ_LSB  0x00
+#define SHT31_CMD_READ_MEDIUM_LSB 0x0B  // Measurement: medium repeatability
+#define SHT31_CMD_READ_LOW_LSB    0x16  // Measurement: low repeatability
 #define SHT31_CMD_SOFT_RESET_MSB 0x30
 #define SHT31_CMD_SOFT_RESET_LSB 0xA2
 #define SHT31_CMD_STATUS_MSB 0xF3
 #define SHT31_CMD_STATUS_LSB 0x2D
+#define SHT31_CMD_FETCH_MSB 0xE0        // Fetch data (periodic mode)
+#define SHT31_CMD_FETCH_LSB 0x00
+#define SHT31_CMD_BREAK_MSB 0x30        // Stop periodic acquisition
+#define SHT31_CMD_BREAK_LSB 0x93
+#define SHT31_CMD_ALERT_WRITE_MSB 0x61  // Write alert limit (+ LSB below)
+#define SHT31_CMD_ALERT_HIGH_SET_LSB   0x1D
+#define SHT31_CMD_ALERT_HIGH_CLEAR_LSB 0x16
+#define SHT31_CMD_ALERT_LOW_CLEAR_LSB  0x0B
+#define SHT31_CMD_ALERT_LOW_SET_LSB    0x00
+
+// ALERT output (active high, push-pull) - wire SHT31 pin 3 here
+#define SHT31_ALERT_PORT    gpioPortB
+#define SHT31_ALERT_PIN     14          // PB14, GPIO interrupt 14
 
 // Timing
-#define SHT31_MEASURE_DELAY_MS  20      // Measurement duration
+#define SHT31_MEASURE_DELAY_MS  20      // Measurement duration (high repeatability)
+#define SHT31_MEASURE_DELAY_MEDIUM_MS 7 // 6 ms max conversion + margin
+#define SHT31_MEASURE_DELAY_LOW_MS    5 // 4 ms max conversion + margin
+#define SHT31_COMMAND_DELAY_MS  2       // Soft reset / break settle time
+
+// Re-probe after the sensor stops responding: one soft reset per attempt,
+// only on a scheduled sample, with the interval doubling up to the maximum
+#define SHT31_REPROBE_MIN_MS    10000   // 10 seconds
+#define SHT31_REPROBE_MAX_MS    3600000 // 1 hour
+
+// Periodic mode: a fetch with no new result is NACKed, which is normal when
+// fetching faster than the rate. A sensor that is gone NACKs the same way,
+// so a NACK with no result for this many periods counts as not responding.
+#define SHT31_FETCH_MISSED_PERIODS 3
+
+// Values delivered with a failed measurement (ZCL "invalid measurement")
+#define SHT31_INVALID_TEMPERATURE   ((int16_t)0x8000)
+#define SHT31_INVALID_HUMIDITY      0xFFFF
+
+// Default acquisition mode (changeable at runtime with sht31_set_mode())
+#define SHT31_DEFAULT_MODE      SHT31_MODE_SINGLE_SHOT
+#define SHT31_DEFAULT_RATE      SHT31_RATE_0_5_MPS
+
+// Adaptive repeatability (single-shot mode): sample at low repeatability and
+// re-measure at high repeatability only when the cheap sample moved more than
+// the margin from the last delivered value. Margins in 0.01 °C / 0.01 %RH.
+#define SHT31_ADAPTIVE_DEFAULT_ENABLED      true
+#define SHT31_ADAPTIVE_TEMP_MARGIN_CENTI    20      // 0.2 °C (low rep. noise ~0.15 °C)
+#define SHT31_ADAPTIVE_HUM_MARGIN_CENTI     50      // 0.5 %RH (low rep. noise ~0.21 %RH)
+
+// Alert window around the last reported value, in 0.01 °C / 0.01 %RH.
+// Limits are stored with 9-bit T (~0.34 °C) and 7-bit RH (~0.78 %RH)
+// resolution; limits are rounded away from the value to a whole step, so
+// the window is up to one step wider than the margin on each side.
+#define SHT31_ALERT_TEMP_MARGIN_CENTI       50      // 0.5 °C
+#define SHT31_ALERT_HUM_MARGIN_CENTI        200     // 2 %RH
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  SHT31_MODE_SINGLE_SHOT,   // Command, wait for conversion, read (2 wakes)
+  SHT31_MODE_PERIODIC       // Sensor converts on its own, wake only to fetch
+} Sht31Mode_t;
+
+typedef enum {
+  SHT31_REPEATABILITY_LOW,      // ~4 ms conversion
+  SHT31_REPEATABILITY_MEDIUM,   // ~6 ms conversion
+  SHT31_REPEATABILITY_HIGH,     // ~15 ms conversion
+  SHT31_REPEATABILITY_COUNT
+} Sht31Repeatability_t;
+
+/**
+ * @brief ALERT pin callback
+ * Called from GPIO interrupt context when the measured value leaves the
+ * programmed window.
+ */
+typedef void (*sht31_alert_callback_t)(void);
+
+typedef struct {
+  uint32_t lowSamples;          // Low-repeatability samples delivered as-is
+  uint32_t highSamples;         // Samples escalated to high repeatability
+  uint32_t conversionMs;        // Total conversion wait time (energy proxy)
+} Sht31Stats_t;
+
+typedef enum {
+  SHT31_RATE_0_5_MPS,       // One measurement every 2 s
+  SHT31_RATE_1_MPS,
+  SHT31_RATE_2_MPS,
+  SHT31_RATE_4_MPS,
+  SHT31_RATE_10_MPS,
+  SHT31_RATE_COUNT
+} Sht31Rate_t;
+
+typedef enum {
+  SHT31_HEALTH_OK,              // Last transfer succeeded
+  SHT31_HEALTH_DATA_ERROR,      // Sensor responds but the last result failed CRC
+  SHT31_HEALTH_NOT_RESPONDING   // No ACK; re-probing with backoff
+} Sht31Health_t;
+
+/**
+ * @brief Measurement completion callback
+ * Invoked from interrupt context once the conversion has been read back
+ * (or immediately with invalid values when the sensor is not responding).
+ * Values are already in ZCL units.
+ *
+ * @param success true if values come from the real sensor; otherwise they
+ *        are SHT31_INVALID_TEMPERATURE / SHT31_INVALID_HUMIDITY
+ * @param temperature_centi Temperature in 0.01 °C
+ * @param humidity_centi Relative humidity in 0.01 %
+ */
+typedef void (*sht31_measurement_callback_t)(bool success,
+                                             int16_t temperature_centi,
+                                             uint16_t humidity_centi);
 
 //==============================================================================
 // Public Functions
@@ -46,18 +148,139 @@
  * @brief Initialize SHT31 sensor
  * Configures I2C and attempts to communicate with sensor
  *
- * @return true if sensor detected, false if using fallback mode
+ * @return true if sensor detected, false if it will be re-probed later
  */
 bool sht31_init(void);
 
 /**
- * @brief Read temperature and humidity from SHT31
+ * @brief Read temperature and humidity from SHT31 (blocking)
+ * Keeps the core awake for the whole conversion; prefer
+ * sht31_start_measurement() on the periodic path.
+ *
+ * @param[out] temperature_centi Temperature in 0.01 °C
+ * @param[out] humidity_centi Relative humidity in 0.01 %
+ * @return true if successful, false with invalid values otherwise
+ */
+bool sht31_read(int16_t *temperature_centi, uint16_t *humidity_centi);
+
+/**
+ * @brief Start a non-blocking measurement
+ * Single-shot mode: sends the measurement command and returns immediately.
+ * A one-shot sleeptimer fires after SHT31_MEASURE_DELAY_MS, so the device
+ * can stay in EM2 while the sensor converts.
+ * Periodic mode: fetches the latest result in one write/read transaction.
+ * The result is delivered to @p callback.
+ * While the sensor is not responding, the call is answered with invalid
+ * values right away, except when a re-probe is due: then a soft reset is
+ * sent first and the measurement continues if the sensor ACKs.
+ *
+ * @param callback Completion callback (must not be NULL)
+ * @return true if the measurement was started (or invalid values were
+ *         delivered), false if a measurement is already in progress
+ */
+bool sht31_start_measurement(sht31_measurement_callback_t callback);
+
+/**
+ * @brief Select single-shot or periodic acquisition
+ * In periodic mode the sensor converts continuously at @p rate and each
+ * sample is a single Fetch Data (0xE000) write/read transaction with no
+ * conversion wait. The sensor itself draws more current in this mode, so
+ * pick the lowest rate that still covers the application sample period.
+ *
+ * @param mode Acquisition mode
+ * @param rate Measurements per second (ignored in single-shot mode)
+ * @return true if the sensor accepted the new mode
+ */
+bool sht31_set_mode(Sht31Mode_t mode, Sht31Rate_t rate);
+
+/**
+ * @brief Get the current acquisition mode
+ * @return Current Sht31Mode_t
+ */
+Sht31Mode_t sht31_get_mode(void);
+
+/**
+ * @brief Get the current periodic acquisition rate
+ * @return Current Sht31Rate_t
+ */
+Sht31Rate_t sht31_get_rate(void);
+
+/**
+ * @brief Configure the adaptive two-tier repeatability policy
+ * @param enable true to sample at low repeatability and escalate on change,
+ *        false to always use high repeatability
+ * @param temp_margin_centi Escalation margin in 0.01 °C
+ * @param hum_margin_centi Escalation margin in 0.01 %RH
+ */
+void sht31_set_adaptive(bool enable,
+                        uint16_t temp_margin_centi,
+                        uint16_t hum_margin_centi);
+
+/**
+ * @brief Get the adaptive repeatability configuration
+ * @param[out] temp_margin_centi Escalation margin in 0.01 °C
+ * @param[out] hum_margin_centi Escalation margin in 0.01 %RH
+ * @return true if the adaptive policy is enabled
+ */
+bool sht31_get_adaptive(uint16_t *temp_margin_centi, uint16_t *hum_margin_centi);
+
+/**
+ * @brief Get per-tier sample counters
+ * @param[out] stats Counter snapshot
+ */
+void sht31_get_stats(Sht31Stats_t *stats);
+
+/**
+ * @brief Reset per-tier sample counters
+ */
+void sht31_reset_stats(void);
+
+/**
+ * @brief Enable ALERT-driven wakeups
+ * Switches the sensor to periodic acquisition at @p rate and arms the ALERT
+ * GPIO interrupt. Call sht31_set_alert_window() after every sample so the
+ * next alert fires only on a reportable change.
+ *
+ * @param rate Periodic acquisition rate (sets alert detection latency)
+ * @param callback Called when ALERT asserts
+ * @return true if the sensor entered periodic mode
+ */
+bool sht31_alert_enable(Sht31Rate_t rate, sht31_alert_callback_t callback);
+
+/**
+ * @brief Disable ALERT-driven wakeups and return to single-shot mode
+ * Fails while a measurement or a limit update is in progress (see
+ * sht31_is_busy()) or if the sensor does not leave periodic mode; ALERT
+ * then stays enabled and the call can be repeated.
+ *
+ * @return true if ALERT is disabled
+ */
+bool sht31_alert_disable(void);
+
+/**
+ * @brief Check if ALERT-driven wakeups are enabled
+ * @return true if enabled
+ */
+bool sht31_alert_is_enabled(void);
+
+/**
+ * @brief Program the alert window around a reported value (non-blocking)
+ * High/low set limits are value +/- margin; clear limits sit halfway, so
+ * ALERT releases once the window has been re-centred. All four are rounded
+ * away from the value to the limits' resolution. Writing the window also restarts acquisition, which drops an
+ * asserted ALERT until the next result.
  *
- * @param[out] temperature_c Temperature in degrees Celsius
- * @param[out] humidity_rh Relative humidity in percent
- * @return true if successful (real sensor), false if using fallback values
+ * @param temperature_centi Last reported temperature in 0.01 °C
+ * @param humidity_centi Last reported humidity in 0.01 %RH
+ * @return true if the limit update was started
+ */
+bool sht31_set_alert_window(int16_t temperature_centi, uint16_t humidity_centi);
+
+/**
+ * @brief Check if a non-blocking measurement is in progress
+ * @return true while waiting for conversion to complete
  */
-bool sht31_read(float *temperature_c, float *humidity_rh);
+bool sht31_is_busy(void);
 
 /**
  * @brief Reset SHT31 sensor
@@ -71,4 +294,34 @@ bool sht31_reset(void);
  */
 bool sht31_is_present(void);
 
+/**
+ * @brief Get the sensor health state
+ * @return Result of the most recent transfer or probe
+ */
+Sht31Health_t sht31_get_health(void);
+
+/**
+ * @brief Get the current re-probe interval
+ * @return Milliseconds between probes while not responding
+ */
+uint32_t sht31_get_reprobe_interval_ms(void);
+
+/**
+ * @brief Convert raw temperature ticks to ZCL units
+ * Integer-only, rounded to nearest: -45 + 175 * raw / 65535 °C
+ *
+ * @param raw Raw 16-bit sensor value
+ * @return Temperature in 0.01 °C (-4500..13000)
+ */
+int16_t sht31_raw_to_centi_celsius(uint16_t raw);
+
+/**
+ * @brief Convert raw humidity ticks to ZCL units
+ * Integer-only, rounded to nearest: 100 * raw / 65535 %RH
+ *
+ * @param raw Raw 16-bit sensor value
+ * @return Relative humidity in 0.01 % (0..10000)
+ */
+uint16_t sht31_raw_to_centi_rh(uint16_t raw);
+
 #endif // SHT31_H
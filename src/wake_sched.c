@@ -0,0 +1,284 @@
+/**
+ * @file wake_sched.c
+ * @brief Coalescing wake scheduler implementation
+ *
+ * Active tasks sit in an unordered list (a handful at most). Picking a due
+ * task and re-arming the timer happen under CORE_ATOMIC, callbacks run
+ * outside it. The timer interrupt only hands the drain to stack context
+ * (deferred_work.h), so every callback runs from the main loop.
+ */
+
+#include "wake_sched.h"
+#include "deferred_work.h"
+#include <stddef.h>
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static WakeSchedTask_t *activeTasks = NULL;
+
+static sl_sleeptimer_timer_handle_t wakeTimer;
+static bool wakeTimerArmed = false;
+static uint64_t wakeTimerTick = 0;
+
+static WakeSchedStats_t stats;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void start_task(WakeSchedTask_t *task, uint32_t delayMs, uint32_t periodMs,
+                       uint32_t toleranceMs, WakeSchedCallback_t callback, void *data);
+static void unlink_task(WakeSchedTask_t *task);
+static WakeSchedTask_t *take_due_task(uint64_t now);
+static void arm_timer(uint64_t now);
+static void run_due_tasks(bool fromTimer);
+static void wake_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void timer_wake_work(uint32_t arg0, uint32_t arg1);
+static uint32_t ms_to_ticks(uint32_t ms);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void wake_sched_start(WakeSchedTask_t *task,
+                      uint32_t delayMs,
+                      uint32_t toleranceMs,
+                      WakeSchedCallback_t callback,
+                      void *data)
+{
+  start_task(task, delayMs, 0, toleranceMs, callback, data);
+}
+
+void wake_sched_start_periodic(WakeSchedTask_t *task,
+                               uint32_t periodMs,
+                               uint32_t toleranceMs,
+                               WakeSchedCallback_t callback,
+                               void *data)
+{
+  start_task(task, periodMs, periodMs, toleranceMs, callback, data);
+}
+
+void wake_sched_stop(WakeSchedTask_t *task)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (task->active) {
+    unlink_task(task);
+    arm_timer(sl_sleeptimer_get_tick_count64());
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+bool wake_sched_is_active(const WakeSchedTask_t *task)
+{
+  return task->active;
+}
+
+void wake_sched_process(void)
+{
+  run_due_tasks(false);
+}
+
+void wake_sched_get_stats(WakeSchedStats_t *out)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = stats;
+  CORE_EXIT_ATOMIC();
+}
+
+void wake_sched_reset_stats(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  stats = (WakeSchedStats_t){ 0 };
+  CORE_EXIT_ATOMIC();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void start_task(WakeSchedTask_t *task, uint32_t delayMs, uint32_t periodMs,
+                       uint32_t toleranceMs, WakeSchedCallback_t callback, void *data)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  uint64_t now = sl_sleeptimer_get_tick_count64();
+
+  if (task->active) {
+    unlink_task(task);
+  }
+
+  task->callback = callback;
+  task->data = data;
+  task->dueTick = now + ms_to_ticks(delayMs);
+  task->toleranceTicks = ms_to_ticks(toleranceMs);
+  task->periodTicks = ms_to_ticks(periodMs);
+  task->active = true;
+  task->next = activeTasks;
+  activeTasks = task;
+
+  arm_timer(now);
+  CORE_EXIT_ATOMIC();
+}
+
+/**
+ * @brief Remove an active task from the list (caller holds CORE_ATOMIC)
+ */
+static void unlink_task(WakeSchedTask_t *task)
+{
+  for (WakeSchedTask_t **link = &activeTasks; *link != NULL; link = &(*link)->next) {
+    if (*link == task) {
+      *link = task->next;
+      break;
+    }
+  }
+
+  task->next = NULL;
+  task->active = false;
+}
+
+/**
+ * @brief Take the earliest task whose window has opened (caller holds
+ * CORE_ATOMIC)
+ * A periodic task moves to its next nominal due time and stays listed; a
+ * one-shot task is unlinked. Periods missed entirely are skipped, not
+ * run back to back.
+ */
+static WakeSchedTask_t *take_due_task(uint64_t now)
+{
+  WakeSchedTask_t *due = NULL;
+
+  for (WakeSchedTask_t *task = activeTasks; task != NULL; task = task->next) {
+    if (task->dueTick <= now && (due == NULL || task->dueTick < due->dueTick)) {
+      due = task;
+    }
+  }
+
+  if (due == NULL) {
+    return NULL;
+  }
+
+  if (due->periodTicks != 0) {
+    do {
+      due->dueTick += due->periodTicks;
+    } while (due->dueTick <= now);
+  } else {
+    unlink_task(due);
+  }
+
+  return due;
+}
+
+/**
+ * @brief Arm the timer for the earliest window end (caller holds
+ * CORE_ATOMIC)
+ */
+static void arm_timer(uint64_t now)
+{
+  bool any = false;
+  uint64_t latest = UINT64_MAX;
+
+  for (WakeSchedTask_t *task = activeTasks; task != NULL; task = task->next) {
+    uint64_t end = task->dueTick + task->toleranceTicks;
+    if (end < latest) {
+      latest = end;
+    }
+    any = true;
+  }
+
+  if (wakeTimerArmed && any && latest == wakeTimerTick) {
+    return;
+  }
+
+  if (wakeTimerArmed) {
+    sl_sleeptimer_stop_timer(&wakeTimer);
+    wakeTimerArmed = false;
+  }
+
+  if (!any) {
+    return;
+  }
+
+  uint64_t delay = (latest > now) ? latest - now : 1;
+  if (delay > UINT32_MAX) {
+    delay = UINT32_MAX;
+  }
+
+  sl_sleeptimer_start_timer(&wakeTimer, (uint32_t)delay, wake_timer_callback, NULL, 0, 0);
+  wakeTimerArmed = true;
+  wakeTimerTick = latest;
+}
+
+static void run_due_tasks(bool fromTimer)
+{
+  uint32_t ran = 0;
+
+  for (;;) {
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    uint64_t now = sl_sleeptimer_get_tick_count64();
+    WakeSchedTask_t *task = take_due_task(now);
+
+    if (task == NULL) {
+      arm_timer(now);
+      CORE_EXIT_ATOMIC();
+      break;
+    }
+
+    // Copied under the lock: the callback may restart the task
+    WakeSchedCallback_t callback = task->callback;
+    void *data = task->data;
+
+    stats.deadlines++;
+    if (!fromTimer) {
+      stats.piggybacked++;
+    } else if (ran > 0) {
+      stats.merged++;
+    }
+    CORE_EXIT_ATOMIC();
+
+    callback(task, data);
+    ran++;
+  }
+}
+
+static void wake_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  wakeTimerArmed = false;
+  stats.timerWakes++;
+  CORE_EXIT_ATOMIC();
+
+  if (!deferred_work_post(timer_wake_work, 0, 0)) {
+    // Ring full: the due tasks re-arm the timer for the next tick
+    CORE_ENTER_ATOMIC();
+    arm_timer(sl_sleeptimer_get_tick_count64());
+    CORE_EXIT_ATOMIC();
+  }
+}
+
+static void timer_wake_work(uint32_t arg0, uint32_t arg1)
+{
+  (void)arg0;
+  (void)arg1;
+
+  run_due_tasks(true);
+}
+
+static uint32_t ms_to_ticks(uint32_t ms)
+{
+  uint32_t ticks = 0;
+
+  sl_sleeptimer_ms32_to_tick(ms, &ticks);
+  return ticks;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file wake_sched.h
+ * @brief Coalescing wake scheduler for application deadlines
+ *
+ * Every application deadline (sensor sample, battery sample, fast-poll
+ * timeout, identify blink) is a task with a tolerance: it may run anywhere
+ * from its due time to due + tolerance. One sleeptimer is armed for the
+ * earliest latest-time; when it fires, every task whose window has opened
+ * runs in the same wake. Tasks whose window opens while the device is awake
+ * for another reason (a poll, a message) run from that wake's stack
+ * callback and cost no wake of their own.
+ *
+ * Periodic tasks keep their nominal phase, so running late never drifts the
+ * average rate. Driver-internal timeouts (I2C deadline, conversion wait,
+ * sensor power-up) need exact timing and stay on their own sleeptimers.
+ */
+
+#ifndef WAKE_SCHED_H
+#define WAKE_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef struct WakeSchedTask WakeSchedTask_t;
+
+typedef void (*WakeSchedCallback_t)(WakeSchedTask_t *task, void *data);
+
+// Owned by the caller, like a sleeptimer handle; fields are private
+struct WakeSchedTask {
+  WakeSchedTask_t *next;
+  WakeSchedCallback_t callback;
+  void *data;
+  uint64_t dueTick;             // Window opens
+  uint32_t toleranceTicks;      // Window length
+  uint32_t periodTicks;         // 0 = one-shot
+  bool active;
+};
+
+typedef struct {
+  uint32_t deadlines;           // Task runs
+  uint32_t timerWakes;          // Scheduler timer expiries
+  uint32_t merged;              // Runs that shared a timer wake with another
+  uint32_t piggybacked;         // Runs on a wake something else caused
+} WakeSchedStats_t;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Start a one-shot task (restarts it if already active)
+ * @param task Task handle
+ * @param delayMs Window opens this long from now
+ * @param toleranceMs Window length; 0 runs exactly on time
+ * @param callback Called from stack (main-loop) context
+ * @param data Passed to the callback
+ */
+void wake_sched_start(WakeSchedTask_t *task,
+                      uint32_t delayMs,
+                      uint32_t toleranceMs,
+                      WakeSchedCallback_t callback,
+                      void *data);
+
+/**
+ * @brief Start a periodic task, first run one period from now
+ * (restarts it if already active)
+ * @param task Task handle
+ * @param periodMs Period
+ * @param toleranceMs Window length after each nominal due time
+ * @param callback Called from stack (main-loop) context
+ * @param data Passed to the callback
+ */
+void wake_sched_start_periodic(WakeSchedTask_t *task,
+                               uint32_t periodMs,
+                               uint32_t toleranceMs,
+                               WakeSchedCallback_t callback,
+                               void *data);
+
+/**
+ * @brief Stop a task; no-op if it is not active
+ * @param task Task handle
+ */
+void wake_sched_stop(WakeSchedTask_t *task);
+
+/**
+ * @brief Check whether a task is active
+ * @param task Task handle
+ * @return true if started and not yet stopped or (one-shot) run
+ */
+bool wake_sched_is_active(const WakeSchedTask_t *task);
+
+/**
+ * @brief Run tasks whose window has opened
+ * Call from the stack callbacks of wakes something else caused (poll
+ * completed, message sent or received).
+ */
+void wake_sched_process(void);
+
+/**
+ * @brief Get wake counters since boot or the last reset
+ * Wakes saved = merged + piggybacked.
+ * @param[out] stats Counters to fill
+ */
+void wake_sched_get_stats(WakeSchedStats_t *stats);
+
+/**
+ * @brief Clear the wake counters
+ */
+void wake_sched_reset_stats(void);
+
+#endif // WAKE_SCHED_H
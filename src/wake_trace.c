@@ -0,0 +1,186 @@
+/**
+ * @file wake_trace.c
+ * @brief Wake-cycle phase profiler implementation
+ *
+ * Empty unless WAKE_TRACE_ENABLED is set in wake_trace.h.
+ */
+
+#include "wake_trace.h"
+
+#if WAKE_TRACE_ENABLED
+
+#include "em_device.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+
+//==============================================================================
+// Private Types
+//==============================================================================
+
+typedef struct {
+  bool open;
+  uint32_t beginTimestamp;
+  uint32_t count;
+  uint32_t discarded;
+  uint32_t minTicks;
+  uint32_t maxTicks;
+  uint64_t sumTicks;
+} PhaseAccumulator_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static WakeTraceEntry_t ring[WAKE_TRACE_RING_SIZE];
+static uint32_t ringWrites = 0;                   // Total marks, wraps the ring
+static uint32_t staleTicks = 0;                   // WAKE_TRACE_STALE_MS in timestamp ticks
+
+static PhaseAccumulator_t phases[WAKE_PHASE_COUNT];
+
+static const char * const phaseNames[WAKE_PHASE_COUNT] = {
+  "sample", "timer-cb", "sensor-cmd", "conversion", "i2c-read",
+  "blocking-read", "attr-write", "report-tx", "to-sleep"
+};
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static uint32_t timestamp_now(void);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void wake_trace_init(void)
+{
+#if WAKE_TRACE_USE_DWT
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  staleTicks = (uint32_t)(((uint64_t)SystemCoreClockGet() * WAKE_TRACE_STALE_MS) / 1000u);
+#else
+  staleTicks = (uint32_t)(((uint64_t)sl_sleeptimer_get_timer_frequency() * WAKE_TRACE_STALE_MS)
+                          / 1000u);
+#endif
+
+  wake_trace_reset();
+}
+
+void wake_trace_mark(WakeTracePhase_t phase, bool begin)
+{
+  uint32_t now = timestamp_now();
+  PhaseAccumulator_t *acc = &phases[phase];
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  if (!begin && !acc->open) {
+    // Unmatched end (e.g. an EM2 entry outside a sample) - not worth a slot
+    CORE_EXIT_ATOMIC();
+    return;
+  }
+
+  if (acc->open && (begin || now - acc->beginTimestamp > staleTicks)) {
+    // The path that opened it never closed it; its time is not this phase's
+    acc->open = false;
+    acc->discarded++;
+    if (!begin) {
+      CORE_EXIT_ATOMIC();
+      return;
+    }
+  }
+
+  WakeTraceEntry_t *entry = &ring[ringWrites & (WAKE_TRACE_RING_SIZE - 1)];
+  entry->timestamp = now;
+  entry->phase = (uint8_t)phase;
+  entry->begin = begin;
+  ringWrites++;
+
+  if (begin) {
+    acc->open = true;
+    acc->beginTimestamp = now;
+  } else {
+    uint32_t ticks = now - acc->beginTimestamp;
+    acc->open = false;
+    if (acc->count == 0 || ticks < acc->minTicks) {
+      acc->minTicks = ticks;
+    }
+    if (ticks > acc->maxTicks) {
+      acc->maxTicks = ticks;
+    }
+    acc->sumTicks += ticks;
+    acc->count++;
+  }
+
+  CORE_EXIT_ATOMIC();
+}
+
+bool wake_trace_get_entry(uint16_t index, WakeTraceEntry_t *entry)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+
+  uint32_t stored = (ringWrites < WAKE_TRACE_RING_SIZE) ? ringWrites : WAKE_TRACE_RING_SIZE;
+  bool exists = (index < stored);
+  if (exists) {
+    *entry = ring[(ringWrites - stored + index) & (WAKE_TRACE_RING_SIZE - 1)];
+  }
+
+  CORE_EXIT_ATOMIC();
+  return exists;
+}
+
+void wake_trace_get_stats(WakeTracePhase_t phase, WakeTraceStats_t *stats)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  PhaseAccumulator_t acc = phases[phase];
+  CORE_EXIT_ATOMIC();
+
+  stats->count = acc.count;
+  stats->discarded = acc.discarded;
+  stats->minUs = wake_trace_to_us(acc.minTicks);
+  stats->maxUs = wake_trace_to_us(acc.maxTicks);
+  stats->avgUs = (acc.count > 0) ? wake_trace_to_us((uint32_t)(acc.sumTicks / acc.count)) : 0;
+}
+
+uint32_t wake_trace_to_us(uint32_t ticks)
+{
+#if WAKE_TRACE_USE_DWT
+  return (uint32_t)(((uint64_t)ticks * 1000000u) / SystemCoreClockGet());
+#else
+  return (uint32_t)(((uint64_t)ticks * 1000000u) / sl_sleeptimer_get_timer_frequency());
+#endif
+}
+
+void wake_trace_reset(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  ringWrites = 0;
+  for (uint8_t i = 0; i < WAKE_PHASE_COUNT; i++) {
+    phases[i] = (PhaseAccumulator_t){ 0 };
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+const char *wake_trace_phase_name(WakeTracePhase_t phase)
+{
+  return (phase < WAKE_PHASE_COUNT) ? phaseNames[phase] : "?";
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static uint32_t timestamp_now(void)
+{
+#if WAKE_TRACE_USE_DWT
+  return DWT->CYCCNT;
+#else
+  return sl_sleeptimer_get_tick_count();
+#endif
+}
+
+#endif // WAKE_TRACE_ENABLED
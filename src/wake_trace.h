@@ -0,0 +1,144 @@
+/**
+ * @file wake_trace.h
+ * @brief Wake-cycle phase profiler
+ *
+ * Trace points mark the begin and end of the phases of a sample wake
+ * (timer callback, sensor command, conversion, I2C read, attribute write,
+ * report TX, return to sleep). Each mark is timestamped into a RAM ring and
+ * folded into per-phase min/avg/max durations.
+ *
+ * With WAKE_TRACE_ENABLED 0 the trace points expand to nothing and
+ * wake_trace.c compiles to an empty unit - production images carry no cost.
+ */
+
+#ifndef WAKE_TRACE_H
+#define WAKE_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define WAKE_TRACE_ENABLED          0
+
+// Marks kept in the ring (power of two)
+#define WAKE_TRACE_RING_SIZE        64
+
+// A begin whose end comes later than this is stale (its path never ended
+// it, e.g. a report the reporting plugin did not send) and is dropped
+// rather than folded in. Well above any one phase, below the read period.
+#define WAKE_TRACE_STALE_MS         5000
+
+// Timestamp source: 0 = sleeptimer tick (30.5 us, runs in EM2),
+// 1 = DWT cycle counter (core clock resolution, stops in EM2 - phases that
+// span a sleep, such as the conversion wait, then read short)
+#define WAKE_TRACE_USE_DWT          0
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  WAKE_PHASE_SAMPLE,            // Measurement started -> attributes written
+  WAKE_PHASE_TIMER_CALLBACK,    // sensor_timer_callback() body
+  WAKE_PHASE_SENSOR_COMMAND,    // Measurement command transfer
+  WAKE_PHASE_CONVERSION,        // Waiting for the SHT31 conversion
+  WAKE_PHASE_I2C_READ,          // Result read-back transfer
+  WAKE_PHASE_BLOCKING_READ,     // sht31_read() end to end
+  WAKE_PHASE_ATTRIBUTE_WRITE,   // emberAfWriteServerAttribute() calls
+  WAKE_PHASE_REPORT_TX,         // Attributes written -> report sent
+  WAKE_PHASE_RETURN_TO_SLEEP,   // Sample done -> next EM2 entry
+  WAKE_PHASE_COUNT
+} WakeTracePhase_t;
+
+typedef struct {
+  uint32_t timestamp;           // Raw timestamp (see wake_trace_to_us())
+  uint8_t phase;                // WakeTracePhase_t
+  bool begin;                   // true = begin mark, false = end mark
+} WakeTraceEntry_t;
+
+typedef struct {
+  uint32_t count;               // Completed begin/end pairs
+  uint32_t discarded;           // Stale begins dropped
+  uint32_t minUs;
+  uint32_t maxUs;
+  uint32_t avgUs;
+} WakeTraceStats_t;
+
+//==============================================================================
+// Trace Points
+//==============================================================================
+
+#if WAKE_TRACE_ENABLED
+#define WAKE_TRACE_BEGIN(phase)     wake_trace_mark((phase), true)
+#define WAKE_TRACE_END(phase)       wake_trace_mark((phase), false)
+#else
+#define WAKE_TRACE_BEGIN(phase)     ((void)0)
+#define WAKE_TRACE_END(phase)       ((void)0)
+#endif
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+#if WAKE_TRACE_ENABLED
+
+/**
+ * @brief Start the timestamp source and clear the trace
+ */
+void wake_trace_init(void);
+
+/**
+ * @brief Record a phase mark (use the WAKE_TRACE_* macros)
+ * Interrupt safe. An end without a matching begin is ignored. A begin still
+ * open when the phase begins again, or whose end comes more than
+ * WAKE_TRACE_STALE_MS later, is dropped and counted as discarded.
+ *
+ * @param phase Phase
+ * @param begin true for begin, false for end
+ */
+void wake_trace_mark(WakeTracePhase_t phase, bool begin);
+
+/**
+ * @brief Get a ring entry, oldest first
+ * @param index 0 = oldest mark still in the ring
+ * @param[out] entry Entry to fill
+ * @return true if the entry exists
+ */
+bool wake_trace_get_entry(uint16_t index, WakeTraceEntry_t *entry);
+
+/**
+ * @brief Get duration statistics for a phase
+ * @param phase Phase
+ * @param[out] stats Statistics to fill
+ */
+void wake_trace_get_stats(WakeTracePhase_t phase, WakeTraceStats_t *stats);
+
+/**
+ * @brief Convert a raw timestamp difference to microseconds
+ * @param ticks Raw timestamp difference
+ * @return Microseconds
+ */
+uint32_t wake_trace_to_us(uint32_t ticks);
+
+/**
+ * @brief Clear the ring and the statistics
+ */
+void wake_trace_reset(void);
+
+/**
+ * @brief Get a printable phase name
+ * @param phase Phase
+ * @return Short name
+ */
+const char *wake_trace_phase_name(WakeTracePhase_t phase);
+
+#else
+
+#define wake_trace_init()           ((void)0)
+
+#endif // WAKE_TRACE_ENABLED
+
+#endif // WAKE_TRACE_H
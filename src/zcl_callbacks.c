@@ -6,7 +6,11 @@
  * Temperature Measurement, and Relative Humidity Measurement clusters.
  */
 
+// Log module (app_log.h); must come before the includes
+#define APP_LOG_MODULE  APP_LOG_MODULE_ZCL
+
 #include "app.h"
+#include "wake_sched.h"
 #include "af.h"
 #include "app/framework/include/af.h"
 #include "sl_component_catalog.h"
@@ -15,19 +19,20 @@
 #include "sl_simple_led_instances.h"
 #endif
 
+
 //==============================================================================
 // Private Variables
 //==============================================================================
 
 static bool identifyActive = false;
-static sl_sleeptimer_timer_handle_t identifyTimer;
+static WakeSchedTask_t identifyTask;
 static uint16_t identifyTimeRemaining = 0;
 
 //==============================================================================
 // Forward Declarations
 //==============================================================================
 
-static void identify_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void identify_timer_callback(WakeSchedTask_t *task, void *data);
 static void identify_led_blink(void);
 
 //==============================================================================
@@ -149,19 +154,18 @@ bool emberAfIdentifyClusterIdentifyCallback(uint16_t identifyTime)
     if (!identifyActive) {
       identifyActive = true;
       // Start 1-second periodic timer for LED blinking
-      sl_sleeptimer_start_periodic_timer_ms(&identifyTimer,
-                                             1000,
-                                             identify_timer_callback,
-                                             NULL,
-                                             0,
-                                             0);
+      wake_sched_start_periodic(&identifyTask,
+                                1000,
+                                APP_IDENTIFY_TOLERANCE_MS,
+                                identify_timer_callback,
+                                NULL);
       APP_LOG("Identify started");
     }
   } else {
     // Stop identify
     if (identifyActive) {
       identifyActive = false;
-      sl_sleeptimer_stop_timer(&identifyTimer);
+      wake_sched_stop(&identifyTask);
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
       sl_led_turn_off(&sl_led_led0);
 #endif
@@ -197,9 +201,9 @@ bool emberAfIdentifyClusterIdentifyQueryCallback(void)
  * @brief Identify timer callback
  * Called every second during identify
  */
-static void identify_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+static void identify_timer_callback(WakeSchedTask_t *task, void *data)
 {
-  (void)handle;
+  (void)task;
   (void)data;
 
   if (identifyTimeRemaining > 0) {
@@ -218,7 +222,7 @@ static void identify_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *
     if (identifyTimeRemaining == 0) {
       // Identify finished
       identifyActive = false;
-      sl_sleeptimer_stop_timer(&identifyTimer);
+      wake_sched_stop(&identifyTask);
 #ifdef SL_CATALOG_SIMPLE_LED_PRESENT
       sl_led_turn_off(&sl_led_led0);
 #endif
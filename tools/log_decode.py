@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+"""Decode the tokenized log stream (APP_LOG_TOKENIZED in src/app_log.h).
+
+The firmware sends, per APP_LOG/APP_INFO/APP_ERROR/APP_DEBUG/APP_PRINT call,
+  0xA5 | token (u32 LE) | argc (u8) | string mask (u8) | arguments
+where an argument is a u32 LE, or, for bit n of the mask set, a string:
+length (u8) and that many bytes. The token is a hash of the module and the
+format string, computed by the compiler. Each call also leaves an entry -
+token, module, level, format - in the .app_log_tokens section of the ELF,
+which this tool reads to turn records back into text like the text backend
+would print them. Bytes outside records - CLI echo, prompts - are copied
+through.
+
+The ELF must be the one the image was built from; a format string that
+changed since decodes as <unknown token>. Tokens do not depend on line
+numbers, so edits elsewhere in the file leave them alone. Strings are
+copied into the record when the call is made, cut to APP_LOG_MAX_STRING
+bytes.
+
+Examples:
+  tools/log_decode.py capture.bin
+  tools/log_decode.py --elf build/sim/efr32mg1-sed-sim capture.bin
+  tools/log_decode.py --port /dev/ttyACM0      # needs pyserial
+  tools/log_decode.py --table                  # dump the token table
+"""
+
+import argparse
+import pathlib
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+MAX_ARGS = 8
+SECTION = ".app_log_tokens"
+ENTRY_MAGIC = 0x4B544C41            # "ALTK"
+ENTRY_HEADER = 12                   # magic, token, module, level, length
+HASH_K = 65599
+HASH_CHARS = 128
+LEVELS = {0: "PRINT", 1: "ERROR", 2: "INFO", 3: "DEBUG"}
+SPEC_RE = re.compile(r"%([-+ #0]*)(\d+)?(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsp%])")
+
+ROOT = pathlib.Path(__file__).resolve().parent.parent
+
+
+def read_modules(header):
+    """Map module ID -> name from app_log.h."""
+    modules = {}
+    for name, value in re.findall(r"#define\s+APP_LOG_MODULE_(\w+)\s+(\d+)", header.read_text()):
+        modules[int(value)] = name.lower()
+    return modules
+
+
+def token_of(module, fmt):
+    """APP_LOG_TOKEN() in src/app_log.h."""
+    h = 0
+    for c in reversed(fmt[:HASH_CHARS]):
+        h = (c + HASH_K * h) & 0xFFFFFFFF
+    return (module + HASH_K * ((len(fmt) + HASH_K * h) & 0xFFFFFFFF)) & 0xFFFFFFFF
+
+
+def read_section(path, name):
+    """Return the contents of section name from a little-endian ELF file."""
+    data = path.read_bytes()
+    if data[:4] != b"\x7fELF" or data[5] != 1:
+        raise ValueError(f"{path}: not a little-endian ELF file")
+    if data[4] == 2:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        header = "<IIQQQQ"
+    else:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        header = "<IIIIII"
+
+    def section(index):
+        sh_name, _, _, _, offset, size = struct.unpack_from(header, data, shoff + index * shentsize)
+        return sh_name, offset, size
+
+    _, names, _ = section(shstrndx)
+    for index in range(shnum):
+        sh_name, offset, size = section(index)
+        end = data.index(b"\0", names + sh_name)
+        if data[names + sh_name:end].decode() == name:
+            return data[offset:offset + size]
+    raise ValueError(f"{path}: no {name} section (built without APP_LOG_TOKENIZED?)")
+
+
+def build_table(elf, modules):
+    """Map token -> (module, level, format) from the ELF's token table."""
+    data = read_section(elf, SECTION)
+    table = {}
+    offset = 0
+    while offset + ENTRY_HEADER <= len(data):
+        magic, token, module, level, length = struct.unpack_from("<IIBBH", data, offset)
+        if magic != ENTRY_MAGIC:
+            offset += 4
+            continue
+        raw = data[offset + ENTRY_HEADER:offset + ENTRY_HEADER + length].split(b"\0", 1)[0]
+        offset += (ENTRY_HEADER + length + 3) & ~3
+        if token_of(module, raw) != token:
+            print(f"warning: token 0x{token:08x} does not match its format {raw!r}", file=sys.stderr)
+        entry = (modules.get(module, str(module)), LEVELS.get(level, str(level)),
+                 raw.decode("utf-8", "replace"))
+        # One format used at two levels is one token; only the text must agree
+        if table.get(token, entry)[::2] != entry[::2]:
+            print(f"warning: token 0x{token:08x} collides: {table[token][2]!r} and {entry[2]!r}",
+                  file=sys.stderr)
+        table[token] = entry
+    return table
+
+
+def format_record(fmt, values):
+    """Apply a printf format to the record's arguments (u32 or str)."""
+    it = iter(values)
+
+    def convert(m):
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        try:
+            raw = next(it)
+        except StopIteration:
+            return "<missing>"
+        spec = "%" + flags + (width or "")
+        if conv == "s":
+            return (spec + ("." + prec if prec else "") + "s") % raw
+        if isinstance(raw, str):
+            return "<str>"
+        if conv in "di":
+            value = raw - (1 << 32) if raw & 0x80000000 else raw
+            return (spec + ("." + prec if prec else "") + "d") % value
+        if conv in "ouxX":
+            return (spec + ("." + prec if prec else "") + conv.replace("u", "d")) % raw
+        if conv == "c":
+            return (spec + "c") % chr(raw & 0xFF)
+        return f"0x{raw:08x}"
+
+    return SPEC_RE.sub(convert, fmt)
+
+
+def parse_record(buf):
+    """Parse the record at buf[0].
+
+    Returns (size, token, values), None when more bytes are needed, or
+    False when buf[0] does not start a record.
+    """
+    if len(buf) < 7:
+        return None
+    token, argc, strings = struct.unpack_from("<IBB", buf, 1)
+    if argc > MAX_ARGS or strings >> argc:
+        return False
+    values, size = [], 7
+    for i in range(argc):
+        if strings & (1 << i):
+            if len(buf) < size + 1 or len(buf) < size + 1 + buf[size]:
+                return None
+            length = buf[size]
+            values.append(bytes(buf[size + 1:size + 1 + length]).decode("utf-8", "replace"))
+            size += 1 + length
+        else:
+            if len(buf) < size + 4:
+                return None
+            values.append(struct.unpack_from("<I", buf, size)[0])
+            size += 4
+    return size, token, values
+
+
+def decode(stream, table, out, follow=False):
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if follow:
+                continue
+            break
+        buf.extend(chunk)
+        while buf:
+            if buf[0] != SYNC:
+                end = buf.find(SYNC)
+                end = len(buf) if end < 0 else end
+                out.write(bytes(buf[:end]))
+                del buf[:end]
+                continue
+            record = parse_record(buf)
+            if record is None:
+                break
+            if record is False:
+                out.write(bytes(buf[:1]))     # Not a record - resync
+                del buf[0]
+                continue
+            size, token, values = record
+            del buf[:size]
+            if token == 0:
+                line = f"*** {values[0] if values else '?'} log records dropped ***"
+            elif token in table:
+                line = format_record(table[token][2], values)
+            else:
+                line = f"<unknown token 0x{token:08x} {values}>"
+            out.write((line + "\n").encode("utf-8"))
+        out.flush()
+    out.write(bytes(buf))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", nargs="?", default="-",
+                        help="Captured stream, '-' for stdin (default)")
+    parser.add_argument("--elf", type=pathlib.Path,
+                        default=ROOT / "build" / "release" / "efr32mg1-sed.axf",
+                        help="ELF the image was built from")
+    parser.add_argument("--port", help="Read from a serial port instead (pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--table", action="store_true", help="Print the token table and exit")
+    args = parser.parse_args()
+
+    try:
+        table = build_table(args.elf, read_modules(ROOT / "src" / "app_log.h"))
+    except (OSError, ValueError) as e:
+        sys.exit(f"error: {e}")
+
+    if args.table:
+        for token, (module, level, fmt) in sorted(table.items()):
+            print(f"0x{token:08x} {module:8} {level:5} {fmt!r}")
+        return
+
+    if args.port:
+        import serial  # pylint: disable=import-outside-toplevel
+        stream = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    try:
+        decode(stream, table, sys.stdout.buffer, follow=bool(args.port))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
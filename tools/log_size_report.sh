@@ -0,0 +1,109 @@
+#!/bin/bash
+set -euo pipefail
+
+# Build the firmware once per log level and report the flash each level saves
+# against the full (debug) build. Each build runs tools/build.sh in a scratch
+# copy of the tree with APP_LOG_LEVEL_DEFAULT (and optionally
+# APP_LOG_TOKENIZED) rewritten in src/app_log.h; the working tree is never
+# touched. Needs the same toolchain and Gecko SDK as tools/build.sh.
+#
+# Without them (or with --host) it compiles only src/*.c against the host
+# simulation stubs instead, with $CC -Os (default gcc), and sums the object
+# sizes. That leaves out the SDK and the linker, and measures the host
+# instruction set rather than Thumb-2: good for the differences between
+# levels, not for the absolute image size.
+#
+# Usage: tools/log_size_report.sh [--tokenized] [--host] [levels...]
+#   levels default to: DEBUG INFO ERROR NONE
+
+REPO_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TOKENIZED=0
+HOST=0
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --tokenized) TOKENIZED=1 ;;
+        --host) HOST=1 ;;
+        *) break ;;
+    esac
+    shift
+done
+
+if [ $HOST -eq 0 ] && ! command -v arm-none-eabi-gcc > /dev/null 2>&1 \
+    && [ ! -d "$HOME/.silabs/slt/installs/conan/p" ]; then
+    echo "No ARM toolchain found; measuring the host build instead (--host)"
+    HOST=1
+fi
+
+CC="${CC:-gcc}"
+SIZE="${SIZE:-size}"
+
+LEVELS=("$@")
+if [ ${#LEVELS[@]} -eq 0 ]; then
+    LEVELS=(DEBUG INFO ERROR NONE)
+fi
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+echo "=========================================="
+echo "  Log level flash report"
+echo "=========================================="
+echo "Tokenized backend: $TOKENIZED"
+if [ $HOST -eq 1 ]; then
+    echo "Host build: $($CC --version | head -1), -Os, src/*.c objects only"
+fi
+
+declare -A TEXT_SIZE
+declare -A DATA_SIZE
+
+for level in "${LEVELS[@]}"; do
+    echo ""
+    echo "Building APP_LOG_LEVEL_$level..."
+
+    tree="$WORK_DIR/$level"
+    mkdir -p "$tree"
+    (cd "$REPO_DIR" && tar --exclude=./build --exclude=./autogen --exclude=./.git -cf - .) \
+        | tar -xf - -C "$tree"
+
+    sed -i \
+        -e "s/^#define APP_LOG_LEVEL_DEFAULT .*/#define APP_LOG_LEVEL_DEFAULT           APP_LOG_LEVEL_$level/" \
+        -e "s/^#define APP_LOG_TOKENIZED .*/#define APP_LOG_TOKENIZED               $TOKENIZED/" \
+        "$tree/src/app_log.h"
+
+    if [ $HOST -eq 1 ]; then
+        # Berkeley size counts .rodata (the format strings) as text and
+        # leaves out the unallocated token table
+        if ! (cd "$tree" && $CC -std=gnu99 -Os -c -I tools/sim/stubs -I tools/sim -I src src/*.c \
+                > "$WORK_DIR/$level.log" 2>&1); then
+            echo "ERROR: build failed for $level, last lines:"
+            tail -20 "$WORK_DIR/$level.log"
+            exit 1
+        fi
+        read -r text data _ < <($SIZE -t "$tree"/*.o | tail -1)
+    else
+        if ! (cd "$tree" && bash tools/build.sh > "$WORK_DIR/$level.log" 2>&1); then
+            echo "ERROR: build failed for $level, last lines:"
+            tail -20 "$WORK_DIR/$level.log"
+            exit 1
+        fi
+
+        # build.sh prints arm-none-eabi-size under "Memory usage:"; text
+        # includes .rodata, which is where the format strings live
+        read -r text data _ < <(grep -A2 "^Memory usage:" "$WORK_DIR/$level.log" | tail -1)
+    fi
+    TEXT_SIZE[$level]=$text
+    DATA_SIZE[$level]=$data
+done
+
+base_level="${LEVELS[0]}"
+base_flash=$(( TEXT_SIZE[$base_level] + DATA_SIZE[$base_level] ))
+
+echo ""
+echo "Flash = text + data (initializers), bytes; saved is against $base_level"
+printf "%-8s %10s %10s %10s %10s\n" "level" "text" "data" "flash" "saved"
+for level in "${LEVELS[@]}"; do
+    flash=$(( TEXT_SIZE[$level] + DATA_SIZE[$level] ))
+    printf "%-8s %10d %10d %10d %10d\n" "$level" "${TEXT_SIZE[$level]}" \
+        "${DATA_SIZE[$level]}" "$flash" $(( base_flash - flash ))
+done
@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Estimate the average current saved by sensor bus power gating.
+
+Host-side model only - every figure below is a datasheet typical or an
+assumption, not a measurement. Override them on the command line and confirm
+the result with a power analyzer on the target board.
+
+Gating has two parts (see src/sensor_power.c):
+  * I2C0 clock gating: HFPERCLK is already stopped in EM2, so this only saves
+    current while the MCU is awake (EM0/EM1) between transfers.
+  * Sensor VDD gating (SENSOR_POWER_VDD_GPIO_ENABLED): removes the SHT31 idle
+    current in EM2, but costs a power-up (t_PU) and one extra EM2 wake per
+    sample. Only possible in single-shot mode.
+"""
+
+import argparse
+
+
+def estimate(args, period_s):
+    """Return (saved_ua, cost_ua, net_ua) averaged over one sample period."""
+    # Fraction of the period the sensor is unpowered (conversion + read done)
+    on_s = (args.power_up_ms + args.conversion_ms + args.read_ms) / 1000.0
+    off_fraction = max(0.0, 1.0 - on_s / period_s)
+
+    saved_ua = args.sensor_idle_ua * off_fraction
+    saved_ua += args.i2c_clock_ua * (args.awake_ms / 1000.0) / period_s
+
+    # Power-up charge plus the extra wake that ends the t_PU wait
+    cost_uc = args.power_up_ua * args.power_up_ms / 1000.0
+    cost_uc += args.wake_uc
+    cost_ua = cost_uc / period_s
+
+    return saved_ua, cost_ua, saved_ua - cost_ua
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sensor-idle-ua", type=float, default=0.2,
+                        help="SHT31 idle current, single-shot (typ 0.2, max 2.0)")
+    parser.add_argument("--power-up-ua", type=float, default=600.0,
+                        help="SHT31 current during t_PU (assumed)")
+    parser.add_argument("--power-up-ms", type=float, default=1.0,
+                        help="SHT31 power-up time t_PU (max 1.0)")
+    parser.add_argument("--conversion-ms", type=float, default=4.0,
+                        help="Conversion time (low repeatability ~4, high ~15)")
+    parser.add_argument("--read-ms", type=float, default=1.0,
+                        help="Time to read back the result")
+    parser.add_argument("--i2c-clock-ua", type=float, default=30.0,
+                        help="I2C0 clock current while the MCU is awake (assumed)")
+    parser.add_argument("--awake-ms", type=float, default=5.0,
+                        help="MCU awake time per sample outside I2C transfers")
+    parser.add_argument("--wake-uc", type=float, default=0.5,
+                        help="Charge of one extra EM2->EM0->EM2 wake (assumed)")
+    parser.add_argument("--periods", type=float, nargs="+",
+                        default=[10.0, 60.0, 300.0],
+                        help="Sample periods in seconds")
+    args = parser.parse_args()
+
+    print("ESTIMATE - model inputs are assumptions, not measurements")
+    print(f"{'period s':>9} {'saved uA':>9} {'cost uA':>9} {'net uA':>9}")
+    for period_s in args.periods:
+        saved, cost, net = estimate(args, period_s)
+        print(f"{period_s:>9.0f} {saved:>9.3f} {cost:>9.3f} {net:>9.3f}")
+
+
+if __name__ == "__main__":
+    main()
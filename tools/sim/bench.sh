@@ -0,0 +1,163 @@
+#!/bin/bash
+set -euo pipefail
+
+echo "=========================================="
+echo "  EFR32MG1 SED Awake-Time Benchmark"
+echo "=========================================="
+
+# Runs every configuration below against every scenario below on the host
+# simulation and writes one CSV row per pair: awake ms, wakes and TX bytes
+# per hour, and the battery life the firmware's energy model projects.
+# Compile-time knobs are rewritten in src/app.h of a scratch copy of the
+# tree (as tools/log_size_report.sh does); the working tree is never
+# touched. Run-time knobs are simulator options.
+#
+# Usage: tools/sim/bench.sh [--baseline FILE] [config...]
+#   configs default to all below; --baseline compares with an earlier
+#   results file (same config and scenario names)
+#
+# Output: build/bench/results.csv; exit status 1 if a CHECKS limit is
+# exceeded
+
+REPO_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+OUT_DIR="$REPO_DIR/build/bench"
+RESULTS="$OUT_DIR/results.csv"
+
+# name | app.h overrides (NAME=VALUE ...) | simulator options
+CONFIGS=(
+    "baseline||"
+    "read-5s|APP_SENSOR_READ_PERIOD_MS=5000|"
+    "read-30s|APP_SENSOR_READ_PERIOD_MS=30000|"
+    "read-60s|APP_SENSOR_READ_PERIOD_MS=60000|"
+    "long-poll-3s||--long-poll-ms 3000"
+    "long-poll-30s||--long-poll-ms 30000"
+    "fast-poll-1s|APP_FAST_POLL_INTERVAL_QS=4|"
+    "report-fine||--reporting temp:10:300:5 --reporting hum:10:300:50"
+    "report-coarse||--reporting temp:60:600:50 --reporting hum:60:600:300"
+    "no-coalesce|APP_SENSOR_READ_TOLERANCE_MS=0 APP_FAST_POLL_TOLERANCE_MS=0 APP_BATTERY_TOLERANCE_MS=0 APP_IDENTIFY_TOLERANCE_MS=0|"
+    "no-filter|APP_TEMP_QUANTUM_CENTI=1 APP_TEMP_HYSTERESIS_CENTI=0 APP_HUMIDITY_QUANTUM_CENTI=1 APP_HUMIDITY_HYSTERESIS_CENTI=0|"
+)
+
+# name | simulator options
+SCENARIOS=(
+    "idle|--days 1 --shape const --no-noise"
+    "steady|--days 1 --shape const"
+    "fast-change|--days 1 --shape sine --period-s 1200 --temp-swing 5 --hum-swing 15"
+    "sensor-missing|--days 1 --no-sensor"
+    "join-rejoin|--hours 2 --unjoined --press 5:12000 --press 3600:12000 --press 3700:12000"
+    "shelf|--days 1 --unjoined"
+)
+
+# scenario | metrics column | maximum; any configuration over it fails the run
+CHECKS=(
+    "shelf|wakes_h|0"
+)
+
+BASELINE=""
+if [ "${1:-}" = "--baseline" ]; then
+    BASELINE="$(realpath "$2")"
+    shift 2
+fi
+
+SELECTED=("$@")
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+mkdir -p "$OUT_DIR"
+: > "$WORK_DIR/results.csv"
+
+for entry in "${CONFIGS[@]}"; do
+    IFS='|' read -r name defines options <<< "$entry"
+
+    if [ ${#SELECTED[@]} -gt 0 ] && [[ ! " ${SELECTED[*]} " =~ " $name " ]]; then
+        continue
+    fi
+
+    echo ""
+    echo "Building $name..."
+
+    tree="$WORK_DIR/$name"
+    mkdir -p "$tree/tools"
+    cp -r "$REPO_DIR/src" "$tree/"
+    cp -r "$REPO_DIR/tools/sim" "$tree/tools/"
+
+    for define in $defines; do
+        knob="${define%%=*}"
+        if ! grep -q "^#define $knob " "$tree/src/app.h"; then
+            echo "ERROR: $knob is not defined in src/app.h"
+            exit 1
+        fi
+        sed -i "s/^#define $knob .*/#define $knob ${define#*=}/" "$tree/src/app.h"
+    done
+
+    if ! bash "$tree/tools/sim/build.sh" > "$WORK_DIR/$name.log" 2>&1; then
+        echo "ERROR: build failed for $name, last lines:"
+        tail -20 "$WORK_DIR/$name.log"
+        exit 1
+    fi
+
+    for scenario in "${SCENARIOS[@]}"; do
+        IFS='|' read -r scenarioName scenarioOptions <<< "$scenario"
+        echo "  $scenarioName"
+
+        # shellcheck disable=SC2086  # options are word lists
+        "$tree/build/sim/efr32mg1-sed-sim" $scenarioOptions $options \
+            --metrics "$WORK_DIR/metrics.csv" > /dev/null
+
+        if [ ! -s "$WORK_DIR/results.csv" ]; then
+            echo "config,scenario,$(head -1 "$WORK_DIR/metrics.csv")" > "$WORK_DIR/results.csv"
+        fi
+        echo "$name,$scenarioName,$(tail -1 "$WORK_DIR/metrics.csv")" >> "$WORK_DIR/results.csv"
+    done
+done
+
+cp "$WORK_DIR/results.csv" "$RESULTS"
+
+echo ""
+awk -F, '{ printf "%-16s %-16s %10s %10s %10s %10s %10s %10s %10s\n",
+            $1, $2, $3, $4, $5, $6, $7, $8, $9 }' "$RESULTS"
+
+if [ -n "$BASELINE" ]; then
+    echo ""
+    echo "Change against $BASELINE (%):"
+    # Columns 3-5 and 9: awake ms/h, wakes/h, TX bytes/h, battery days
+    awk -F, '
+        NR == FNR { if (FNR > 1) { base[$1 "," $2] = $0 } next }
+        FNR == 1 { printf "%-16s %-16s %10s %10s %10s %10s\n", "config", "scenario",
+                   "awake", "wakes", "tx", "battery"; next }
+        {
+            key = $1 "," $2
+            if (!(key in base)) { next }
+            split(base[key], b, ",")
+            printf "%-16s %-16s", $1, $2
+            n = split("3 4 5 9", cols, " ")
+            for (i = 1; i <= n; i++) {
+                c = cols[i]
+                if (b[c] == "" || b[c] == 0 || $c == "") { printf " %10s", "-" }
+                else { printf " %+10.1f", 100 * ($c - b[c]) / b[c] }
+            }
+            printf "\n"
+        }' "$BASELINE" "$RESULTS"
+fi
+
+FAILED=0
+for check in "${CHECKS[@]}"; do
+    IFS='|' read -r checkScenario column maximum <<< "$check"
+    if ! awk -F, -v scenario="$checkScenario" -v column="$column" -v maximum="$maximum" '
+            FNR == 1 { for (i = 1; i <= NF; i++) { if ($i == column) { c = i } } next }
+            $2 == scenario && $c + 0 > maximum + 0 {
+                printf "FAIL: %s %s %s = %s (max %s)\n", $1, $2, column, $c, maximum
+                failed = 1
+            }
+            END { exit failed }' "$RESULTS"; then
+        FAILED=1
+    fi
+done
+
+echo ""
+if [ "$FAILED" -ne 0 ]; then
+    echo "✗ Checks failed, results: $RESULTS"
+    exit 1
+fi
+echo "✓ Results: $RESULTS"
@@ -0,0 +1,45 @@
+#!/bin/bash
+set -euo pipefail
+
+echo "=========================================="
+echo "  EFR32MG1 SED Host Simulation Build"
+echo "=========================================="
+
+# Builds the firmware sources in src/ for the host against the stubs in
+# tools/sim/stubs. No Gecko SDK or ARM toolchain needed.
+#
+# Usage: tools/sim/build.sh, then build/sim/efr32mg1-sed-sim --help
+#        or build/sim/efr32mg1-sed-fleet --help
+
+REPO_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+SIM_DIR="$REPO_DIR/tools/sim"
+BUILD_DIR="$REPO_DIR/build/sim"
+TARGET="$BUILD_DIR/efr32mg1-sed-sim"
+FLEET_TARGET="$BUILD_DIR/efr32mg1-sed-fleet"
+
+CC="${CC:-gcc}"
+CFLAGS="${CFLAGS:--O2 -g}"
+
+mkdir -p "$BUILD_DIR"
+
+# Harness shared by both programs; each adds its own main
+COMMON_SOURCES=("$REPO_DIR"/src/*.c "$SIM_DIR"/sim.c "$SIM_DIR"/sim_hw.c \
+                "$SIM_DIR"/sim_sht31.c "$SIM_DIR"/sim_stack.c)
+
+build() {
+    local target="$1"
+    shift
+
+    echo "Building $target..."
+    $CC -std=gnu99 $CFLAGS -Wall \
+        -I "$SIM_DIR/stubs" -I "$SIM_DIR" -I "$REPO_DIR/src" \
+        "${COMMON_SOURCES[@]}" "$@" \
+        -lm -o "$target"
+}
+
+echo "Compiler: $($CC --version | head -1)"
+
+build "$TARGET" "$SIM_DIR"/sim_main.c
+build "$FLEET_TARGET" "$SIM_DIR"/fleet.c "$SIM_DIR"/fleet_main.c
+
+echo "✓ Build complete: $TARGET, $FLEET_TARGET"
@@ -0,0 +1,121 @@
+#!/bin/bash
+set -euo pipefail
+
+echo "=========================================="
+echo "  EFR32MG1 SED Sensor Fault Checks"
+echo "=========================================="
+
+# Runs the host simulation once per scenario below, each injecting SHT31
+# bus faults through --fault, and checks what the firmware made of them:
+# invalid and wrong attribute writes, the driver's health at the end, and
+# how long the sensor took to deliver a result again after the last hit.
+# Columns are the --metrics ones (see write_metrics() in sim_main.c);
+# sensor_health is the Sht31Health_t value, recovery_s is empty if no
+# result came after the last fault.
+#
+# Usage: tools/sim/faults.sh [scenario...]
+#   scenarios default to all below
+#
+# Output: build/faults/results.csv; exit status 1 if a CHECKS range is
+# not met
+
+REPO_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+SIM="$REPO_DIR/build/sim/efr32mg1-sed-sim"
+OUT_DIR="$REPO_DIR/build/faults"
+RESULTS="$OUT_DIR/results.csv"
+
+# name | simulator options; faults hit after half an hour of normal sampling
+SCENARIOS=(
+    "none|--hours 2"
+    "nack-burst|--hours 2 --fault nack@1800:5"
+    "sensor-gone|--hours 2 --fault nack@1800:100000"
+    "stretch|--hours 2 --fault stretch@1800:3"
+    "crc|--hours 2 --fault crc@1800:3:3"
+    "stuck|--hours 2 --fault stuck@1800:1"
+    "stuck-long|--hours 2 --fault stuck@1800:1:30"
+)
+
+# scenario (* for all) | metrics column | minimum | maximum
+CHECKS=(
+    "*|wrong_writes|0|0"
+    "none|invalid_writes|0|0"
+    "none|sensor_health|0|0"
+    "nack-burst|invalid_writes|1|2"           # One failed sample, both values
+    "nack-burst|sensor_health|0|0"
+    "nack-burst|recovery_s|0|200"             # Reprobe backoff 10+20+40+80 s
+    "sensor-gone|invalid_writes|1|2"          # Invalid once, not on every probe
+    "sensor-gone|sensor_health|2|2"           # Not responding
+    "stretch|invalid_writes|1|2"
+    "stretch|sensor_health|0|0"
+    "stretch|recovery_s|0|60"
+    "crc|invalid_writes|0|0"                  # The retry reads a good result
+    "crc|sensor_health|0|0"
+    "crc|recovery_s|0|15"
+    "stuck|invalid_writes|1|2"
+    "stuck|sensor_health|0|0"
+    "stuck|recovery_s|0|15"                   # Freed by the next transfer
+    "stuck-long|invalid_writes|1|2"
+    "stuck-long|sensor_health|0|0"
+    "stuck-long|recovery_s|0|120"
+)
+
+SELECTED=("$@")
+
+if ! bash "$REPO_DIR/tools/sim/build.sh" > /dev/null; then
+    echo "ERROR: simulator build failed"
+    exit 1
+fi
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+mkdir -p "$OUT_DIR"
+: > "$WORK_DIR/results.csv"
+
+for scenario in "${SCENARIOS[@]}"; do
+    IFS='|' read -r name options <<< "$scenario"
+
+    if [ ${#SELECTED[@]} -gt 0 ] && [[ ! " ${SELECTED[*]} " =~ " $name " ]]; then
+        continue
+    fi
+
+    echo "  $name"
+
+    # shellcheck disable=SC2086  # options are word lists
+    "$SIM" $options --metrics "$WORK_DIR/metrics.csv" > /dev/null
+
+    if [ ! -s "$WORK_DIR/results.csv" ]; then
+        echo "scenario,$(head -1 "$WORK_DIR/metrics.csv")" > "$WORK_DIR/results.csv"
+    fi
+    echo "$name,$(tail -1 "$WORK_DIR/metrics.csv")" >> "$WORK_DIR/results.csv"
+done
+
+cp "$WORK_DIR/results.csv" "$RESULTS"
+
+echo ""
+awk -F, '{ printf "%-12s %15s %13s %14s %11s\n", $1, $9, $10, $11, $12 }' "$RESULTS"
+
+FAILED=0
+for check in "${CHECKS[@]}"; do
+    IFS='|' read -r checkScenario column minimum maximum <<< "$check"
+    if ! awk -F, -v scenario="$checkScenario" -v column="$column" \
+            -v minimum="$minimum" -v maximum="$maximum" '
+            FNR == 1 { for (i = 1; i <= NF; i++) { if ($i == column) { c = i } } next }
+            scenario == "*" || $1 == scenario {
+                if ($c == "" || $c + 0 < minimum + 0 || $c + 0 > maximum + 0) {
+                    printf "FAIL: %s %s = %s (expected %s..%s)\n", $1, column,
+                           ($c == "" ? "none" : $c), minimum, maximum
+                    failed = 1
+                }
+            }
+            END { exit failed }' "$RESULTS"; then
+        FAILED=1
+    fi
+done
+
+echo ""
+if [ "$FAILED" -ne 0 ]; then
+    echo "✗ Checks failed, results: $RESULTS"
+    exit 1
+fi
+echo "✓ Results: $RESULTS"
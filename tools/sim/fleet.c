@@ -0,0 +1,749 @@
+/**
+ * @file fleet.c
+ * @brief Host simulation: shared channel and parent router for a fleet
+ *
+ * Discrete-event model, separate from the firmware's clock in sim.c: by the
+ * time it runs, every device has already been simulated. Nodes 0..N-1 are
+ * the devices, then the parent, then the coordinator; everyone hears
+ * everyone, so any two transmissions that overlap are both lost.
+ */
+
+#include "fleet.h"
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  EVENT_TRACE,              // Device firmware hands a frame to the radio
+  EVENT_CCA,
+  EVENT_TX_START,
+  EVENT_TX_END,
+  EVENT_ACK_START,          // Receiver answers the node's frame
+  EVENT_ACK_END,
+  EVENT_ACK_TIMEOUT
+} EventType_t;
+
+typedef struct {
+  uint64_t dueUs;
+  uint64_t order;           // FIFO among events due at the same time
+  EventType_t type;
+  uint32_t node;
+} Event_t;
+
+typedef struct Frame {
+  struct Frame *next;
+  FleetFrame_t kind;
+  uint32_t destination;
+  uint32_t device;          // The child the frame is about
+  uint16_t bytes;
+  uint64_t createdUs;       // Firmware report time, for latency
+  uint8_t backoffs;         // NB
+  uint8_t exponent;         // BE
+  uint8_t retries;
+  bool delivered;           // Receiver has it (an ACK may still be lost)
+  bool report;              // FORWARD of a report, not a response
+} Frame_t;
+
+typedef struct {
+  Frame_t *head;            // MAC queue
+  Frame_t *tail;
+  Frame_t *current;         // Being sent
+  uint64_t listenUntilUs;   // Child: waiting for frame-pending data
+  uint64_t airtimeUs;
+  uint32_t cursor;          // Child: next trace entry
+} Node_t;
+
+typedef struct {
+  uint32_t node;            // Transmitter
+  uint32_t ackFor;          // ACK: the node whose frame it acknowledges
+  bool ack;
+  bool collided;
+} Transmission_t;
+
+typedef struct {
+  uint32_t device;
+  uint64_t queuedUs;
+} Indirect_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static const FleetConfig_t *config;
+static const FleetTrace_t *traces;
+static uint32_t deviceCount;
+static uint32_t parent;
+static uint32_t coordinator;
+static FleetResult_t *result;
+
+static uint64_t nowUs;
+static uint64_t nextOrder;
+static uint64_t rngState;
+
+static Event_t *events;
+static uint32_t eventCount;
+static uint32_t eventCapacity;
+
+static Node_t *nodes;
+
+static Transmission_t *air;
+static uint32_t airCount;
+static uint32_t airCapacity;
+
+static Indirect_t *indirect;
+static uint32_t indirectCount;
+
+static uint64_t *busyPerSecondUs;
+static uint32_t seconds;
+static uint64_t busyUs;                 // Something on the air
+static uint64_t busySinceUs;
+
+static uint64_t *latencies;
+static uint32_t latencyCount;
+static uint32_t latencyCapacity;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void schedule(uint64_t dueUs, EventType_t type, uint32_t node);
+static bool next_event(Event_t *event);
+static void push_frame(uint32_t node, Frame_t *frame, bool front);
+static Frame_t *new_frame(FleetFrame_t kind, uint32_t destination, uint32_t device,
+                          uint16_t bytes, uint64_t createdUs);
+static void start_next(uint32_t node);
+static void start_csma(uint32_t node);
+static void trace_handler(uint32_t device);
+static void cca_handler(uint32_t node);
+static void tx_start_handler(uint32_t node);
+static void tx_end_handler(uint32_t node);
+static void ack_start_handler(uint32_t node);
+static void ack_end_handler(uint32_t node);
+static void attempt_failed(uint32_t node);
+static void frame_done(uint32_t node, bool success);
+static void deliver(Frame_t *frame);
+static void air_add(uint32_t node, uint32_t ackFor, uint16_t bytes, bool ack);
+static Transmission_t air_remove(uint32_t node, bool ack);
+static bool indirect_take(uint32_t device);
+static bool indirect_pending(uint32_t device);
+static void indirect_push(uint32_t device);
+static void record_latency(uint64_t us);
+static void summarize(void);
+static uint32_t random_below(uint32_t limit);
+static int compare_u64(const void *a, const void *b);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void fleet_run(const FleetConfig_t *fleetConfig, const FleetTrace_t *fleetTraces,
+               uint32_t devices, FleetResult_t *out)
+{
+  config = fleetConfig;
+  traces = fleetTraces;
+  deviceCount = devices;
+  parent = devices;
+  coordinator = devices + 1;
+  result = out;
+  memset(result, 0, sizeof(*result));
+
+  nowUs = 0;
+  nextOrder = 0;
+  rngState = config->seed ? config->seed : 1;
+  eventCount = 0;
+  airCount = 0;
+  indirectCount = 0;
+  latencyCount = 0;
+  busyUs = 0;
+
+  nodes = calloc(devices + 2, sizeof(*nodes));
+  indirect = calloc(config->queueSize ? config->queueSize : 1, sizeof(*indirect));
+  seconds = (uint32_t)(config->durationUs / 1000000u) + 1;
+  busyPerSecondUs = calloc(seconds, sizeof(*busyPerSecondUs));
+  if (nodes == NULL || indirect == NULL || busyPerSecondUs == NULL) {
+    fprintf(stderr, "fleet: out of memory\n");
+    exit(1);
+  }
+
+  for (uint32_t device = 0; device < devices; device++) {
+    if (traces[device].count > 0) {
+      schedule(traces[device].tx[0].timeUs, EVENT_TRACE, device);
+    }
+  }
+
+  Event_t event;
+  while (next_event(&event)) {
+    nowUs = event.dueUs;
+
+    switch (event.type) {
+      case EVENT_TRACE:
+        trace_handler(event.node);
+        break;
+      case EVENT_CCA:
+        cca_handler(event.node);
+        break;
+      case EVENT_TX_START:
+        tx_start_handler(event.node);
+        break;
+      case EVENT_TX_END:
+        tx_end_handler(event.node);
+        break;
+      case EVENT_ACK_START:
+        ack_start_handler(event.node);
+        break;
+      case EVENT_ACK_END:
+        ack_end_handler(event.node);
+        break;
+      case EVENT_ACK_TIMEOUT:
+        attempt_failed(event.node);
+        break;
+    }
+  }
+
+  summarize();
+
+  for (uint32_t node = 0; node < devices + 2; node++) {
+    while (nodes[node].head != NULL) {
+      Frame_t *frame = nodes[node].head;
+      nodes[node].head = frame->next;
+      free(frame);
+    }
+  }
+  free(nodes);
+  free(indirect);
+  free(busyPerSecondUs);
+}
+
+//==============================================================================
+// Private Functions - Event Queue
+//==============================================================================
+
+/**
+ * @brief Binary min-heap on (dueUs, order)
+ */
+static bool event_before(const Event_t *a, const Event_t *b)
+{
+  return (a->dueUs != b->dueUs) ? (a->dueUs < b->dueUs) : (a->order < b->order);
+}
+
+static void schedule(uint64_t dueUs, EventType_t type, uint32_t node)
+{
+  if (eventCount == eventCapacity) {
+    eventCapacity = eventCapacity ? eventCapacity * 2 : 1024;
+    events = realloc(events, eventCapacity * sizeof(*events));
+    if (events == NULL) {
+      fprintf(stderr, "fleet: out of memory\n");
+      exit(1);
+    }
+  }
+
+  uint32_t i = eventCount++;
+  events[i] = (Event_t) { .dueUs = dueUs, .order = nextOrder++, .type = type, .node = node };
+
+  while (i > 0 && event_before(&events[i], &events[(i - 1) / 2])) {
+    Event_t swap = events[i];
+    events[i] = events[(i - 1) / 2];
+    events[(i - 1) / 2] = swap;
+    i = (i - 1) / 2;
+  }
+}
+
+static bool next_event(Event_t *event)
+{
+  if (eventCount == 0) {
+    return false;
+  }
+
+  *event = events[0];
+  events[0] = events[--eventCount];
+
+  uint32_t i = 0;
+  for (;;) {
+    uint32_t smallest = i;
+    uint32_t left = 2 * i + 1;
+    uint32_t right = left + 1;
+
+    if (left < eventCount && event_before(&events[left], &events[smallest])) {
+      smallest = left;
+    }
+    if (right < eventCount && event_before(&events[right], &events[smallest])) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+
+    Event_t swap = events[i];
+    events[i] = events[smallest];
+    events[smallest] = swap;
+    i = smallest;
+  }
+
+  return true;
+}
+
+//==============================================================================
+// Private Functions - MAC
+//==============================================================================
+
+static Frame_t *new_frame(FleetFrame_t kind, uint32_t destination, uint32_t device,
+                          uint16_t bytes, uint64_t createdUs)
+{
+  Frame_t *frame = calloc(1, sizeof(*frame));
+
+  if (frame == NULL) {
+    fprintf(stderr, "fleet: out of memory\n");
+    exit(1);
+  }
+
+  frame->kind = kind;
+  frame->destination = destination;
+  frame->device = device;
+  frame->bytes = bytes;
+  frame->createdUs = createdUs;
+  result->frames[kind].frames++;
+
+  return frame;
+}
+
+/**
+ * @brief Queue @p frame on @p node's MAC; @p front for frame-pending data
+ */
+static void push_frame(uint32_t node, Frame_t *frame, bool front)
+{
+  Node_t *n = &nodes[node];
+
+  frame->next = NULL;
+  if (n->head == NULL) {
+    n->head = n->tail = frame;
+  } else if (front) {
+    frame->next = n->head;
+    n->head = frame;
+  } else {
+    n->tail->next = frame;
+    n->tail = frame;
+  }
+
+  if (n->current == NULL) {
+    start_next(node);
+  }
+}
+
+static void start_next(uint32_t node)
+{
+  Node_t *n = &nodes[node];
+
+  if (n->current != NULL || n->head == NULL) {
+    return;
+  }
+
+  n->current = n->head;
+  n->head = n->head->next;
+  if (n->head == NULL) {
+    n->tail = NULL;
+  }
+
+  start_csma(node);
+}
+
+static void start_csma(uint32_t node)
+{
+  Frame_t *frame = nodes[node].current;
+
+  frame->backoffs = 0;
+  frame->exponent = FLEET_MIN_BE;
+  schedule(nowUs + (uint64_t)random_below(1u << frame->exponent) * FLEET_UNIT_BACKOFF_US,
+           EVENT_CCA, node);
+}
+
+static void trace_handler(uint32_t device)
+{
+  static const FleetFrame_t kinds[SIM_FRAME_COUNT] = {
+    FLEET_FRAME_POLL, FLEET_FRAME_REPORT, FLEET_FRAME_RESPONSE
+  };
+  Node_t *n = &nodes[device];
+  const FleetTx_t *tx = &traces[device].tx[n->cursor++];
+
+  push_frame(device, new_frame(kinds[tx->frame], parent, device, tx->bytes, tx->timeUs),
+             false);
+
+  if (n->cursor < traces[device].count) {
+    schedule(traces[device].tx[n->cursor].timeUs, EVENT_TRACE, device);
+  }
+}
+
+static void cca_handler(uint32_t node)
+{
+  Frame_t *frame = nodes[node].current;
+
+  if (airCount == 0) {
+    schedule(nowUs + FLEET_CCA_US + FLEET_TURNAROUND_US, EVENT_TX_START, node);
+    return;
+  }
+
+  // Busy: back off longer, or give up on this attempt
+  if (++frame->backoffs > FLEET_MAX_CSMA_BACKOFFS) {
+    result->frames[frame->kind].accessFailures++;
+    attempt_failed(node);
+    return;
+  }
+
+  if (frame->exponent < FLEET_MAX_BE) {
+    frame->exponent++;
+  }
+  schedule(nowUs + FLEET_CCA_US
+           + (uint64_t)random_below(1u << frame->exponent) * FLEET_UNIT_BACKOFF_US,
+           EVENT_CCA, node);
+}
+
+static void tx_start_handler(uint32_t node)
+{
+  Frame_t *frame = nodes[node].current;
+
+  result->frames[frame->kind].attempts++;
+  air_add(node, node, frame->bytes, false);
+  schedule(nowUs + (uint64_t)frame->bytes * SIM_US_PER_BYTE, EVENT_TX_END, node);
+}
+
+static void tx_end_handler(uint32_t node)
+{
+  Frame_t *frame = nodes[node].current;
+  Transmission_t tx = air_remove(node, false);
+
+  if (tx.collided) {
+    result->frames[frame->kind].collided++;
+  }
+
+  // A child only hears frame-pending data while it is still listening
+  bool heard = !tx.collided
+               && (frame->kind != FLEET_FRAME_INDIRECT
+                   || nowUs <= nodes[frame->destination].listenUntilUs);
+
+  if (!heard) {
+    schedule(nowUs + FLEET_ACK_WAIT_US, EVENT_ACK_TIMEOUT, node);
+    return;
+  }
+
+  deliver(frame);
+  schedule(nowUs + FLEET_TURNAROUND_US, EVENT_ACK_START, node);
+}
+
+static void ack_start_handler(uint32_t node)
+{
+  air_add(nodes[node].current->destination, node, FLEET_ACK_BYTES, true);
+  schedule(nowUs + (uint64_t)FLEET_ACK_BYTES * SIM_US_PER_BYTE, EVENT_ACK_END, node);
+}
+
+static void ack_end_handler(uint32_t node)
+{
+  Transmission_t tx = air_remove(node, true);
+
+  if (tx.collided) {
+    attempt_failed(node);
+  } else {
+    frame_done(node, true);
+  }
+}
+
+/**
+ * @brief No ACK (or no channel): retry with a fresh CSMA, or give up
+ */
+static void attempt_failed(uint32_t node)
+{
+  Frame_t *frame = nodes[node].current;
+
+  if (++frame->retries > FLEET_MAX_FRAME_RETRIES) {
+    frame_done(node, false);
+    return;
+  }
+
+  start_csma(node);
+}
+
+static void frame_done(uint32_t node, bool success)
+{
+  Frame_t *frame = nodes[node].current;
+
+  // The receiver may have it even though the ACK never made it back
+  if (!success && !frame->delivered) {
+    result->frames[frame->kind].failed++;
+  }
+
+  nodes[node].current = NULL;
+  free(frame);
+  start_next(node);
+}
+
+/**
+ * @brief What the receiver does with a frame, once per frame
+ */
+static void deliver(Frame_t *frame)
+{
+  if (frame->delivered) {
+    return;                                     // Retry after a lost ACK
+  }
+  frame->delivered = true;
+
+  switch (frame->kind) {
+    case FLEET_FRAME_POLL:
+      if (indirect_take(frame->device)) {
+        result->pollsWithData++;
+        nodes[frame->device].listenUntilUs = nowUs + FLEET_POLL_RX_WAIT_US;
+        push_frame(parent, new_frame(FLEET_FRAME_INDIRECT, frame->device, frame->device,
+                                     FLEET_APS_ACK_BYTES, nowUs), true);
+      }
+      break;
+
+    case FLEET_FRAME_REPORT:
+    case FLEET_FRAME_RESPONSE: {
+      Frame_t *forward = new_frame(FLEET_FRAME_FORWARD, coordinator, frame->device,
+                                   frame->bytes, frame->createdUs);
+      forward->report = (frame->kind == FLEET_FRAME_REPORT);
+      push_frame(parent, forward, false);
+      break;
+    }
+
+    case FLEET_FRAME_FORWARD:
+      if (frame->report) {
+        result->reportsDelivered++;
+        record_latency(nowUs - frame->createdUs);
+      }
+      if (config->apsAck) {
+        push_frame(coordinator, new_frame(FLEET_FRAME_APS_ACK, parent, frame->device,
+                                          FLEET_APS_ACK_BYTES, nowUs), false);
+      }
+      break;
+
+    case FLEET_FRAME_APS_ACK:
+      indirect_push(frame->device);
+      break;
+
+    case FLEET_FRAME_INDIRECT:
+      // Frame pending still set: the child polls again straight away
+      if (indirect_pending(frame->device)) {
+        push_frame(frame->device, new_frame(FLEET_FRAME_POLL, parent, frame->device,
+                                            SIM_POLL_TX_BYTES, nowUs), false);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+//==============================================================================
+// Private Functions - Channel
+//==============================================================================
+
+/**
+ * @brief Put a transmission on the air; anything already there is lost, and so is it
+ */
+static void air_add(uint32_t node, uint32_t ackFor, uint16_t bytes, bool ack)
+{
+  if (airCount == airCapacity) {
+    airCapacity = airCapacity ? airCapacity * 2 : 16;
+    air = realloc(air, airCapacity * sizeof(*air));
+    if (air == NULL) {
+      fprintf(stderr, "fleet: out of memory\n");
+      exit(1);
+    }
+  }
+
+  bool collided = (airCount > 0);
+  if (!collided) {
+    busySinceUs = nowUs;
+  }
+  for (uint32_t i = 0; i < airCount; i++) {
+    air[i].collided = true;
+  }
+
+  air[airCount++] = (Transmission_t) {
+    .node = node,
+    .ackFor = ackFor,
+    .ack = ack,
+    .collided = collided
+  };
+  nodes[node].airtimeUs += (uint64_t)bytes * SIM_US_PER_BYTE;
+}
+
+/**
+ * @brief Take @p node's frame (or the ACK of it) off the air
+ */
+static Transmission_t air_remove(uint32_t node, bool ack)
+{
+  Transmission_t tx = { 0 };
+
+  for (uint32_t i = 0; i < airCount; i++) {
+    if (air[i].ackFor == node && air[i].ack == ack) {
+      tx = air[i];
+      air[i] = air[--airCount];
+      break;
+    }
+  }
+
+  // Channel idle again: book the busy period, split at second boundaries
+  if (airCount == 0) {
+    busyUs += nowUs - busySinceUs;
+    for (uint64_t fromUs = busySinceUs; fromUs < nowUs;) {
+      uint32_t second = (uint32_t)(fromUs / 1000000u);
+      uint64_t toUs = (uint64_t)(second + 1) * 1000000u;
+      if (toUs > nowUs) {
+        toUs = nowUs;
+      }
+      if (second < seconds) {
+        busyPerSecondUs[second] += toUs - fromUs;
+      }
+      fromUs = toUs;
+    }
+  }
+
+  return tx;
+}
+
+//==============================================================================
+// Private Functions - Parent
+//==============================================================================
+
+/**
+ * @brief Hand out the oldest message held for @p device, dropping stale ones
+ */
+static bool indirect_take(uint32_t device)
+{
+  uint64_t timeoutUs = (uint64_t)config->indirectTimeoutMs * 1000u;
+  uint32_t kept = 0;
+  bool found = false;
+
+  for (uint32_t i = 0; i < indirectCount; i++) {
+    if (nowUs - indirect[i].queuedUs > timeoutUs) {
+      result->queueExpired++;
+    } else if (!found && indirect[i].device == device) {
+      found = true;
+    } else {
+      indirect[kept++] = indirect[i];
+    }
+  }
+  indirectCount = kept;
+
+  return found;
+}
+
+static bool indirect_pending(uint32_t device)
+{
+  uint64_t timeoutUs = (uint64_t)config->indirectTimeoutMs * 1000u;
+
+  for (uint32_t i = 0; i < indirectCount; i++) {
+    if (indirect[i].device == device && nowUs - indirect[i].queuedUs <= timeoutUs) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void indirect_push(uint32_t device)
+{
+  uint64_t timeoutUs = (uint64_t)config->indirectTimeoutMs * 1000u;
+  uint32_t kept = 0;
+
+  // Expiry frees room before a new message is refused
+  for (uint32_t i = 0; i < indirectCount; i++) {
+    if (nowUs - indirect[i].queuedUs > timeoutUs) {
+      result->queueExpired++;
+    } else {
+      indirect[kept++] = indirect[i];
+    }
+  }
+  indirectCount = kept;
+
+  if (indirectCount >= config->queueSize) {
+    result->queueDrops++;
+    return;
+  }
+
+  indirect[indirectCount++] = (Indirect_t) { .device = device, .queuedUs = nowUs };
+  if (indirectCount > result->queuePeak) {
+    result->queuePeak = indirectCount;
+  }
+}
+
+//==============================================================================
+// Private Functions - Results
+//==============================================================================
+
+static void record_latency(uint64_t us)
+{
+  if (latencyCount == latencyCapacity) {
+    latencyCapacity = latencyCapacity ? latencyCapacity * 2 : 1024;
+    latencies = realloc(latencies, latencyCapacity * sizeof(*latencies));
+    if (latencies == NULL) {
+      fprintf(stderr, "fleet: out of memory\n");
+      exit(1);
+    }
+  }
+
+  latencies[latencyCount++] = us;
+}
+
+static void summarize(void)
+{
+  // Messages still held at the end that can no longer be polled for
+  uint64_t timeoutUs = (uint64_t)config->indirectTimeoutMs * 1000u;
+  for (uint32_t i = 0; i < indirectCount; i++) {
+    if (nowUs - indirect[i].queuedUs > timeoutUs) {
+      result->queueExpired++;
+    }
+  }
+
+  if (latencyCount > 0) {
+    uint64_t total = 0;
+
+    qsort(latencies, latencyCount, sizeof(*latencies), compare_u64);
+    for (uint32_t i = 0; i < latencyCount; i++) {
+      total += latencies[i];
+    }
+    result->latencyMeanMs = total / 1e3 / latencyCount;
+    result->latencyP95Ms = latencies[(uint32_t)((latencyCount - 1) * 0.95)] / 1e3;
+    result->latencyMaxMs = latencies[latencyCount - 1] / 1e3;
+  }
+
+  uint64_t airtimeTotal = 0;
+  for (uint32_t device = 0; device < deviceCount; device++) {
+    airtimeTotal += nodes[device].airtimeUs;
+    if (nodes[device].airtimeUs > result->airtimeMaxUs) {
+      result->airtimeMaxUs = (double)nodes[device].airtimeUs;
+    }
+  }
+  result->airtimeMeanUs = deviceCount ? (double)airtimeTotal / deviceCount : 0.0;
+
+  uint64_t peakUs = 0;
+  for (uint32_t second = 0; second < seconds; second++) {
+    if (busyPerSecondUs[second] > peakUs) {
+      peakUs = busyPerSecondUs[second];
+    }
+  }
+  result->channelBusyPct = 100.0 * busyUs / (double)config->durationUs;
+  result->channelPeakPct = 100.0 * peakUs / 1e6;
+}
+
+/**
+ * @brief Uniform in [0, limit) (xorshift64*), repeatable per seed
+ */
+static uint32_t random_below(uint32_t limit)
+{
+  rngState ^= rngState >> 12;
+  rngState ^= rngState << 25;
+  rngState ^= rngState >> 27;
+
+  return (uint32_t)(((rngState * 0x2545F4914F6CDD1DULL) >> 32) % limit);
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file fleet.h
+ * @brief Host simulation: many devices on one parent router
+ *
+ * Each device is a full run of the firmware under the single-device
+ * harness; what it transmits (polls, reports, responses) is recorded with
+ * its boot offset. fleet_run() then plays the recordings against a model
+ * of the shared channel (802.15.4 unslotted CSMA-CA, MAC ACKs and retries,
+ * one collision domain) and of the parent: it forwards reports to the
+ * coordinator, queues the coordinator's APS ACKs in a finite indirect queue
+ * and hands them out on the child's next poll.
+ *
+ * The loop is open: the firmware does not see its MAC failures, so a
+ * device keeps its own schedule whatever happens on the air. That is
+ * what a fleet of real devices does too, apart from the stack's own
+ * retries, which the channel model adds.
+ */
+
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// 802.15.4 MAC (2.4 GHz O-QPSK)
+#define FLEET_UNIT_BACKOFF_US       320     // aUnitBackoffPeriod
+#define FLEET_CCA_US                128     // 8 symbols
+#define FLEET_TURNAROUND_US         192     // aTurnaroundTime, RX to TX
+#define FLEET_ACK_WAIT_US           864     // macAckWaitDuration
+#define FLEET_MIN_BE                3       // macMinBE
+#define FLEET_MAX_BE                5       // macMaxBE
+#define FLEET_MAX_CSMA_BACKOFFS     4       // macMaxCSMABackoffs
+#define FLEET_MAX_FRAME_RETRIES     3       // macMaxFrameRetries
+#define FLEET_ACK_BYTES             11      // MAC ACK incl. PHY header
+
+// Parent and coordinator
+#define FLEET_APS_ACK_BYTES         45      // Secured NWK + APS ACK
+#define FLEET_INDIRECT_QUEUE        16      // Messages held for sleepy children
+#define FLEET_INDIRECT_TIMEOUT_MS   7680    // EmberZNet indirect transmission timeout
+#define FLEET_POLL_RX_WAIT_US       30000   // Child listens this long after a
+                                            // poll ACK with frame pending
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  FLEET_FRAME_POLL,         // Child -> parent, from the firmware
+  FLEET_FRAME_REPORT,
+  FLEET_FRAME_RESPONSE,
+  FLEET_FRAME_FORWARD,      // Parent -> coordinator, a child's report or response
+  FLEET_FRAME_APS_ACK,      // Coordinator -> parent, for a child
+  FLEET_FRAME_INDIRECT,     // Parent -> child, after a poll
+  FLEET_FRAME_COUNT
+} FleetFrame_t;
+
+// One frame a device handed to its radio
+typedef struct {
+  uint64_t timeUs;
+  uint16_t bytes;
+  uint8_t frame;            // SimFrame_t
+} FleetTx_t;
+
+typedef struct {
+  FleetTx_t *tx;            // In time order
+  uint32_t count;
+} FleetTrace_t;
+
+typedef struct {
+  uint64_t durationUs;
+  uint32_t queueSize;
+  uint32_t indirectTimeoutMs;
+  bool apsAck;              // Coordinator acknowledges reports end to end
+  uint32_t seed;
+} FleetConfig_t;
+
+typedef struct {
+  uint32_t frames;          // Handed to the MAC
+  uint32_t attempts;        // On the air, retries included
+  uint32_t collided;        // Attempts that overlapped another transmission
+  uint32_t accessFailures;  // CSMA found the channel busy too often
+  uint32_t failed;          // Given up after the last retry
+} FleetFrameStats_t;
+
+typedef struct {
+  FleetFrameStats_t frames[FLEET_FRAME_COUNT];
+  uint32_t pollsWithData;   // Poll ACKs with frame pending
+  uint32_t queuePeak;
+  uint32_t queueDrops;      // APS ACK arrived with the indirect queue full
+  uint32_t queueExpired;    // Not polled for within the timeout
+  uint32_t reportsDelivered;
+  double latencyMeanMs;     // Firmware report to coordinator
+  double latencyP95Ms;
+  double latencyMaxMs;
+  double airtimeMeanUs;     // Per device, TX incl. retries and ACKs
+  double airtimeMaxUs;
+  double channelBusyPct;    // Whole run
+  double channelPeakPct;    // Busiest second
+} FleetResult_t;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Play the first @p devices traces against the channel and parent
+ */
+void fleet_run(const FleetConfig_t *config, const FleetTrace_t *traces, uint32_t devices,
+               FleetResult_t *result);
+
+#endif // FLEET_H
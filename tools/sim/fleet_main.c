@@ -0,0 +1,339 @@
+/**
+ * @file fleet_main.c
+ * @brief Host simulation: fleet command line and report
+ *
+ * Usage: efr32mg1-sed-fleet [options], see usage() or --help.
+ *
+ * Every device is simulated in a forked child, so each gets fresh firmware
+ * state; its transmissions come back through a temporary file. The devices
+ * then share one parent in fleet_run(), once per fleet size asked for.
+ */
+
+#include "sim.h"
+#include "fleet.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define FLEET_DEFAULT_NODES     "1,10,50,100,200"
+#define FLEET_DEFAULT_HOURS     1
+#define FLEET_BOOT_JITTER_MS    500     // Power restored: boot spread across devices
+#define FLEET_SIZES_MAX         32
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static FILE *traceFile = NULL;
+static uint64_t traceOffsetUs = 0;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void usage(const char *program);
+static int parse_sizes(const char *text, uint32_t *sizes);
+static bool simulate_devices(FleetTrace_t *traces, uint32_t count, uint64_t durationUs,
+                             uint32_t jitterMs, uint32_t seed, long jobs);
+static void run_device(uint32_t index, uint64_t offsetUs, uint64_t durationUs, uint32_t seed,
+                       FILE *out);
+static void trace_tx(SimFrame_t frame, uint16_t txBytes);
+static bool read_trace(FILE *in, FleetTrace_t *trace);
+static void print_row(uint32_t devices, const FleetResult_t *result, double hours);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(int argc, char **argv)
+{
+  static const struct option options[] = {
+    { "nodes",              required_argument, NULL, 'N' },
+    { "hours",              required_argument, NULL, 'H' },
+    { "seconds",            required_argument, NULL, 's' },
+    { "queue",              required_argument, NULL, 'q' },
+    { "indirect-timeout-ms", required_argument, NULL, 'i' },
+    { "jitter-ms",          required_argument, NULL, 'j' },
+    { "long-poll-ms",       required_argument, NULL, 'l' },
+    { "no-aps-ack",         no_argument,       NULL, 'a' },
+    { "seed",               required_argument, NULL, 'S' },
+    { "jobs",               required_argument, NULL, 'J' },
+    { "help",               no_argument,       NULL, 'h' },
+    { NULL, 0, NULL, 0 }
+  };
+
+  uint32_t sizes[FLEET_SIZES_MAX];
+  int sizeCount = parse_sizes(FLEET_DEFAULT_NODES, sizes);
+  uint32_t jitterMs = FLEET_BOOT_JITTER_MS;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  FleetConfig_t config = {
+    .durationUs = (uint64_t)FLEET_DEFAULT_HOURS * 3600u * 1000000u,
+    .queueSize = FLEET_INDIRECT_QUEUE,
+    .indirectTimeoutMs = FLEET_INDIRECT_TIMEOUT_MS,
+    .apsAck = true,
+    .seed = 1
+  };
+  int option;
+
+  while ((option = getopt_long(argc, argv, "N:H:s:q:i:j:l:aS:J:h", options, NULL)) != -1) {
+    switch (option) {
+      case 'N':
+        sizeCount = parse_sizes(optarg, sizes);
+        if (sizeCount == 0) {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case 'H':
+        config.durationUs = (uint64_t)(strtod(optarg, NULL) * 3600e6);
+        break;
+      case 's':
+        config.durationUs = (uint64_t)(strtod(optarg, NULL) * 1e6);
+        break;
+      case 'q':
+        config.queueSize = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'i':
+        config.indirectTimeoutMs = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'j':
+        jitterMs = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'l':
+        sim_config()->longPollMs = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'a':
+        config.apsAck = false;
+        break;
+      case 'S':
+        config.seed = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'J':
+        jobs = strtol(optarg, NULL, 0);
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+
+  uint32_t maxDevices = 0;
+  for (int i = 0; i < sizeCount; i++) {
+    if (sizes[i] > maxDevices) {
+      maxDevices = sizes[i];
+    }
+  }
+
+  FleetTrace_t *traces = calloc(maxDevices, sizeof(*traces));
+  if (traces == NULL
+      || !simulate_devices(traces, maxDevices, config.durationUs, jitterMs, config.seed,
+                           jobs < 1 ? 1 : jobs)) {
+    fprintf(stderr, "fleet: device simulation failed\n");
+    return 1;
+  }
+
+  double hours = (double)config.durationUs / 3600e6;
+
+  printf("==========================================\n");
+  printf("  Fleet simulation report\n");
+  printf("==========================================\n");
+  printf("Simulated:      %.3f h, boot spread %u ms, long poll %u ms\n", hours, jitterMs,
+         sim_config()->longPollMs);
+  printf("Parent:         indirect queue %u, timeout %u ms, APS ACKs %s\n\n",
+         config.queueSize, config.indirectTimeoutMs, config.apsAck ? "on" : "off");
+  printf("%6s %9s %6s %6s %6s %6s %5s %6s %6s %9s %9s %9s %8s %8s %6s %6s\n",
+         "nodes", "polls/h", "coll%", "CAF", "fail", "lost", "qpeak", "qdrop", "qexp",
+         "lat ms", "p95 ms", "max ms", "air/h", "max/h", "chan%", "peak%");
+
+  for (int i = 0; i < sizeCount; i++) {
+    FleetResult_t result;
+    fleet_run(&config, traces, sizes[i], &result);
+    print_row(sizes[i], &result, hours);
+  }
+
+  printf("\n"
+         "coll%%  poll attempts that overlapped another transmission\n"
+         "CAF    poll attempts abandoned by CSMA (channel busy)\n"
+         "fail   polls given up after the last MAC retry\n"
+         "lost   reports that never reached the coordinator\n"
+         "qpeak/qdrop/qexp  parent indirect queue: peak, refused full, expired\n"
+         "lat/p95/max  report latency, firmware to coordinator\n"
+         "air/h, max/h  per-device TX airtime (ms/h): mean, worst device\n"
+         "chan%%, peak%%  channel busy: whole run, busiest second\n");
+
+  return 0;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void usage(const char *program)
+{
+  printf("Usage: %s [options]\n"
+         "  -N, --nodes LIST          Fleet sizes, comma separated (default %s)\n"
+         "  -H, --hours N             Simulated time in hours (default %d)\n"
+         "  -s, --seconds N           Simulated time in seconds\n"
+         "  -q, --queue N             Parent indirect queue size (default %d)\n"
+         "  -i, --indirect-timeout-ms MS  Indirect message lifetime (default %d)\n"
+         "  -j, --jitter-ms MS        Boot spread after power restore (default %d)\n"
+         "  -l, --long-poll-ms MS     Device long poll interval (default %d)\n"
+         "  -a, --no-aps-ack          Coordinator sends no APS ACKs\n"
+         "  -S, --seed N              Boot offsets, sensor noise and backoffs (default 1)\n"
+         "  -J, --jobs N              Devices simulated in parallel (default: CPUs)\n",
+         program, FLEET_DEFAULT_NODES, FLEET_DEFAULT_HOURS, FLEET_INDIRECT_QUEUE,
+         FLEET_INDIRECT_TIMEOUT_MS, FLEET_BOOT_JITTER_MS, SIM_LONG_POLL_MS);
+}
+
+/**
+ * @brief Parse "N[,N...]"
+ * @return Number of sizes, 0 on error
+ */
+static int parse_sizes(const char *text, uint32_t *sizes)
+{
+  int count = 0;
+  char *end;
+
+  do {
+    unsigned long size = strtoul(text, &end, 0);
+    if (end == text || size == 0 || count == FLEET_SIZES_MAX) {
+      return 0;
+    }
+    sizes[count++] = (uint32_t)size;
+    text = end + 1;
+  } while (*end == ',');
+
+  return (*end == '\0') ? count : 0;
+}
+
+/**
+ * @brief Simulate @p count devices, @p jobs at a time, one child process each
+ */
+static bool simulate_devices(FleetTrace_t *traces, uint32_t count, uint64_t durationUs,
+                             uint32_t jitterMs, uint32_t seed, long jobs)
+{
+  uint64_t rng = seed ? seed : 1;
+
+  for (uint32_t first = 0; first < count; first += (uint32_t)jobs) {
+    uint32_t batch = (count - first < (uint32_t)jobs) ? count - first : (uint32_t)jobs;
+    FILE *files[batch];
+    pid_t pids[batch];
+
+    for (uint32_t i = 0; i < batch; i++) {
+      // Boot offsets depend only on the device index, not on the fleet size
+      rng ^= rng >> 12;
+      rng ^= rng << 25;
+      rng ^= rng >> 27;
+      uint64_t offsetUs = jitterMs
+                          ? ((rng * 0x2545F4914F6CDD1DULL) >> 32) % ((uint64_t)jitterMs * 1000u)
+                          : 0;
+
+      files[i] = tmpfile();
+      if (files[i] == NULL) {
+        perror("fleet: tmpfile");
+        return false;
+      }
+
+      fflush(stdout);
+      pids[i] = fork();
+      if (pids[i] < 0) {
+        perror("fleet: fork");
+        return false;
+      }
+      if (pids[i] == 0) {
+        run_device(first + i, offsetUs, durationUs, seed, files[i]);
+      }
+    }
+
+    for (uint32_t i = 0; i < batch; i++) {
+      int status;
+      if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status)
+          || WEXITSTATUS(status) != 0 || !read_trace(files[i], &traces[first + i])) {
+        fprintf(stderr, "fleet: device %u failed\n", first + i);
+        return false;
+      }
+      fclose(files[i]);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Child: boot one device at @p offsetUs and record what it transmits
+ */
+static void run_device(uint32_t index, uint64_t offsetUs, uint64_t durationUs, uint32_t seed,
+                       FILE *out)
+{
+  SimSht31Signal_t signal;
+
+  traceFile = out;
+  traceOffsetUs = offsetUs;
+
+  sim_console_enable(false);
+  sim_stack_init();
+  sim_sht31_get_signal(&signal);
+  signal.seed = seed + index;
+  sim_sht31_set_signal(&signal);
+  sim_sht31_init();
+  sim_stack_set_radio_trace(trace_tx);
+  sim_stack_boot();
+
+  if (durationUs > offsetUs) {
+    sim_run_until(durationUs - offsetUs);
+  }
+
+  _exit(fflush(out) == 0 ? 0 : 1);
+}
+
+static void trace_tx(SimFrame_t frame, uint16_t txBytes)
+{
+  FleetTx_t tx = {
+    .timeUs = sim_now_us() + traceOffsetUs,
+    .bytes = txBytes,
+    .frame = (uint8_t)frame
+  };
+
+  fwrite(&tx, sizeof(tx), 1, traceFile);
+}
+
+static bool read_trace(FILE *in, FleetTrace_t *trace)
+{
+  if (fseek(in, 0, SEEK_END) != 0) {
+    return false;
+  }
+
+  long size = ftell(in);
+  rewind(in);
+
+  trace->count = (uint32_t)(size / (long)sizeof(FleetTx_t));
+  trace->tx = malloc((trace->count ? trace->count : 1) * sizeof(FleetTx_t));
+
+  return (trace->tx != NULL)
+         && (fread(trace->tx, sizeof(FleetTx_t), trace->count, in) == trace->count);
+}
+
+static void print_row(uint32_t devices, const FleetResult_t *result, double hours)
+{
+  const FleetFrameStats_t *polls = &result->frames[FLEET_FRAME_POLL];
+  const FleetFrameStats_t *reports = &result->frames[FLEET_FRAME_REPORT];
+
+  printf("%6u %9.0f %6.2f %6u %6u %6u %5u %6u %6u %9.1f %9.1f %9.1f %8.1f %8.1f %6.2f %6.1f\n",
+         devices, polls->frames / hours,
+         polls->attempts ? 100.0 * polls->collided / polls->attempts : 0.0,
+         polls->accessFailures, polls->failed,
+         reports->frames - result->reportsDelivered,
+         result->queuePeak, result->queueDrops, result->queueExpired,
+         result->latencyMeanMs, result->latencyP95Ms, result->latencyMaxMs,
+         result->airtimeMeanUs / 1e3 / hours, result->airtimeMaxUs / 1e3 / hours,
+         result->channelBusyPct, result->channelPeakPct);
+}
@@ -0,0 +1,548 @@
+/**
+ * @file sim.c
+ * @brief Host simulation: virtual clock, event loop, sleeptimer, power manager
+ *
+ * The clock counts microseconds and only moves when the firmware spends
+ * CPU time (cost model), busy-waits, or sleeps until the next event.
+ */
+
+#include "sim.h"
+#include "af.h"
+#include "em_device.h"
+#include "em_emu.h"
+#include "sl_sleeptimer.h"
+#include "sl_udelay.h"
+#include "sl_power_manager.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+#define SLEEPTIMER_FREQUENCY    32768u
+
+static SimConfig_t config = {
+  .wakeEm0Us = SIM_WAKE_EM0_US,
+  .tickEm0Us = SIM_TICK_EM0_US,
+  .pollEm0Us = SIM_POLL_EM0_US,
+  .txEm0Us = SIM_TX_EM0_US,
+  .longPollMs = SIM_LONG_POLL_MS,
+  .joinMs = SIM_JOIN_MS,
+  .batteryMv = SIM_BATTERY_MV,
+  .adcNoiseLsb = 0.0,
+  .startJoined = true,
+  .sensorAttached = true,
+  .verbose = false
+};
+
+static uint64_t nowUs = 0;
+static SimEvent_t *queueHead = NULL;
+static uint64_t scheduleOrder = 0;
+static SimStats_t stats;
+static bool consoleEnabled = false;
+static uint32_t irqDepth = 0;
+
+// Power manager
+static uint32_t em1Requirements = 0;
+static sl_power_manager_em_transition_event_handle_t *subscribers = NULL;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void advance_to(uint64_t us, SimMode_t mode);
+static void fire_next(void);
+static void fire_due(void);
+static void sleep_until(uint64_t endUs);
+static void notify_transition(sl_power_manager_em_t from, sl_power_manager_em_t to);
+static void timer_event_handler(void *context);
+static uint64_t tick_now(void);
+static uint64_t tick_to_us_ceil(uint64_t tick);
+static uint64_t host_ns(void);
+
+//==============================================================================
+// Public Functions - Core
+//==============================================================================
+
+SimConfig_t *sim_config(void)
+{
+  return &config;
+}
+
+uint64_t sim_now_us(void)
+{
+  return nowUs;
+}
+
+void sim_event_init(SimEvent_t *event, sim_event_handler_t handler, void *context,
+                    SimSource_t source)
+{
+  sim_event_cancel(event);
+  event->handler = handler;
+  event->context = context;
+  event->source = source;
+}
+
+void sim_event_schedule_at(SimEvent_t *event, uint64_t dueUs)
+{
+  sim_event_cancel(event);
+
+  event->dueUs = (dueUs < nowUs) ? nowUs : dueUs;
+  event->order = scheduleOrder++;
+  event->scheduled = true;
+
+  // Sorted by due time; FIFO among equals
+  SimEvent_t **link = &queueHead;
+  while (*link != NULL && (*link)->dueUs <= event->dueUs) {
+    link = &(*link)->next;
+  }
+  event->next = *link;
+  *link = event;
+}
+
+void sim_event_schedule(SimEvent_t *event, uint64_t delayUs)
+{
+  sim_event_schedule_at(event, nowUs + delayUs);
+}
+
+void sim_event_cancel(SimEvent_t *event)
+{
+  if (!event->scheduled) {
+    return;
+  }
+
+  for (SimEvent_t **link = &queueHead; *link != NULL; link = &(*link)->next) {
+    if (*link == event) {
+      *link = event->next;
+      break;
+    }
+  }
+  event->next = NULL;
+  event->scheduled = false;
+}
+
+uint32_t sim_event_count(SimSource_t source)
+{
+  uint32_t count = 0;
+
+  for (const SimEvent_t *event = queueHead; event != NULL; event = event->next) {
+    if (event->source == source) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+uint32_t sim_periodic_timer_count(void)
+{
+  uint32_t count = 0;
+
+  for (const SimEvent_t *event = queueHead; event != NULL; event = event->next) {
+    if (event->handler == timer_event_handler
+        && ((const sl_sleeptimer_timer_handle_t *)event->context)->timeout_periodic != 0) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+void sim_busy_us(uint64_t us)
+{
+  uint64_t endUs = nowUs + us;
+
+  while (queueHead != NULL && queueHead->dueUs <= endUs) {
+    advance_to(queueHead->dueUs, SIM_MODE_EM0);
+    fire_next();
+  }
+  advance_to(endUs, SIM_MODE_EM0);
+}
+
+void sim_run_until(uint64_t endUs)
+{
+  while (nowUs < endUs) {
+    // Per-pass cost of the application's tick path, measured on the host
+    uint64_t startNs = host_ns();
+    emberAfMainTickCallback();
+    stats.tickHostNs += host_ns() - startNs;
+    stats.ticks++;
+
+    stats.stackEvents += sim_stack_run_events();
+    sim_busy_us(config.tickEm0Us);
+
+    if (sim_stack_events_pending() || (queueHead != NULL && queueHead->dueUs <= nowUs)) {
+      // More work before the stack lets the device sleep
+      fire_due();
+      continue;
+    }
+
+    sleep_until(endUs);
+  }
+}
+
+void sim_get_stats(SimStats_t *out)
+{
+  *out = stats;
+}
+
+void sim_console_enable(bool enable)
+{
+  consoleEnabled = enable;
+}
+
+bool sim_console_is_enabled(void)
+{
+  return consoleEnabled;
+}
+
+void sim_log(const char *format, ...)
+{
+  va_list args;
+
+  printf("[%12.3f] ", (double)nowUs / 1e6);
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  putchar('\n');
+}
+
+//==============================================================================
+// Public Functions - Platform Stubs
+//==============================================================================
+
+bool CORE_InIrqContext(void)
+{
+  return irqDepth > 0;
+}
+
+void EMU_EnterEM1(void)
+{
+  if (queueHead == NULL) {
+    fprintf(stderr, "sim: EM1 wait with nothing pending at %.6f s\n", (double)nowUs / 1e6);
+    exit(1);
+  }
+
+  advance_to(queueHead->dueUs, SIM_MODE_EM1);
+  fire_due();
+}
+
+void sl_udelay_wait(unsigned us)
+{
+  sim_busy_us(us);
+}
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em)
+{
+  if (em == SL_POWER_MANAGER_EM1) {
+    em1Requirements++;
+  }
+}
+
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em)
+{
+  if (em == SL_POWER_MANAGER_EM1 && em1Requirements > 0) {
+    em1Requirements--;
+  }
+}
+
+void sl_power_manager_subscribe_em_transition_event(
+  sl_power_manager_em_transition_event_handle_t *event_handle,
+  const sl_power_manager_em_transition_event_info_t *event_info)
+{
+  event_handle->info = event_info;
+  event_handle->next = subscribers;
+  subscribers = event_handle;
+}
+
+void sl_power_manager_unsubscribe_em_transition_event(
+  sl_power_manager_em_transition_event_handle_t *event_handle)
+{
+  for (sl_power_manager_em_transition_event_handle_t **link = &subscribers;
+       *link != NULL; link = &(*link)->next) {
+    if (*link == event_handle) {
+      *link = event_handle->next;
+      return;
+    }
+  }
+}
+
+sl_status_t sl_sleeptimer_start_timer(sl_sleeptimer_timer_handle_t *handle,
+                                      uint32_t timeout,
+                                      sl_sleeptimer_timer_callback_t callback,
+                                      void *callback_data,
+                                      uint8_t priority,
+                                      uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+
+  if (handle == NULL) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  if (handle->event.scheduled) {
+    // Same as the driver: a running timer must be stopped first
+    return SL_STATUS_NOT_READY;
+  }
+
+  handle->callback = callback;
+  handle->callback_data = callback_data;
+  handle->timeout_periodic = 0;
+  sim_event_init(&handle->event, timer_event_handler, handle, SIM_SOURCE_TIMER);
+  sim_event_schedule_at(&handle->event, tick_to_us_ceil(tick_now() + timeout));
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags)
+{
+  uint32_t ticks;
+
+  sl_sleeptimer_ms32_to_tick(timeout_ms, &ticks);
+  return sl_sleeptimer_start_timer(handle, ticks, callback, callback_data,
+                                   priority, option_flags);
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                                  uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback,
+                                                  void *callback_data,
+                                                  uint8_t priority,
+                                                  uint16_t option_flags)
+{
+  uint32_t ticks;
+
+  sl_sleeptimer_ms32_to_tick(timeout_ms, &ticks);
+  sl_status_t status = sl_sleeptimer_start_timer(handle, ticks, callback, callback_data,
+                                                 priority, option_flags);
+  if (status == SL_STATUS_OK) {
+    handle->timeout_periodic = ticks;
+  }
+
+  return status;
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  if (handle == NULL) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  if (!handle->event.scheduled) {
+    return SL_STATUS_INVALID_STATE;
+  }
+
+  sim_event_cancel(&handle->event);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle,
+                                           bool *running)
+{
+  *running = handle->event.scheduled;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_get_timer_time_remaining(sl_sleeptimer_timer_handle_t *handle,
+                                                   uint32_t *time)
+{
+  if (!handle->event.scheduled) {
+    return SL_STATUS_INVALID_STATE;
+  }
+
+  *time = (uint32_t)((handle->event.dueUs - nowUs) * SLEEPTIMER_FREQUENCY / 1000000u);
+  return SL_STATUS_OK;
+}
+
+void sl_sleeptimer_delay_millisecond(uint16_t time_ms)
+{
+  // The driver busy-waits on the tick counter
+  sim_busy_us((uint64_t)time_ms * 1000u);
+}
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return (uint32_t)tick_now();
+}
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return tick_now();
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+  return SLEEPTIMER_FREQUENCY;
+}
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick)
+{
+  return (uint32_t)(((uint64_t)tick * 1000u) / SLEEPTIMER_FREQUENCY);
+}
+
+uint64_t sl_sleeptimer_tick64_to_ms(uint64_t tick)
+{
+  return (tick * 1000u) / SLEEPTIMER_FREQUENCY;
+}
+
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms)
+{
+  uint32_t ticks;
+
+  sl_sleeptimer_ms32_to_tick(time_ms, &ticks);
+  return ticks;
+}
+
+sl_status_t sl_sleeptimer_ms32_to_tick(uint32_t time_ms, uint32_t *tick)
+{
+  *tick = (uint32_t)(((uint64_t)time_ms * SLEEPTIMER_FREQUENCY + 999u) / 1000u);
+  return SL_STATUS_OK;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Move the clock forward, charging the time to @p mode
+ */
+static void advance_to(uint64_t us, SimMode_t mode)
+{
+  if (us <= nowUs) {
+    return;
+  }
+
+  stats.residencyUs[mode] += us - nowUs;
+  nowUs = us;
+
+  // Cycle counter for WAKE_TRACE_USE_DWT builds
+  DWT->CYCCNT = (uint32_t)(nowUs * (SystemCoreClockGet() / 1000000u));
+}
+
+/**
+ * @brief Take the first event off the queue and run it
+ * Timer and peripheral events stand in for interrupts; stack events are
+ * main-loop work and device events never reach firmware code directly.
+ */
+static void fire_next(void)
+{
+  SimEvent_t *event = queueHead;
+  bool irq = (event->source != SIM_SOURCE_STACK && event->source != SIM_SOURCE_DEVICE);
+
+  queueHead = event->next;
+  event->next = NULL;
+  event->scheduled = false;
+  stats.eventsBySource[event->source]++;
+
+  irqDepth += irq ? 1 : 0;
+  event->handler(event->context);
+  irqDepth -= irq ? 1 : 0;
+}
+
+/**
+ * @brief Run every event due at the current time
+ */
+static void fire_due(void)
+{
+  while (queueHead != NULL && queueHead->dueUs <= nowUs) {
+    fire_next();
+  }
+}
+
+/**
+ * @brief Idle until the next event or @p endUs in the deepest mode allowed
+ * Device-internal events run without waking the MCU. Stays asleep when
+ * the run ends first.
+ */
+static void sleep_until(uint64_t endUs)
+{
+  bool em1 = (em1Requirements > 0);
+  sl_power_manager_em_t sleepEm = em1 ? SL_POWER_MANAGER_EM1 : SL_POWER_MANAGER_EM2;
+
+  notify_transition(SL_POWER_MANAGER_EM0, sleepEm);
+
+  for (;;) {
+    uint64_t us = (queueHead != NULL && queueHead->dueUs < endUs) ? queueHead->dueUs : endUs;
+
+    advance_to(us, em1 ? SIM_MODE_EM1 : SIM_MODE_EM2);
+
+    if (queueHead == NULL || queueHead->dueUs > nowUs) {
+      return;
+    }
+    if (queueHead->source != SIM_SOURCE_DEVICE) {
+      break;
+    }
+    fire_next();
+  }
+
+  notify_transition(sleepEm, SL_POWER_MANAGER_EM0);
+
+  if (!em1) {
+    stats.wakes++;
+    stats.wakesBySource[queueHead->source]++;
+  }
+
+  fire_due();
+
+  if (!em1) {
+    sim_busy_us(config.wakeEm0Us);
+  }
+}
+
+/**
+ * @brief Call the subscribers interested in leaving @p from or entering @p to
+ */
+static void notify_transition(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  uint32_t mask = (1u << (2 * to)) | (1u << (2 * from + 1));
+
+  for (sl_power_manager_em_transition_event_handle_t *handle = subscribers;
+       handle != NULL; handle = handle->next) {
+    if (handle->info->event_mask & mask) {
+      handle->info->on_event(from, to);
+    }
+  }
+}
+
+/**
+ * @brief Sleeptimer expiry: re-arm a periodic timer, then run the callback
+ */
+static void timer_event_handler(void *context)
+{
+  sl_sleeptimer_timer_handle_t *handle = context;
+
+  if (handle->timeout_periodic != 0) {
+    // Next period counts from this expiry, not from when it ran
+    uint64_t dueTick = handle->event.dueUs * SLEEPTIMER_FREQUENCY / 1000000u;
+    sim_event_schedule_at(&handle->event, tick_to_us_ceil(dueTick + handle->timeout_periodic));
+  }
+
+  handle->callback(handle, handle->callback_data);
+}
+
+static uint64_t host_ns(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t tick_now(void)
+{
+  return nowUs * SLEEPTIMER_FREQUENCY / 1000000u;
+}
+
+/**
+ * @brief First microsecond at which the tick counter reads @p tick
+ */
+static uint64_t tick_to_us_ceil(uint64_t tick)
+{
+  return (tick * 1000000u + SLEEPTIMER_FREQUENCY - 1) / SLEEPTIMER_FREQUENCY;
+}
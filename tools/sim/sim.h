@@ -0,0 +1,339 @@
+/**
+ * @file sim.h
+ * @brief Host simulation harness
+ *
+ * Runs the firmware in src/ on the host against the stub headers in
+ * tools/sim/stubs. Hardware and Zigbee stack behaviour are events on a
+ * discrete virtual clock, so time jumps straight to the next thing that
+ * happens and months of operation simulate in seconds. It is a tool for
+ * looking at wake counts, awake time and what the device reports - not a
+ * test suite and not a timing-accurate emulator: CPU time is charged from
+ * the cost model below, not measured.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "sim_event.h"
+#include "sl_cli.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define SIM_DEFAULT_DAYS            30
+
+// EM0 cost model (us), charged on the virtual clock
+#define SIM_WAKE_EM0_US             300     // EM2 exit, clock restore, stack dispatch
+#define SIM_TICK_EM0_US             30      // One emberAfMainTickCallback() pass
+#define SIM_POLL_EM0_US             2500    // Data request, MAC ACK, RX window
+#define SIM_TX_EM0_US               4000    // CSMA, frame, MAC ACK wait
+
+// Radio frames on air (bytes incl. PHY header) and 250 kbit/s airtime
+#define SIM_POLL_TX_BYTES           18      // MAC data request
+#define SIM_POLL_RX_BYTES           11      // MAC ACK, frame pending clear
+#define SIM_REPORT_TX_BYTES         62      // Secured NWK/APS + ZCL attribute report
+#define SIM_RESPONSE_TX_BYTES       56      // Secured ZCL response
+#define SIM_US_PER_BYTE             32
+
+// Stack timing
+#define SIM_JOIN_MS                 4000    // Steering: scan, associate, key exchange
+#define SIM_LEAVE_MS                100
+#define SIM_NETWORK_UP_MS           50      // Network resume after boot when joined
+#define SIM_LONG_POLL_MS            7500    // Idle poll when no fast poll is requested
+
+// Battery seen by the ADC (2xAA alkaline, mid life)
+#define SIM_BATTERY_MV              2900
+
+// Attribute history entries kept in memory (oldest dropped beyond this)
+#define SIM_HISTORY_MAX             (1u << 20)
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  SIM_MODE_EM0,
+  SIM_MODE_EM1,
+  SIM_MODE_EM2,
+  SIM_MODE_COUNT
+} SimMode_t;
+
+typedef struct {
+  uint32_t wakeEm0Us;
+  uint32_t tickEm0Us;
+  uint32_t pollEm0Us;
+  uint32_t txEm0Us;
+  uint32_t longPollMs;
+  uint32_t joinMs;
+  uint16_t batteryMv;
+  double adcNoiseLsb;                       // Per-conversion noise, 12-bit LSB RMS
+  bool startJoined;
+  bool sensorAttached;
+  bool verbose;
+} SimConfig_t;
+
+typedef struct {
+  uint64_t residencyUs[SIM_MODE_COUNT];
+  uint32_t wakes;                           // EM2 -> EM0
+  uint32_t wakesBySource[SIM_SOURCE_COUNT];
+  uint32_t eventsBySource[SIM_SOURCE_COUNT];
+  uint32_t ticks;                           // Main-loop passes
+  uint64_t tickHostNs;                      // Host time in emberAfMainTickCallback()
+  uint32_t stackEvents;                     // sl_zigbee_event handlers run
+} SimStats_t;
+
+typedef struct {
+  uint32_t polls;
+  uint32_t reports;
+  uint32_t responses;
+  uint32_t txBytes;
+  uint32_t rxBytes;
+  uint64_t txAirUs;
+  uint64_t rxAirUs;
+  uint32_t joins;
+  uint32_t leaves;
+} SimRadioStats_t;
+
+typedef struct {
+  uint64_t timeUs;
+  uint16_t clusterId;
+  uint16_t attributeId;
+  uint16_t manufacturerCode;                // 0 for standard attributes
+  uint8_t type;
+  int64_t value;                            // Strings: length
+} SimAttributeWrite_t;
+
+typedef enum {
+  SIM_FRAME_POLL,                           // MAC data request
+  SIM_FRAME_REPORT,                         // ZCL attribute report
+  SIM_FRAME_RESPONSE,                       // ZCL response
+  SIM_FRAME_COUNT
+} SimFrame_t;
+
+// A frame handed to the radio at sim_now_us()
+typedef void (*sim_radio_trace_t)(SimFrame_t frame, uint16_t txBytes);
+
+//==============================================================================
+// Core - sim.c
+//==============================================================================
+
+SimConfig_t *sim_config(void);
+uint64_t sim_now_us(void);
+
+void sim_event_init(SimEvent_t *event, sim_event_handler_t handler, void *context,
+                    SimSource_t source);
+void sim_event_schedule_at(SimEvent_t *event, uint64_t dueUs);
+void sim_event_schedule(SimEvent_t *event, uint64_t delayUs);
+void sim_event_cancel(SimEvent_t *event);
+
+/**
+ * @brief Events waiting on the virtual clock from @p source
+ * SIM_SOURCE_TIMER counts running sleeptimers and delayed stack events:
+ * everything the application has armed to wake it later.
+ */
+uint32_t sim_event_count(SimSource_t source);
+
+/**
+ * @brief Running periodic sleeptimers (sl_sleeptimer_start_periodic_timer_ms())
+ */
+uint32_t sim_periodic_timer_count(void);
+
+/**
+ * @brief Spend CPU time in EM0, firing events that fall due meanwhile
+ */
+void sim_busy_us(uint64_t us);
+
+/**
+ * @brief Run the firmware main loop until the virtual clock reaches @p endUs
+ * Sleeps between passes in the deepest mode the power manager allows.
+ */
+void sim_run_until(uint64_t endUs);
+
+void sim_get_stats(SimStats_t *stats);
+
+/**
+ * @brief Firmware console output (AF prints, iostream) on or off
+ */
+void sim_console_enable(bool enable);
+bool sim_console_is_enabled(void);
+
+/**
+ * @brief Print a line prefixed with the virtual time
+ */
+void sim_log(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+//==============================================================================
+// Hardware - sim_hw.c
+//==============================================================================
+
+typedef struct {
+  // Return false to NACK; called when the transfer starts. Holding SDA
+  // (sim_gpio_set_input) stalls the transfer.
+  bool (*start)(void);                      // Once per transfer, optional
+  bool (*write)(const uint8_t *data, uint16_t len);
+  bool (*read)(uint8_t *data, uint16_t len);
+} SimI2cDevice_t;
+
+// Level change on a pin the MCU drives (high = true)
+typedef void (*sim_gpio_watch_t)(bool high);
+
+void sim_i2c_attach(uint8_t address, const SimI2cDevice_t *device);
+void sim_i2c_detach(uint8_t address);
+
+/**
+ * @brief Hold SCL low for @p us more (device callbacks only)
+ * The transfer completes that much later.
+ */
+void sim_i2c_stretch(uint32_t us);
+
+/**
+ * @brief Drive an input pin from outside (button, sensor output)
+ * Fires the GPIO interrupt callback when the edge is enabled.
+ */
+void sim_gpio_set_input(uint8_t port, uint8_t pin, bool high);
+
+/**
+ * @brief Call @p watch when the level on a pin changes because of the MCU
+ * One watcher per pin; NULL removes it.
+ */
+void sim_gpio_watch(uint8_t port, uint8_t pin, sim_gpio_watch_t watch);
+
+/**
+ * @brief Press the button at @p atUs for @p durationMs
+ */
+void sim_button_press(uint64_t atUs, uint32_t durationMs);
+
+/**
+ * @brief Run a firmware CLI handler with the given arguments
+ */
+void sim_cli(void (*handler)(sl_cli_command_arg_t *arguments), int argc, char **argv);
+
+//==============================================================================
+// SHT31 model - sim_sht31.c
+//==============================================================================
+
+typedef enum {
+  SIM_SHT31_SHAPE_CONSTANT,
+  SIM_SHT31_SHAPE_SINE,             // Smooth cycle, minimum at t = 0
+  SIM_SHT31_SHAPE_SQUARE,           // Steps between the extremes every half period
+  SIM_SHT31_SHAPE_RAMP              // Triangle: linear up, linear down
+} SimSht31Shape_t;
+
+typedef struct {
+  SimSht31Shape_t shape;
+  double temperatureC;              // Mean
+  double humidityRh;
+  double temperatureSwingC;         // Mean to extreme
+  double humiditySwingRh;
+  uint32_t periodS;
+  bool noise;                       // Datasheet repeatability per command
+  uint32_t seed;
+} SimSht31Signal_t;
+
+typedef enum {
+  SIM_SHT31_FAULT_NACK,             // Address NACK; param unused
+  SIM_SHT31_FAULT_STRETCH,          // Hold SCL for param us per transfer
+  SIM_SHT31_FAULT_CRC,              // Corrupt a result word; param: 1 T, 2 RH, 3 both
+  SIM_SHT31_FAULT_STUCK_BUS,        // Hold SDA mid-read until param SCL pulses
+  SIM_SHT31_FAULT_COUNT
+} SimSht31Fault_t;
+
+typedef struct {
+  uint32_t writes;                  // Temperature and humidity MeasuredValue writes
+  uint32_t invalidWrites;           // Invalid-measurement value written
+  uint32_t wrongWrites;             // Off the last result by more than the rounding
+  bool faulted;                     // An injected fault hit a transfer
+  bool recovered;                   // A result was read out after the last hit
+                                    // (and SDA is not still held)
+  double recoveryS;                 // Last hit to that result
+} SimSht31Outcome_t;
+
+// Defaults for the signal and faults
+#define SIM_SHT31_TEMPERATURE_C         21.0
+#define SIM_SHT31_HUMIDITY_RH           45.0
+#define SIM_SHT31_TEMPERATURE_SWING_C   3.0
+#define SIM_SHT31_HUMIDITY_SWING_RH     10.0
+#define SIM_SHT31_PERIOD_S              86400
+#define SIM_SHT31_SEED                  1
+#define SIM_SHT31_STRETCH_US            20000   // Past the 10 ms bus deadline
+#define SIM_SHT31_STUCK_PULSES          9       // What a real slave needs at most
+#define SIM_SHT31_FAULT_MAX             32
+
+/**
+ * @brief Attach the model (unless SimConfig_t.sensorAttached is false)
+ */
+void sim_sht31_init(void);
+
+void sim_sht31_set_signal(const SimSht31Signal_t *signal);
+void sim_sht31_get_signal(SimSht31Signal_t *signal);
+
+/**
+ * @brief Apply @p fault to @p count transfers (reads for CRC and stuck
+ * bus) starting at @p atUs
+ * @return false when the fault table is full
+ */
+bool sim_sht31_inject(SimSht31Fault_t fault, uint64_t atUs, uint32_t count, uint32_t param);
+
+/**
+ * @brief Print the model's counters and check every temperature and
+ * humidity attribute write against the value the model returned
+ */
+void sim_sht31_print_report(FILE *out);
+
+/**
+ * @brief The write check of sim_sht31_print_report() and fault recovery,
+ * for scripted checks
+ */
+void sim_sht31_get_outcome(SimSht31Outcome_t *outcome);
+
+//==============================================================================
+// Zigbee stack - sim_stack.c
+//==============================================================================
+
+void sim_stack_init(void);
+
+/**
+ * @brief Run the framework's init callbacks (cluster inits, then main init)
+ * Call after sim_stack_init() and the hardware models.
+ */
+void sim_stack_boot(void);
+
+/**
+ * @brief Run the stack events that were due when the pass started
+ * @return Handlers run
+ */
+uint32_t sim_stack_run_events(void);
+
+/**
+ * @brief Check for due stack events (the stack does not sleep then)
+ */
+bool sim_stack_events_pending(void);
+
+/**
+ * @brief Call @p trace for every frame the device transmits; NULL stops it
+ */
+void sim_stack_set_radio_trace(sim_radio_trace_t trace);
+
+/**
+ * @brief Change a reporting configuration entry (before the network is up)
+ * @return false if the attribute is not in the reporting table
+ */
+bool sim_stack_set_reporting(uint16_t clusterId, uint16_t attributeId, uint32_t minIntervalS,
+                             uint32_t maxIntervalS, int64_t reportableChange);
+
+void sim_stack_get_radio_stats(SimRadioStats_t *stats);
+
+uint32_t sim_stack_get_history_count(void);
+const SimAttributeWrite_t *sim_stack_get_history(uint32_t index);
+uint32_t sim_stack_get_history_dropped(void);
+
+/**
+ * @brief Print one line per attribute: writes, value changes, reports, last value
+ */
+void sim_stack_print_attributes(FILE *out);
+
+#endif // SIM_H
@@ -0,0 +1,39 @@
+/**
+ * @file sim_event.h
+ * @brief Host simulation: events on the virtual clock
+ *
+ * Everything that happens "later" - sleeptimer expiries, I2C and ADC
+ * completions, radio activity, scenario steps - is an event. Separate from
+ * sim.h so the stub sl_sleeptimer.h can embed one in each timer handle.
+ */
+
+#ifndef SIM_EVENT_H
+#define SIM_EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Who an event belongs to; an EM2 wake is charged to the first event fired
+typedef enum {
+  SIM_SOURCE_TIMER,         // Application sleeptimer
+  SIM_SOURCE_I2C,           // I2C transfer completion
+  SIM_SOURCE_ADC,           // ADC conversion completion
+  SIM_SOURCE_GPIO,          // Pin edge (button, sensor ALERT)
+  SIM_SOURCE_STACK,         // Zigbee stack: polls, reports, join, leave
+  SIM_SOURCE_DEVICE,        // Inside a bus device model; never wakes the MCU
+  SIM_SOURCE_COUNT
+} SimSource_t;
+
+typedef void (*sim_event_handler_t)(void *context);
+
+typedef struct SimEvent {
+  struct SimEvent *next;
+  uint64_t dueUs;
+  uint64_t order;           // FIFO among events due at the same time
+  sim_event_handler_t handler;
+  void *context;
+  SimSource_t source;
+  bool scheduled;
+} SimEvent_t;
+
+#endif // SIM_EVENT_H
@@ -0,0 +1,584 @@
+/**
+ * @file sim_hw.c
+ * @brief Host simulation: emlib peripherals (GPIO, I2C, ADC, CMU, NVIC) and CLI
+ *
+ * Peripherals complete on the virtual clock and call the firmware's
+ * interrupt handlers, like the hardware would.
+ */
+
+#include "sim.h"
+#include "button.h"
+#include "i2c_bus.h"
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_i2c.h"
+#include "em_adc.h"
+#include "gpiointerrupt.h"
+#include <math.h>
+#include <stdlib.h>
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+#define GPIO_PORT_COUNT     6
+#define GPIO_PIN_COUNT      16
+
+#define CORE_CLOCK_HZ       38400000u
+
+// START + STOP and bus turnaround, on top of 9 clocks per byte
+#define I2C_FRAME_OVERHEAD_BITS     4
+
+// ADC: warm-up, then (acquisition + 13 conversion) ADC clocks per sample
+#define ADC_CLOCK_HZ        1000000u
+#define ADC_WARMUP_US       5
+#define ADC_NOISE_SEED      1
+
+static I2C_TypeDef i2c0Registers;
+static ADC_TypeDef adc0Registers;
+static DWT_Type dwtRegisters;
+static CoreDebug_Type coreDebugRegisters;
+
+I2C_TypeDef *const I2C0 = &i2c0Registers;
+ADC_TypeDef *const ADC0 = &adc0Registers;
+DWT_Type *const DWT = &dwtRegisters;
+CoreDebug_Type *const CoreDebug = &coreDebugRegisters;
+
+static bool irqEnabled[32];
+
+// GPIO
+typedef struct {
+  GPIO_Mode_TypeDef mode;
+  bool out;
+  bool driven;              // Level forced from outside the MCU
+  bool drivenHigh;
+  sim_gpio_watch_t watch;   // Told when the MCU changes its output
+} PinState_t;
+
+typedef struct {
+  GPIO_Port_TypeDef port;
+  uint8_t pin;
+  bool rising;
+  bool falling;
+  bool enabled;
+  GPIOINT_IrqCallbackPtr_t callback;
+} ExtInt_t;
+
+static PinState_t pins[GPIO_PORT_COUNT][GPIO_PIN_COUNT];
+static ExtInt_t extInts[GPIO_PIN_COUNT];
+
+// I2C
+static const SimI2cDevice_t *i2cDevices[128];
+static uint32_t i2cFrequency = I2C_FREQ_STANDARD_MAX;
+static I2C_TransferReturn_TypeDef i2cResult = i2cTransferDone;
+static uint64_t i2cStretchUs = 0;
+static SimEvent_t i2cDoneEvent;
+
+// ADC
+static uint32_t adcOvsSamples = 2;         // Per oversampled result
+static uint32_t adcSamples = 1;
+static uint32_t adcAcqCycles = 1;
+static bool adcOversampled = false;
+static uint64_t adcRngState = ADC_NOISE_SEED;
+static SimEvent_t adcDoneEvent;
+
+typedef struct {
+  SimEvent_t press;
+  SimEvent_t release;
+} ButtonPress_t;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+void I2C0_IRQHandler(void);
+void ADC0_IRQHandler(void);
+
+static bool pin_level(GPIO_Port_TypeDef port, unsigned int pin);
+static void set_output(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode,
+                       bool out);
+static bool i2c_lines_high(void);
+static void i2c_done_handler(void *context);
+static void adc_done_handler(void *context);
+static double adc_gaussian(void);
+static void button_down_handler(void *context);
+static void button_up_handler(void *context);
+
+//==============================================================================
+// Public Functions - Simulation
+//==============================================================================
+
+void sim_i2c_attach(uint8_t address, const SimI2cDevice_t *device)
+{
+  i2cDevices[address & 0x7F] = device;
+}
+
+void sim_i2c_detach(uint8_t address)
+{
+  i2cDevices[address & 0x7F] = NULL;
+}
+
+void sim_i2c_stretch(uint32_t us)
+{
+  i2cStretchUs += us;
+}
+
+void sim_gpio_watch(uint8_t port, uint8_t pin, sim_gpio_watch_t watch)
+{
+  pins[port][pin].watch = watch;
+}
+
+void sim_gpio_set_input(uint8_t port, uint8_t pin, bool high)
+{
+  bool before = pin_level((GPIO_Port_TypeDef)port, pin);
+
+  pins[port][pin].driven = true;
+  pins[port][pin].drivenHigh = high;
+
+  bool after = pin_level((GPIO_Port_TypeDef)port, pin);
+  ExtInt_t *ext = &extInts[pin];
+
+  if (before == after || !ext->enabled || ext->port != port || ext->pin != pin
+      || ext->callback == NULL) {
+    return;
+  }
+
+  if ((after && ext->rising) || (!after && ext->falling)) {
+    ext->callback(pin);
+  }
+}
+
+void sim_button_press(uint64_t atUs, uint32_t durationMs)
+{
+  ButtonPress_t *press = calloc(1, sizeof(*press));
+
+  sim_event_init(&press->press, button_down_handler, press, SIM_SOURCE_GPIO);
+  sim_event_init(&press->release, button_up_handler, press, SIM_SOURCE_GPIO);
+  sim_event_schedule_at(&press->press, atUs);
+  sim_event_schedule_at(&press->release, atUs + (uint64_t)durationMs * 1000u);
+}
+
+void sim_cli(void (*handler)(sl_cli_command_arg_t *arguments), int argc, char **argv)
+{
+  sl_cli_command_arg_t arguments = { .argc = argc, .argv = argv };
+
+  handler(&arguments);
+}
+
+//==============================================================================
+// Public Functions - Core and Clocks
+//==============================================================================
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  irqEnabled[irq] = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  irqEnabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+uint32_t SystemCoreClockGet(void)
+{
+  return CORE_CLOCK_HZ;
+}
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+// Vectors the firmware does not handle: the startup code's default handler
+__attribute__((weak)) void I2C0_IRQHandler(void)
+{
+}
+
+__attribute__((weak)) void ADC0_IRQHandler(void)
+{
+}
+
+//==============================================================================
+// Public Functions - GPIO
+//==============================================================================
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                     GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  set_output(port, pin, mode, out != 0);
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  return pin_level(port, pin) ? 1 : 0;
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  set_output(port, pin, pins[port][pin].mode, true);
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  set_output(port, pin, pins[port][pin].mode, false);
+}
+
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                       bool risingEdge, bool fallingEdge, bool enable)
+{
+  ExtInt_t *ext = &extInts[intNo & (GPIO_PIN_COUNT - 1)];
+
+  ext->port = port;
+  ext->pin = (uint8_t)pin;
+  ext->rising = risingEdge;
+  ext->falling = fallingEdge;
+  ext->enabled = enable;
+}
+
+void GPIOINT_Init(void)
+{
+}
+
+void GPIOINT_CallbackRegister(uint8_t intNo, GPIOINT_IrqCallbackPtr_t callbackPtr)
+{
+  extInts[intNo & (GPIO_PIN_COUNT - 1)].callback = callbackPtr;
+}
+
+void GPIOINT_CallbackUnRegister(uint8_t intNo)
+{
+  extInts[intNo & (GPIO_PIN_COUNT - 1)].callback = NULL;
+}
+
+//==============================================================================
+// Public Functions - I2C
+//==============================================================================
+
+void I2C_Init(I2C_TypeDef *i2c, const I2C_Init_TypeDef *init)
+{
+  i2cFrequency = (init->freq != 0) ? init->freq : I2C_FREQ_STANDARD_MAX;
+
+  // Reset drops whatever transfer was in flight
+  sim_event_cancel(&i2cDoneEvent);
+  i2c->STATE = 0;
+  i2c->CTRL = init->enable ? 1 : 0;
+}
+
+void I2C_Enable(I2C_TypeDef *i2c, bool enable)
+{
+  i2c->CTRL = enable ? 1 : 0;
+}
+
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq)
+{
+  const SimI2cDevice_t *device = i2cDevices[(seq->addr >> 1) & 0x7F];
+  uint32_t bytes = 1;                           // Address byte
+  bool linesFree = i2c_lines_high();
+
+  i2cResult = i2cTransferNack;
+  i2cStretchUs = 0;
+
+  if (device != NULL && linesFree && (device->start == NULL || device->start())) {
+    switch (seq->flags) {
+      case I2C_FLAG_WRITE:
+        if (device->write(seq->buf[0].data, seq->buf[0].len)) {
+          bytes += seq->buf[0].len;
+          i2cResult = i2cTransferDone;
+        }
+        break;
+
+      case I2C_FLAG_READ:
+        if (device->read(seq->buf[0].data, seq->buf[0].len)) {
+          bytes += seq->buf[0].len;
+          i2cResult = i2cTransferDone;
+        }
+        break;
+
+      case I2C_FLAG_WRITE_READ:
+        if (device->write(seq->buf[0].data, seq->buf[0].len)) {
+          bytes += seq->buf[0].len + 1;         // Repeated start + address
+          if (device->read(seq->buf[1].data, seq->buf[1].len)) {
+            bytes += seq->buf[1].len;
+            i2cResult = i2cTransferDone;
+          }
+        }
+        break;
+
+      default:
+        return i2cTransferUsageFault;
+    }
+  }
+
+  i2c->STATE = I2C_STATE_BUSY;
+
+  // A line held low (before or during the transfer) stalls the master
+  // until the caller gives up; nothing completes
+  if (!linesFree || !i2c_lines_high()) {
+    sim_event_cancel(&i2cDoneEvent);
+    return i2cTransferInProgress;
+  }
+
+  sim_event_init(&i2cDoneEvent, i2c_done_handler, NULL, SIM_SOURCE_I2C);
+  sim_event_schedule(&i2cDoneEvent,
+                     ((uint64_t)(bytes * 9 + I2C_FRAME_OVERHEAD_BITS) * 1000000u) / i2cFrequency
+                     + i2cStretchUs);
+
+  return i2cTransferInProgress;
+}
+
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c)
+{
+  if (!(i2c->STATE & I2C_STATE_BUSY)) {
+    return i2cResult;
+  }
+  if (!i2cDoneEvent.scheduled) {
+    return i2cTransferInProgress;           // Stalled on a held line
+  }
+
+  // Polled transfer: the core spins until the bus is done
+  sim_busy_us(i2cDoneEvent.dueUs - sim_now_us());
+  return i2cResult;
+}
+
+void I2C_IntEnable(I2C_TypeDef *i2c, uint32_t flags)
+{
+  i2c->IEN |= flags;
+}
+
+void I2C_IntDisable(I2C_TypeDef *i2c, uint32_t flags)
+{
+  i2c->IEN &= ~flags;
+}
+
+void I2C_IntClear(I2C_TypeDef *i2c, uint32_t flags)
+{
+  i2c->IF &= ~flags;
+}
+
+//==============================================================================
+// Public Functions - ADC
+//==============================================================================
+
+void ADC_Init(ADC_TypeDef *adc, const ADC_Init_TypeDef *init)
+{
+  (void)adc;
+  adcOvsSamples = 2u << init->ovsRateSel;
+}
+
+void ADC_InitSingle(ADC_TypeDef *adc, const ADC_InitSingle_TypeDef *init)
+{
+  (void)adc;
+  adcOversampled = (init->resolution == adcResOVS);
+  adcSamples = adcOversampled ? adcOvsSamples : 1;
+  adcAcqCycles = 1u << init->acqTime;
+}
+
+void ADC_Start(ADC_TypeDef *adc, ADC_Start_TypeDef cmd)
+{
+  (void)cmd;
+
+  adc->STATUS |= ADC_STATUS_SINGLEACT;
+  sim_event_init(&adcDoneEvent, adc_done_handler, NULL, SIM_SOURCE_ADC);
+  uint64_t conversionUs = ADC_WARMUP_US
+                          + ((uint64_t)adcSamples * (adcAcqCycles + 13) * 1000000u)
+                            / ADC_CLOCK_HZ;
+  sim_event_schedule(&adcDoneEvent, conversionUs);
+
+  if (!(adc->IEN & ADC_IEN_SINGLE)) {
+    // Polled conversion: the core spins on SINGLEACT
+    sim_busy_us(conversionUs);
+  }
+}
+
+uint32_t ADC_DataSingleGet(ADC_TypeDef *adc)
+{
+  return adc->SINGLEDATA;
+}
+
+uint8_t ADC_TimebaseCalc(uint32_t hfperFreq)
+{
+  (void)hfperFreq;
+  return 38;
+}
+
+uint8_t ADC_PrescaleCalc(uint32_t adcFreq, uint32_t hfperFreq)
+{
+  (void)adcFreq;
+  (void)hfperFreq;
+  return 37;
+}
+
+void ADC_IntEnable(ADC_TypeDef *adc, uint32_t flags)
+{
+  adc->IEN |= flags;
+}
+
+void ADC_IntDisable(ADC_TypeDef *adc, uint32_t flags)
+{
+  adc->IEN &= ~flags;
+}
+
+void ADC_IntClear(ADC_TypeDef *adc, uint32_t flags)
+{
+  adc->IF &= ~flags;
+}
+
+//==============================================================================
+// Public Functions - CLI
+//==============================================================================
+
+int sl_cli_get_argument_count(sl_cli_command_arg_t *arguments)
+{
+  return arguments->argc;
+}
+
+uint8_t sl_cli_get_argument_uint8(sl_cli_command_arg_t *arguments, int index)
+{
+  return (uint8_t)sl_cli_get_argument_uint32(arguments, index);
+}
+
+uint16_t sl_cli_get_argument_uint16(sl_cli_command_arg_t *arguments, int index)
+{
+  return (uint16_t)sl_cli_get_argument_uint32(arguments, index);
+}
+
+uint32_t sl_cli_get_argument_uint32(sl_cli_command_arg_t *arguments, int index)
+{
+  return (index < arguments->argc) ? (uint32_t)strtoul(arguments->argv[index], NULL, 0) : 0;
+}
+
+char *sl_cli_get_argument_string(sl_cli_command_arg_t *arguments, int index)
+{
+  return (index < arguments->argc) ? arguments->argv[index] : NULL;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Level seen on a pin: outside driver, own output, or pull-up
+ */
+static bool pin_level(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  const PinState_t *state = &pins[port][pin];
+
+  switch (state->mode) {
+    case gpioModeDisabled:
+      return false;
+
+    case gpioModePushPull:
+      return state->out;
+
+    case gpioModeWiredAnd:
+    case gpioModeWiredAndFilter:
+    case gpioModeWiredAndPullUp:
+    case gpioModeWiredAndPullUpFilter:
+      // Open drain: low if either side pulls low
+      return state->out && (!state->driven || state->drivenHigh);
+
+    default:
+      // Inputs idle high (pull-ups on the button and the I2C lines)
+      return !state->driven || state->drivenHigh;
+  }
+}
+
+/**
+ * @brief Set a pin's mode and output, telling its watcher about a new level
+ */
+static void set_output(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode,
+                       bool out)
+{
+  PinState_t *state = &pins[port][pin];
+  bool before = pin_level(port, pin);
+
+  state->mode = mode;
+  state->out = out;
+
+  if (state->watch != NULL && pin_level(port, pin) != before) {
+    state->watch(!before);
+  }
+}
+
+/**
+ * @brief Both I2C lines idle high (nobody holding the bus)
+ */
+static bool i2c_lines_high(void)
+{
+  return pin_level(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN)
+         && pin_level(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN);
+}
+
+static void i2c_done_handler(void *context)
+{
+  (void)context;
+
+  I2C0->STATE &= ~I2C_STATE_BUSY;
+  I2C0->IF |= (i2cResult == i2cTransferNack) ? I2C_IF_NACK : I2C_IF_MSTOP;
+
+  if (irqEnabled[I2C0_IRQn] && (I2C0->IEN & I2C0->IF)) {
+    I2C0_IRQHandler();
+  }
+}
+
+static void adc_done_handler(void *context)
+{
+  (void)context;
+
+  // AVDD/3 against the 1.25 V reference. Each 12-bit conversion carries
+  // its own noise; an oversampled result is their average on a 16-bit scale.
+  const SimConfig_t *config = sim_config();
+  uint32_t fullScale = adcOversampled ? 65536u : 4096u;
+  double ideal = config->batteryMv * 4096.0 / 3750.0;
+  double sum = 0.0;
+
+  for (uint32_t i = 0; i < adcSamples; i++) {
+    double code = round(ideal + config->adcNoiseLsb * adc_gaussian());
+    sum += (code < 0.0) ? 0.0 : (code > 4095.0) ? 4095.0 : code;
+  }
+
+  uint32_t raw = (uint32_t)lround(sum * (fullScale / 4096u) / adcSamples);
+
+  ADC0->SINGLEDATA = (raw >= fullScale) ? fullScale - 1 : raw;
+  ADC0->STATUS &= ~ADC_STATUS_SINGLEACT;
+  ADC0->IF |= ADC_IF_SINGLE;
+
+  if (irqEnabled[ADC0_IRQn] && (ADC0->IEN & ADC_IEN_SINGLE)) {
+    ADC0_IRQHandler();
+  }
+}
+
+/**
+ * @brief Standard normal deviate (xorshift64*, Box-Muller), repeatable
+ */
+static double adc_gaussian(void)
+{
+  double u[2];
+
+  for (int i = 0; i < 2; i++) {
+    adcRngState ^= adcRngState >> 12;
+    adcRngState ^= adcRngState << 25;
+    adcRngState ^= adcRngState >> 27;
+    u[i] = ((adcRngState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  return sqrt(-2.0 * log(u[0] + 1e-300)) * cos(2.0 * M_PI * u[1]);
+}
+
+static void button_down_handler(void *context)
+{
+  (void)context;
+  sim_gpio_set_input(BUTTON_PORT, BUTTON_PIN, false);
+}
+
+static void button_up_handler(void *context)
+{
+  free(context);
+  sim_gpio_set_input(BUTTON_PORT, BUTTON_PIN, true);
+}
@@ -0,0 +1,542 @@
+/**
+ * @file sim_main.c
+ * @brief Host simulation: command line and run report
+ *
+ * Usage: efr32mg1-sed-sim [options], see usage() or --help.
+ */
+
+#include "sim.h"
+#include "af.h"
+#include "app.h"
+#include "battery.h"
+#include "energy.h"
+#include "sht31.h"
+#include <getopt.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define SIM_PRESS_MAX           16
+#define SIM_LAST_WRITES         10
+
+//==============================================================================
+// Types
+//==============================================================================
+
+// Long-only options
+enum {
+  OPTION_SHAPE = 256,
+  OPTION_TEMP,
+  OPTION_HUM,
+  OPTION_TEMP_SWING,
+  OPTION_HUM_SWING,
+  OPTION_PERIOD,
+  OPTION_NO_NOISE,
+  OPTION_SEED,
+  OPTION_FAULT,
+  OPTION_REPORTING,
+  OPTION_METRICS,
+  OPTION_ADC_NOISE
+};
+
+typedef struct {
+  const char *name;
+  uint16_t clusterId;
+  uint16_t attributeId;
+} ReportingName_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static const char *sourceNames[SIM_SOURCE_COUNT] = {
+  "timer", "i2c", "adc", "gpio", "stack", "device"
+};
+
+static const char *modeNames[SIM_MODE_COUNT] = {
+  "EM0", "EM1", "EM2"
+};
+
+static const char *shapeNames[] = {
+  "const", "sine", "square", "ramp"
+};
+
+static const char *faultNames[SIM_SHT31_FAULT_COUNT] = {
+  "nack", "stretch", "crc", "stuck"
+};
+
+static const ReportingName_t reportingNames[] = {
+  { "temp", ZCL_TEMP_MEASUREMENT_CLUSTER_ID, ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID },
+  { "hum", ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID,
+    ZCL_RELATIVE_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID },
+  { "battery", ZCL_POWER_CONFIG_CLUSTER_ID, ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID }
+};
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void usage(const char *program);
+static bool parse_press(const char *text, uint64_t *atUs, uint32_t *durationMs);
+static bool parse_shape(const char *text, SimSht31Shape_t *shape);
+static bool parse_fault(const char *text);
+static bool parse_reporting(const char *text);
+/**
+ * @brief Parse and apply "KIND:MIN:MAX:CHANGE"
+ */
+static bool parse_reporting(const char *text)
+{
+  const char *colon = strchr(text, ':');
+  unsigned long minS;
+  unsigned long maxS;
+  long change;
+  int used = 0;
+
+  if (colon == NULL
+      || sscanf(colon + 1, "%lu:%lu:%ld%n", &minS, &maxS, &change, &used) != 3
+      || colon[1 + used] != '\0') {
+    return false;
+  }
+
+  for (size_t i = 0; i < sizeof(reportingNames) / sizeof(reportingNames[0]); i++) {
+    if (strlen(reportingNames[i].name) == (size_t)(colon - text)
+        && strncmp(text, reportingNames[i].name, colon - text) == 0) {
+      return sim_stack_set_reporting(reportingNames[i].clusterId,
+                                     reportingNames[i].attributeId,
+                                     (uint32_t)minS, (uint32_t)maxS, change);
+    }
+  }
+
+  return false;
+}
+
+static void print_report(uint64_t durationUs, double wallS);
+static bool write_history(const char *path);
+static bool write_metrics(const char *path, uint64_t durationUs);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(int argc, char **argv)
+{
+  static const struct option options[] = {
+    { "days",         required_argument, NULL, 'd' },
+    { "hours",        required_argument, NULL, 'H' },
+    { "seconds",      required_argument, NULL, 's' },
+    { "unjoined",     no_argument,       NULL, 'u' },
+    { "press",        required_argument, NULL, 'p' },
+    { "no-sensor",    no_argument,       NULL, 'n' },
+    { "battery-mv",   required_argument, NULL, 'b' },
+    { "adc-noise",    required_argument, NULL, OPTION_ADC_NOISE },
+    { "wake-us",      required_argument, NULL, 'w' },
+    { "tick-us",      required_argument, NULL, 't' },
+    { "long-poll-ms", required_argument, NULL, 'l' },
+    { "history",      required_argument, NULL, 'o' },
+    { "shape",        required_argument, NULL, OPTION_SHAPE },
+    { "temp",         required_argument, NULL, OPTION_TEMP },
+    { "hum",          required_argument, NULL, OPTION_HUM },
+    { "temp-swing",   required_argument, NULL, OPTION_TEMP_SWING },
+    { "hum-swing",    required_argument, NULL, OPTION_HUM_SWING },
+    { "period-s",     required_argument, NULL, OPTION_PERIOD },
+    { "no-noise",     no_argument,       NULL, OPTION_NO_NOISE },
+    { "seed",         required_argument, NULL, OPTION_SEED },
+    { "fault",        required_argument, NULL, OPTION_FAULT },
+    { "reporting",    required_argument, NULL, OPTION_REPORTING },
+    { "metrics",      required_argument, NULL, OPTION_METRICS },
+    { "verbose",      no_argument,       NULL, 'v' },
+    { "help",         no_argument,       NULL, 'h' },
+    { NULL, 0, NULL, 0 }
+  };
+
+  SimConfig_t *config = sim_config();
+  uint64_t durationUs = (uint64_t)SIM_DEFAULT_DAYS * 86400u * 1000000u;
+  const char *historyPath = NULL;
+  const char *metricsPath = NULL;
+  uint64_t pressAtUs[SIM_PRESS_MAX];
+  uint32_t pressMs[SIM_PRESS_MAX];
+  int pressCount = 0;
+  SimSht31Signal_t signal;
+  int option;
+
+  sim_sht31_get_signal(&signal);
+
+  while ((option = getopt_long(argc, argv, "d:H:s:up:nb:w:t:l:o:vh", options, NULL)) != -1) {
+    switch (option) {
+      case 'd':
+        durationUs = (uint64_t)(strtod(optarg, NULL) * 86400e6);
+        break;
+      case 'H':
+        durationUs = (uint64_t)(strtod(optarg, NULL) * 3600e6);
+        break;
+      case 's':
+        durationUs = (uint64_t)(strtod(optarg, NULL) * 1e6);
+        break;
+      case 'u':
+        config->startJoined = false;
+        break;
+      case 'p':
+        if (pressCount == SIM_PRESS_MAX
+            || !parse_press(optarg, &pressAtUs[pressCount], &pressMs[pressCount])) {
+          usage(argv[0]);
+          return 2;
+        }
+        pressCount++;
+        break;
+      case 'n':
+        config->sensorAttached = false;
+        break;
+      case 'b':
+        config->batteryMv = (uint16_t)strtoul(optarg, NULL, 0);
+        break;
+      case OPTION_ADC_NOISE:
+        config->adcNoiseLsb = strtod(optarg, NULL);
+        break;
+      case 'w':
+        config->wakeEm0Us = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        config->tickEm0Us = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'l':
+        config->longPollMs = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case 'o':
+        historyPath = optarg;
+        break;
+      case OPTION_SHAPE:
+        if (!parse_shape(optarg, &signal.shape)) {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case OPTION_TEMP:
+        signal.temperatureC = strtod(optarg, NULL);
+        break;
+      case OPTION_HUM:
+        signal.humidityRh = strtod(optarg, NULL);
+        break;
+      case OPTION_TEMP_SWING:
+        signal.temperatureSwingC = strtod(optarg, NULL);
+        break;
+      case OPTION_HUM_SWING:
+        signal.humiditySwingRh = strtod(optarg, NULL);
+        break;
+      case OPTION_PERIOD:
+        signal.periodS = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case OPTION_NO_NOISE:
+        signal.noise = false;
+        break;
+      case OPTION_SEED:
+        signal.seed = (uint32_t)strtoul(optarg, NULL, 0);
+        break;
+      case OPTION_FAULT:
+        if (!parse_fault(optarg)) {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case OPTION_REPORTING:
+        if (!parse_reporting(optarg)) {
+          usage(argv[0]);
+          return 2;
+        }
+        break;
+      case OPTION_METRICS:
+        metricsPath = optarg;
+        break;
+      case 'v':
+        config->verbose = true;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 2;
+    }
+  }
+
+  sim_console_enable(config->verbose);
+
+  sim_stack_init();
+  sim_sht31_set_signal(&signal);
+  sim_sht31_init();
+  for (int i = 0; i < pressCount; i++) {
+    sim_button_press(pressAtUs[i], pressMs[i]);
+  }
+
+  sim_stack_boot();
+
+  clock_t start = clock();
+  sim_run_until(durationUs);
+  double wallS = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  print_report(durationUs, wallS);
+
+  if (historyPath != NULL && !write_history(historyPath)) {
+    fprintf(stderr, "sim: cannot write %s\n", historyPath);
+    return 1;
+  }
+
+  if (metricsPath != NULL && !write_metrics(metricsPath, durationUs)) {
+    fprintf(stderr, "sim: cannot write %s\n", metricsPath);
+    return 1;
+  }
+
+  return 0;
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void usage(const char *program)
+{
+  printf("Usage: %s [options]\n"
+         "  -d, --days N          Simulated time in days (default %d)\n"
+         "  -H, --hours N         Simulated time in hours\n"
+         "  -s, --seconds N       Simulated time in seconds\n"
+         "  -u, --unjoined        Boot without a network (join with --press)\n"
+         "  -p, --press S[:MS]    Press the button at S seconds for MS ms (default 100)\n"
+         "  -n, --no-sensor       No SHT31 on the bus\n"
+         "  -b, --battery-mv MV   Battery voltage seen by the ADC (default %d)\n"
+         "      --adc-noise LSB   ADC noise per conversion, 12-bit LSB RMS (default 0)\n"
+         "  -w, --wake-us US      EM0 cost of an EM2 wake (default %d)\n"
+         "  -t, --tick-us US      EM0 cost of a main-loop pass (default %d)\n"
+         "  -l, --long-poll-ms MS Long poll interval (default %d)\n"
+         "  -o, --history FILE    Write every attribute write to FILE (CSV)\n"
+         "  -v, --verbose         Show the firmware console\n"
+         "      --reporting KIND:MIN:MAX:CHANGE\n"
+         "                        Reporting configuration for temp, hum or battery\n"
+         "                        (intervals in s, change in attribute units)\n"
+         "      --metrics FILE    Write the per-hour figures to FILE (CSV, one row)\n"
+         "SHT31 model:\n"
+         "      --shape SHAPE     const, sine, square or ramp (default sine)\n"
+         "      --temp C          Mean temperature (default %.1f)\n"
+         "      --hum RH          Mean humidity (default %.1f)\n"
+         "      --temp-swing C    Mean to extreme (default %.1f)\n"
+         "      --hum-swing RH    Mean to extreme (default %.1f)\n"
+         "      --period-s S      Signal period (default %d)\n"
+         "      --no-noise        No repeatability noise\n"
+         "      --seed N          Noise seed (default %d)\n"
+         "      --fault KIND@S[:COUNT[:PARAM]]\n"
+         "                        From S seconds on, hit COUNT transfers (default 1):\n"
+         "                        nack; stretch (PARAM us, default %d); crc (PARAM\n"
+         "                        1 T, 2 RH, 3 both); stuck (SDA held until PARAM\n"
+         "                        SCL pulses, default %d). Repeatable.\n",
+         program, SIM_DEFAULT_DAYS, SIM_BATTERY_MV, SIM_WAKE_EM0_US, SIM_TICK_EM0_US,
+         SIM_LONG_POLL_MS, SIM_SHT31_TEMPERATURE_C, SIM_SHT31_HUMIDITY_RH,
+         SIM_SHT31_TEMPERATURE_SWING_C, SIM_SHT31_HUMIDITY_SWING_RH, SIM_SHT31_PERIOD_S,
+         SIM_SHT31_SEED, SIM_SHT31_STRETCH_US, SIM_SHT31_STUCK_PULSES);
+}
+
+/**
+ * @brief Parse "S[:MS]" (press time in seconds, duration in ms)
+ */
+static bool parse_press(const char *text, uint64_t *atUs, uint32_t *durationMs)
+{
+  char *end;
+  double atS = strtod(text, &end);
+
+  if (end == text || atS < 0) {
+    return false;
+  }
+
+  *atUs = (uint64_t)(atS * 1e6);
+  *durationMs = 100;
+
+  if (*end == ':') {
+    *durationMs = (uint32_t)strtoul(end + 1, &end, 0);
+  }
+
+  return (*end == '\0');
+}
+
+static bool parse_shape(const char *text, SimSht31Shape_t *shape)
+{
+  for (size_t i = 0; i < sizeof(shapeNames) / sizeof(shapeNames[0]); i++) {
+    if (strcmp(text, shapeNames[i]) == 0) {
+      *shape = (SimSht31Shape_t)i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Parse and inject "KIND@S[:COUNT[:PARAM]]"
+ */
+static bool parse_fault(const char *text)
+{
+  const char *at = strchr(text, '@');
+
+  if (at == NULL) {
+    return false;
+  }
+
+  for (int kind = 0; kind < SIM_SHT31_FAULT_COUNT; kind++) {
+    if (strlen(faultNames[kind]) != (size_t)(at - text)
+        || strncmp(text, faultNames[kind], at - text) != 0) {
+      continue;
+    }
+
+    char *end;
+    double atS = strtod(at + 1, &end);
+    uint32_t count = 1;
+    uint32_t param = 0;
+
+    if (end == at + 1 || atS < 0) {
+      return false;
+    }
+    if (*end == ':') {
+      count = (uint32_t)strtoul(end + 1, &end, 0);
+    }
+    if (*end == ':') {
+      param = (uint32_t)strtoul(end + 1, &end, 0);
+    }
+
+    return (*end == '\0')
+           && sim_sht31_inject((SimSht31Fault_t)kind, (uint64_t)(atS * 1e6), count, param);
+  }
+
+  return false;
+}
+
+static void print_report(uint64_t durationUs, double wallS)
+{
+  SimStats_t stats;
+  SimRadioStats_t radio;
+  double hours = (double)durationUs / 3600e6;
+  uint64_t awakeUs;
+
+  sim_get_stats(&stats);
+  sim_stack_get_radio_stats(&radio);
+  awakeUs = stats.residencyUs[SIM_MODE_EM0] + stats.residencyUs[SIM_MODE_EM1];
+
+  printf("==========================================\n");
+  printf("  Simulation report\n");
+  printf("==========================================\n");
+  printf("Simulated:      %.3f h (%.2f days) in %.2f s wall\n", hours, hours / 24.0, wallS);
+
+  printf("\nWakes (EM2 -> EM0): %u, %.1f/h\n", stats.wakes, stats.wakes / hours);
+  for (int i = 0; i < SIM_SOURCE_COUNT; i++) {
+    printf("  %-6s %10u wakes %10u events\n", sourceNames[i], stats.wakesBySource[i],
+           stats.eventsBySource[i]);
+  }
+  printf("Main-loop passes: %u, app tick %.1f ns/pass (host), stack events %u\n",
+         stats.ticks, stats.ticks > 0 ? (double)stats.tickHostNs / stats.ticks : 0.0,
+         stats.stackEvents);
+
+  printf("\nResidency:\n");
+  for (int i = 0; i < SIM_MODE_COUNT; i++) {
+    printf("  %-4s %14.3f s %8.4f %%\n", modeNames[i], stats.residencyUs[i] / 1e6,
+           100.0 * stats.residencyUs[i] / durationUs);
+  }
+  printf("Awake (EM0+EM1): %.3f s, %.1f ms/h\n", awakeUs / 1e6, awakeUs / 1e3 / hours);
+
+  printf("\nRadio:\n");
+  printf("  polls %u, reports %u, responses %u, joins %u, leaves %u\n",
+         radio.polls, radio.reports, radio.responses, radio.joins, radio.leaves);
+  printf("  TX %u bytes (%.3f s air), RX %u bytes (%.3f s air)\n",
+         radio.txBytes, radio.txAirUs / 1e6, radio.rxBytes, radio.rxAirUs / 1e6);
+
+  printf("\nAttributes:\n");
+  sim_stack_print_attributes(stdout);
+
+  uint32_t count = sim_stack_get_history_count();
+  uint32_t first = (count > SIM_LAST_WRITES) ? count - SIM_LAST_WRITES : 0;
+
+  printf("\nAttribute writes: %u kept, %u dropped; last %u:\n",
+         count, sim_stack_get_history_dropped(), count - first);
+  for (uint32_t i = first; i < count; i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+    printf("  [%12.3f] 0x%04X/0x%04X = %lld\n", write->timeUs / 1e6, write->clusterId,
+           write->attributeId, (long long)write->value);
+  }
+
+  printf("\n");
+  sim_sht31_print_report(stdout);
+
+  if (sim_config()->verbose) {
+    // The firmware's own view of the same run
+    char *none[] = { NULL };
+    printf("\n");
+    sim_cli(cli_em_stats, 0, none);
+    sim_cli(cli_energy, 0, none);
+    sim_cli(cli_wake_sched, 0, none);
+    sim_cli(cli_deferred_work, 0, none);
+    sim_cli(cli_report_filter, 0, none);
+  }
+}
+
+static bool write_history(const char *path)
+{
+  FILE *out = fopen(path, "w");
+
+  if (out == NULL) {
+    return false;
+  }
+
+  fprintf(out, "time_s,cluster,attribute,manufacturer,type,value\n");
+  for (uint32_t i = 0; i < sim_stack_get_history_count(); i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+    fprintf(out, "%.6f,0x%04X,0x%04X,0x%04X,0x%02X,%lld\n", write->timeUs / 1e6,
+            write->clusterId, write->attributeId, write->manufacturerCode, write->type,
+            (long long)write->value);
+  }
+
+  return (fclose(out) == 0);
+}
+
+/**
+ * @brief One CSV row per run, for tools/sim/bench.sh and tools/sim/faults.sh
+ * Battery life is the firmware's own projection (energy.c) from a full
+ * battery at the average current of this run. The sensor columns are the
+ * model's write check, the driver's health at the end, and the time from
+ * the last injected fault to the next result (0 without faults, empty if
+ * none came).
+ */
+static bool write_metrics(const char *path, uint64_t durationUs)
+{
+  SimStats_t stats;
+  SimRadioStats_t radio;
+  EnergyReport_t energy;
+  SimSht31Outcome_t sensor;
+  double hours = (double)durationUs / 3600e6;
+  FILE *out = fopen(path, "w");
+
+  if (out == NULL) {
+    return false;
+  }
+
+  sim_get_stats(&stats);
+  sim_stack_get_radio_stats(&radio);
+  energy_get_report(&energy);
+  sim_sht31_get_outcome(&sensor);
+
+  uint64_t awakeUs = stats.residencyUs[SIM_MODE_EM0] + stats.residencyUs[SIM_MODE_EM1];
+  uint16_t lifeDays = energy_project_life_days(battery_get_capacity_mah(), 100);
+
+  fprintf(out, "awake_ms_h,wakes_h,tx_bytes_h,polls_h,reports_h,avg_current_ua,"
+          "battery_days,invalid_writes,wrong_writes,sensor_health,recovery_s\n");
+  fprintf(out, "%.1f,%.1f,%.1f,%.1f,%.2f,%.2f,", awakeUs / 1e3 / hours,
+          stats.wakes / hours, radio.txBytes / hours, radio.polls / hours,
+          radio.reports / hours, energy.averageCentiUa / 100.0);
+  if (lifeDays != 0xFFFF) {
+    fprintf(out, "%u", lifeDays);                   // Empty: run too short to project
+  }
+  fprintf(out, ",%u,%u,%d,", sensor.invalidWrites, sensor.wrongWrites, sht31_get_health());
+  if (!sensor.faulted || sensor.recovered) {
+    fprintf(out, "%.3f", sensor.recoveryS);
+  }
+  fprintf(out, "\n");
+
+  return (fclose(out) == 0);
+}
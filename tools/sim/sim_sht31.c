@@ -0,0 +1,949 @@
+/**
+ * @file sim_sht31.c
+ * @brief Host simulation: SHT31 on the I2C bus
+ *
+ * Behavioural model of the sensor as the driver sees it: the command set
+ * (single shot with and without clock stretching, periodic + fetch, ART,
+ * break, soft reset, heater, status, alert limits), datasheet timing, CRC
+ * on every word, the ALERT pin, and a programmable temperature/humidity
+ * signal with datasheet repeatability noise. Faults are injected per
+ * transfer: address NACK, clock stretching, a corrupted result word (its
+ * CRC no longer matches) and SDA held low after a read until enough SCL
+ * pulses arrive.
+ *
+ * Every result handed out is remembered, so the report can check the values
+ * the firmware wrote to the ZCL attributes against them.
+ */
+
+#include "sim.h"
+#include "af.h"
+#include "app.h"
+#include "em_gpio.h"
+#include "i2c_bus.h"
+#include "sensor_power.h"
+#include "sht31.h"
+#include <math.h>
+#include <stdlib.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+// Conversion time (datasheet max) per repeatability, us
+#define SIM_SHT31_CONVERSION_LOW_US     4000
+#define SIM_SHT31_CONVERSION_MEDIUM_US  6000
+#define SIM_SHT31_CONVERSION_HIGH_US    15000
+
+#define SIM_SHT31_RESET_US              1500    // Soft reset, datasheet max
+#define SIM_SHT31_POWER_UP_US           1000    // VDD to idle, datasheet max
+
+// Commands the driver does not use
+#define SIM_SHT31_CMD_STRETCH_MSB       0x2C    // Single shot, clock stretching
+#define SIM_SHT31_CMD_ART               0x2B32  // Accelerated response time, 4 Hz
+#define SIM_SHT31_CMD_HEATER_ON         0x306D
+#define SIM_SHT31_CMD_HEATER_OFF        0x3066
+#define SIM_SHT31_CMD_CLEAR_STATUS      0x3041
+#define SIM_SHT31_CMD_ALERT_READ_MSB    0xE1
+
+// Status register
+#define SIM_SHT31_STATUS_ALERT          0x8000
+#define SIM_SHT31_STATUS_HEATER         0x2000
+#define SIM_SHT31_STATUS_RH_ALERT       0x0800
+#define SIM_SHT31_STATUS_T_ALERT        0x0400
+#define SIM_SHT31_STATUS_RESET          0x0010
+#define SIM_SHT31_STATUS_COMMAND_FAILED 0x0002
+#define SIM_SHT31_STATUS_WRITE_CRC      0x0001
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  MODE_IDLE,
+  MODE_SINGLE_SHOT,         // Converting, or result waiting to be read
+  MODE_PERIODIC
+} ModelMode_t;
+
+typedef enum {
+  LIMIT_HIGH_SET,
+  LIMIT_HIGH_CLEAR,
+  LIMIT_LOW_CLEAR,
+  LIMIT_LOW_SET,
+  LIMIT_COUNT
+} AlertLimit_t;
+
+typedef struct {
+  uint16_t command;
+  uint32_t intervalUs;
+  Sht31Repeatability_t repeatability;
+} PeriodicCommand_t;
+
+typedef struct {
+  SimSht31Fault_t kind;
+  uint64_t atUs;
+  uint32_t remaining;
+  uint32_t param;
+} Fault_t;
+
+typedef struct {
+  uint64_t timeUs;          // Read out by the MCU
+  double temperatureCenti;  // Encoded in the returned raw words
+  double humidityCenti;
+} Sample_t;
+
+typedef struct {
+  uint32_t transfers;
+  uint32_t nackBusy;        // Converting or resetting
+  uint32_t nackNoData;      // Read with nothing to send
+  uint32_t nackInvalid;     // Unknown command, or not taken in this mode
+  uint32_t nackUnpowered;
+  uint32_t nackInjected;
+  uint32_t singleShots;
+  uint32_t periodicStarts;
+  uint32_t fetches;
+  uint32_t resets;
+  uint32_t breaks;
+  uint32_t alertWrites;
+  uint32_t otherCommands;   // Status, heater, alert read-back
+  uint32_t results;         // Measurements read out
+  uint32_t alertEdges;
+  uint32_t stretched;
+  uint64_t stretchUs;
+  uint32_t corrupted;
+  uint32_t stuck;
+  uint32_t released;
+  uint64_t stuckUs;
+  uint32_t faultHits;
+  uint64_t lastFaultUs;
+} ModelStats_t;
+
+typedef struct {
+  uint32_t total;
+  uint32_t invalid;
+  uint32_t wrong;
+  double worst;             // In 0.01 steps
+} WriteCheck_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static const PeriodicCommand_t periodicCommands[] = {
+  { 0x2032, 2000000, SHT31_REPEATABILITY_HIGH },
+  { 0x2024, 2000000, SHT31_REPEATABILITY_MEDIUM },
+  { 0x202F, 2000000, SHT31_REPEATABILITY_LOW },
+  { 0x2130, 1000000, SHT31_REPEATABILITY_HIGH },
+  { 0x2126, 1000000, SHT31_REPEATABILITY_MEDIUM },
+  { 0x212D, 1000000, SHT31_REPEATABILITY_LOW },
+  { 0x2236, 500000, SHT31_REPEATABILITY_HIGH },
+  { 0x2220, 500000, SHT31_REPEATABILITY_MEDIUM },
+  { 0x222B, 500000, SHT31_REPEATABILITY_LOW },
+  { 0x2334, 250000, SHT31_REPEATABILITY_HIGH },
+  { 0x2322, 250000, SHT31_REPEATABILITY_MEDIUM },
+  { 0x2329, 250000, SHT31_REPEATABILITY_LOW },
+  { 0x2737, 100000, SHT31_REPEATABILITY_HIGH },
+  { 0x2721, 100000, SHT31_REPEATABILITY_MEDIUM },
+  { 0x272A, 100000, SHT31_REPEATABILITY_LOW },
+  { SIM_SHT31_CMD_ART, 250000, SHT31_REPEATABILITY_HIGH }
+};
+
+#define PERIODIC_COMMAND_COUNT  (sizeof(periodicCommands) / sizeof(periodicCommands[0]))
+
+// Single-shot LSBs per repeatability: without, with clock stretching
+static const uint8_t singleShotLsbs[2][SHT31_REPEATABILITY_COUNT] = {
+  { SHT31_CMD_READ_LOW_LSB, SHT31_CMD_READ_MEDIUM_LSB, SHT31_CMD_READ_LSB },
+  { 0x10, 0x0D, 0x06 }
+};
+
+static const uint32_t conversionUs[SHT31_REPEATABILITY_COUNT] = {
+  SIM_SHT31_CONVERSION_LOW_US, SIM_SHT31_CONVERSION_MEDIUM_US,
+  SIM_SHT31_CONVERSION_HIGH_US
+};
+
+// Repeatability (datasheet, 3 sigma): low, medium, high
+static const double temperatureRepeatabilityC[SHT31_REPEATABILITY_COUNT] = { 0.15, 0.08, 0.04 };
+static const double humidityRepeatabilityRh[SHT31_REPEATABILITY_COUNT] = { 0.21, 0.15, 0.08 };
+
+// Alert limit LSBs: write (0x61xx), read-back (0xE1xx)
+static const uint8_t limitLsbs[2][LIMIT_COUNT] = {
+  { SHT31_CMD_ALERT_HIGH_SET_LSB, SHT31_CMD_ALERT_HIGH_CLEAR_LSB,
+    SHT31_CMD_ALERT_LOW_CLEAR_LSB, SHT31_CMD_ALERT_LOW_SET_LSB },
+  { 0x1F, 0x14, 0x09, 0x02 }
+};
+
+static SimSht31Signal_t signal = {
+  .shape = SIM_SHT31_SHAPE_SINE,
+  .temperatureC = SIM_SHT31_TEMPERATURE_C,
+  .humidityRh = SIM_SHT31_HUMIDITY_RH,
+  .temperatureSwingC = SIM_SHT31_TEMPERATURE_SWING_C,
+  .humiditySwingRh = SIM_SHT31_HUMIDITY_SWING_RH,
+  .periodS = SIM_SHT31_PERIOD_S,
+  .noise = true,
+  .seed = SIM_SHT31_SEED
+};
+static uint64_t rngState = SIM_SHT31_SEED;
+
+// Sensor
+static bool powered = true;
+static ModelMode_t mode = MODE_IDLE;
+static uint64_t busyUntilUs = 0;            // Conversion or reset in progress
+static uint16_t status = SIM_SHT31_STATUS_RESET;
+static uint16_t alertLimits[LIMIT_COUNT];
+static uint16_t resultWords[2];             // Raw T, raw RH of the latest conversion
+static bool stretchRead = false;            // Single shot with clock stretching
+static const PeriodicCommand_t *periodic = NULL;
+static uint64_t conversions = 0;            // Periodic results so far
+static uint64_t fetched = 0;                // Periodic results already read
+static SimEvent_t conversionEvent;
+
+// Words queued for the next read (result, status or a limit)
+static uint16_t outWords[2];
+static uint8_t outCount = 0;
+
+// ALERT pin
+static bool alertPin = false;
+static SimEvent_t alertEvent;
+
+// Faults
+static Fault_t faults[SIM_SHT31_FAULT_MAX];
+static uint32_t faultCount = 0;
+static bool holdingSda = false;
+static uint32_t pulsesToRelease = 0;
+static uint64_t holdingSinceUs = 0;
+
+// Results read out, for the attribute check
+static Sample_t *samples = NULL;
+static uint32_t sampleCount = 0;
+static uint32_t sampleCapacity = 0;
+
+static ModelStats_t stats;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static bool device_start(void);
+static bool device_write(const uint8_t *data, uint16_t len);
+static bool device_read(uint8_t *data, uint16_t len);
+static bool execute(uint16_t command, const uint8_t *data, uint16_t len);
+static void reset_state(void);
+static void measure(Sht31Repeatability_t repeatability, uint16_t *words);
+static double signal_at(uint64_t atUs, double mean, double swing);
+static double gaussian(void);
+static void conversion_handler(void *context);
+static void update_alert(const uint16_t *words);
+static void set_alert_pin(bool high);
+static void alert_handler(void *context);
+static uint16_t encode_limit(double temperatureC, double humidityRh);
+static Fault_t *take_fault(SimSht31Fault_t kind);
+static void hold_sda(uint32_t pulses);
+static void release_sda(void);
+static void scl_watch(bool high);
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+static void vdd_watch(bool high);
+#endif
+static void record_sample(const uint16_t *words);
+static void check_writes(uint16_t clusterId, bool temperature, uint32_t quantum,
+                         WriteCheck_t *check);
+static void put_word(uint8_t *out, uint16_t word);
+static uint8_t crc8(const uint8_t *data, uint8_t len);
+
+static const SimI2cDevice_t sht31Device = {
+  .start = device_start,
+  .write = device_write,
+  .read = device_read
+};
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void sim_sht31_init(void)
+{
+  rngState = signal.seed ? signal.seed : 1;
+
+  sim_event_init(&conversionEvent, conversion_handler, NULL, SIM_SOURCE_DEVICE);
+  sim_event_init(&alertEvent, alert_handler, NULL, SIM_SOURCE_GPIO);
+  reset_state();
+
+  if (!sim_config()->sensorAttached) {
+    return;
+  }
+
+  sim_i2c_attach(SHT31_I2C_ADDR, &sht31Device);
+  sim_gpio_watch(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, scl_watch);
+
+  // ALERT is push-pull: driven low from the start, so the first assert
+  // is a rising edge rather than an undriven input reading high
+  sim_gpio_set_input(SHT31_ALERT_PORT, SHT31_ALERT_PIN, alertPin);
+
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+  powered = false;
+  sim_gpio_watch(SENSOR_POWER_VDD_PORT, SENSOR_POWER_VDD_PIN, vdd_watch);
+#endif
+}
+
+void sim_sht31_set_signal(const SimSht31Signal_t *newSignal)
+{
+  signal = *newSignal;
+  rngState = signal.seed ? signal.seed : 1;
+}
+
+void sim_sht31_get_signal(SimSht31Signal_t *out)
+{
+  *out = signal;
+}
+
+bool sim_sht31_inject(SimSht31Fault_t fault, uint64_t atUs, uint32_t count, uint32_t param)
+{
+  if (faultCount == SIM_SHT31_FAULT_MAX || fault >= SIM_SHT31_FAULT_COUNT) {
+    return false;
+  }
+
+  faults[faultCount++] = (Fault_t) {
+    .kind = fault,
+    .atUs = atUs,
+    .remaining = count,
+    .param = param
+  };
+
+  return true;
+}
+
+void sim_sht31_print_report(FILE *out)
+{
+  if (!sim_config()->sensorAttached) {
+    fprintf(out, "SHT31 model: not attached\n");
+    return;
+  }
+
+  uint64_t stuckUs = stats.stuckUs + (holdingSda ? sim_now_us() - holdingSinceUs : 0);
+
+  fprintf(out, "SHT31 model:\n");
+  fprintf(out, "  transfers %u, results %u, ALERT edges %u\n",
+          stats.transfers, stats.results, stats.alertEdges);
+  fprintf(out, "  commands: single %u, periodic %u, fetch %u, reset %u, break %u, "
+          "alert %u, other %u\n",
+          stats.singleShots, stats.periodicStarts, stats.fetches, stats.resets,
+          stats.breaks, stats.alertWrites, stats.otherCommands);
+  fprintf(out, "  NACK: busy %u, no data %u, invalid %u, unpowered %u, injected %u\n",
+          stats.nackBusy, stats.nackNoData, stats.nackInvalid, stats.nackUnpowered,
+          stats.nackInjected);
+  fprintf(out, "  faults: stretched %u (%.3f ms), corrupted %u, stuck %u "
+          "(released %u, held %.3f ms)%s\n",
+          stats.stretched, stats.stretchUs / 1e3, stats.corrupted, stats.stuck,
+          stats.released, stuckUs / 1e3, holdingSda ? ", still held" : "");
+
+  WriteCheck_t temperature;
+  WriteCheck_t humidity;
+
+  check_writes(ZCL_TEMP_MEASUREMENT_CLUSTER_ID, true, APP_TEMP_QUANTUM_CENTI, &temperature);
+  check_writes(ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID, false,
+               APP_HUMIDITY_QUANTUM_CENTI, &humidity);
+  fprintf(out, "  check temperature %u writes: %u invalid, %u wrong (worst %.2f steps)\n",
+          temperature.total, temperature.invalid, temperature.wrong, temperature.worst);
+  fprintf(out, "  check humidity    %u writes: %u invalid, %u wrong (worst %.2f steps)\n",
+          humidity.total, humidity.invalid, humidity.wrong, humidity.worst);
+}
+
+void sim_sht31_get_outcome(SimSht31Outcome_t *outcome)
+{
+  WriteCheck_t temperature;
+  WriteCheck_t humidity;
+
+  check_writes(ZCL_TEMP_MEASUREMENT_CLUSTER_ID, true, APP_TEMP_QUANTUM_CENTI, &temperature);
+  check_writes(ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID, false,
+               APP_HUMIDITY_QUANTUM_CENTI, &humidity);
+
+  *outcome = (SimSht31Outcome_t) {
+    .writes = temperature.total + humidity.total,
+    .invalidWrites = temperature.invalid + humidity.invalid,
+    .wrongWrites = temperature.wrong + humidity.wrong,
+    .faulted = (stats.faultHits > 0),
+    .recovered = false,
+    .recoveryS = 0.0
+  };
+
+  if (!outcome->faulted || holdingSda) {
+    return;
+  }
+
+  // A corrupted result is recorded at the hit itself, so strictly after
+  for (uint32_t i = 0; i < sampleCount; i++) {
+    if (samples[i].timeUs > stats.lastFaultUs) {
+      outcome->recovered = true;
+      outcome->recoveryS = (samples[i].timeUs - stats.lastFaultUs) / 1e6;
+      break;
+    }
+  }
+}
+
+//==============================================================================
+// Private Functions - Bus
+//==============================================================================
+
+/**
+ * @brief Address phase, once per transfer
+ */
+static bool device_start(void)
+{
+  stats.transfers++;
+
+  if (!powered) {
+    stats.nackUnpowered++;
+    return false;
+  }
+
+  if (take_fault(SIM_SHT31_FAULT_NACK) != NULL) {
+    stats.nackInjected++;
+    return false;
+  }
+
+  Fault_t *stretch = take_fault(SIM_SHT31_FAULT_STRETCH);
+  if (stretch != NULL) {
+    uint32_t us = stretch->param ? stretch->param : SIM_SHT31_STRETCH_US;
+    stats.stretched++;
+    stats.stretchUs += us;
+    sim_i2c_stretch(us);
+  }
+
+  return true;
+}
+
+static bool device_write(const uint8_t *data, uint16_t len)
+{
+  // Converting or resetting: the sensor does not acknowledge its address
+  if (sim_now_us() < busyUntilUs) {
+    stats.nackBusy++;
+    return false;
+  }
+
+  if (len < 2 || !execute((uint16_t)((data[0] << 8) | data[1]), &data[2], len - 2)) {
+    status |= SIM_SHT31_STATUS_COMMAND_FAILED;
+    stats.nackInvalid++;
+    return false;
+  }
+
+  status &= ~SIM_SHT31_STATUS_COMMAND_FAILED;
+  return true;
+}
+
+static bool device_read(uint8_t *data, uint16_t len)
+{
+  uint64_t now = sim_now_us();
+
+  if (now < busyUntilUs) {
+    if (mode != MODE_SINGLE_SHOT || !stretchRead) {
+      stats.nackBusy++;
+      return false;
+    }
+    // Clock-stretching command: ACK, then hold SCL until the result is ready
+    sim_i2c_stretch((uint32_t)(busyUntilUs - now));
+  }
+
+  if (mode == MODE_SINGLE_SHOT) {
+    outWords[0] = resultWords[0];
+    outWords[1] = resultWords[1];
+    outCount = 2;
+    mode = MODE_IDLE;
+  }
+
+  if (outCount == 0) {
+    stats.nackNoData++;
+    return false;
+  }
+
+  bool result = (outCount == 2);
+  uint8_t frame[6];
+
+  for (uint8_t i = 0; i < outCount; i++) {
+    put_word(&frame[i * 3], outWords[i]);
+  }
+
+  if (result) {
+    record_sample(outWords);
+
+    Fault_t *crc = take_fault(SIM_SHT31_FAULT_CRC);
+    if (crc != NULL) {
+      // Flip a data bit; the CRC stays that of the true word
+      uint32_t words = crc->param ? crc->param : 1;
+      if (words & 1) {
+        frame[1] ^= 0x01;
+      }
+      if (words & 2) {
+        frame[4] ^= 0x01;
+      }
+      stats.corrupted++;
+    }
+  }
+
+  for (uint16_t i = 0; i < len; i++) {
+    data[i] = (i < outCount * 3) ? frame[i] : 0xFF;
+  }
+  outCount = 0;
+
+  if (result) {
+    Fault_t *stuck = take_fault(SIM_SHT31_FAULT_STUCK_BUS);
+    if (stuck != NULL) {
+      // Out of step with the master (glitch, brown-out): SDA stays low
+      hold_sda(stuck->param ? stuck->param : SIM_SHT31_STUCK_PULSES);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Run one command
+ * @return false if the sensor does not acknowledge it
+ */
+static bool execute(uint16_t command, const uint8_t *data, uint16_t len)
+{
+  uint8_t msb = (uint8_t)(command >> 8);
+  uint8_t lsb = (uint8_t)(command & 0xFF);
+  uint64_t now = sim_now_us();
+
+  // Periodic mode takes only fetch, break, reset, status and alert limits
+  if (mode == MODE_PERIODIC
+      && command != ((SHT31_CMD_FETCH_MSB << 8) | SHT31_CMD_FETCH_LSB)
+      && command != ((SHT31_CMD_BREAK_MSB << 8) | SHT31_CMD_BREAK_LSB)
+      && command != ((SHT31_CMD_SOFT_RESET_MSB << 8) | SHT31_CMD_SOFT_RESET_LSB)
+      && command != ((SHT31_CMD_STATUS_MSB << 8) | SHT31_CMD_STATUS_LSB)
+      && msb != SHT31_CMD_ALERT_WRITE_MSB && msb != SIM_SHT31_CMD_ALERT_READ_MSB) {
+    return false;
+  }
+
+  outCount = 0;
+
+  if (msb == SHT31_CMD_READ_MSB || msb == SIM_SHT31_CMD_STRETCH_MSB) {
+    bool stretch = (msb == SIM_SHT31_CMD_STRETCH_MSB);
+
+    for (int r = 0; r < SHT31_REPEATABILITY_COUNT; r++) {
+      if (lsb == singleShotLsbs[stretch][r]) {
+        mode = MODE_SINGLE_SHOT;
+        stretchRead = stretch;
+        measure((Sht31Repeatability_t)r, resultWords);
+        busyUntilUs = now + conversionUs[r];
+        stats.singleShots++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  for (uint32_t i = 0; i < PERIODIC_COMMAND_COUNT; i++) {
+    if (command == periodicCommands[i].command) {
+      mode = MODE_PERIODIC;
+      periodic = &periodicCommands[i];
+      conversions = 0;
+      fetched = 0;
+      sim_event_schedule(&conversionEvent, periodic->intervalUs);
+      stats.periodicStarts++;
+      return true;
+    }
+  }
+
+  switch (command) {
+    case (SHT31_CMD_FETCH_MSB << 8) | SHT31_CMD_FETCH_LSB:
+      stats.fetches++;
+      if (mode == MODE_PERIODIC && conversions > fetched) {
+        fetched = conversions;
+        outWords[0] = resultWords[0];
+        outWords[1] = resultWords[1];
+        outCount = 2;
+      }
+      // No new result: the command is taken, the read after it NACKs
+      return true;
+
+    case (SHT31_CMD_BREAK_MSB << 8) | SHT31_CMD_BREAK_LSB:
+      stats.breaks++;
+      if (mode == MODE_PERIODIC) {
+        mode = MODE_IDLE;
+        sim_event_cancel(&conversionEvent);
+        set_alert_pin(false);
+      }
+      return true;
+
+    case (SHT31_CMD_SOFT_RESET_MSB << 8) | SHT31_CMD_SOFT_RESET_LSB:
+      stats.resets++;
+      reset_state();
+      busyUntilUs = now + SIM_SHT31_RESET_US;
+      return true;
+
+    case (SHT31_CMD_STATUS_MSB << 8) | SHT31_CMD_STATUS_LSB:
+      stats.otherCommands++;
+      outWords[0] = status;
+      outCount = 1;
+      return true;
+
+    case SIM_SHT31_CMD_CLEAR_STATUS:
+      stats.otherCommands++;
+      status &= ~(SIM_SHT31_STATUS_ALERT | SIM_SHT31_STATUS_RH_ALERT
+                  | SIM_SHT31_STATUS_T_ALERT | SIM_SHT31_STATUS_RESET);
+      return true;
+
+    case SIM_SHT31_CMD_HEATER_ON:
+      stats.otherCommands++;
+      status |= SIM_SHT31_STATUS_HEATER;
+      return true;
+
+    case SIM_SHT31_CMD_HEATER_OFF:
+      stats.otherCommands++;
+      status &= ~SIM_SHT31_STATUS_HEATER;
+      return true;
+
+    default:
+      break;
+  }
+
+  for (int limit = 0; limit < LIMIT_COUNT; limit++) {
+    if (msb == SHT31_CMD_ALERT_WRITE_MSB && lsb == limitLsbs[0][limit]) {
+      // Limit word + CRC; a bad CRC is not acknowledged
+      if (len != 3 || crc8(data, 2) != data[2]) {
+        status |= SIM_SHT31_STATUS_WRITE_CRC;
+        return false;
+      }
+      status &= ~SIM_SHT31_STATUS_WRITE_CRC;
+      alertLimits[limit] = (uint16_t)((data[0] << 8) | data[1]);
+      stats.alertWrites++;
+      return true;
+    }
+    if (msb == SIM_SHT31_CMD_ALERT_READ_MSB && lsb == limitLsbs[1][limit]) {
+      stats.otherCommands++;
+      outWords[0] = alertLimits[limit];
+      outCount = 1;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Power-up / soft reset state: idle, heater off, default alert limits
+ */
+static void reset_state(void)
+{
+  mode = MODE_IDLE;
+  outCount = 0;
+  sim_event_cancel(&conversionEvent);
+  status = SIM_SHT31_STATUS_RESET;
+
+  alertLimits[LIMIT_HIGH_SET] = encode_limit(60.0, 80.0);
+  alertLimits[LIMIT_HIGH_CLEAR] = encode_limit(58.0, 79.0);
+  alertLimits[LIMIT_LOW_CLEAR] = encode_limit(-9.0, 22.0);
+  alertLimits[LIMIT_LOW_SET] = encode_limit(-10.0, 20.0);
+  set_alert_pin(false);
+}
+
+//==============================================================================
+// Private Functions - Signal
+//==============================================================================
+
+/**
+ * @brief Measure the air now, with the noise of @p repeatability
+ */
+static void measure(Sht31Repeatability_t repeatability, uint16_t *words)
+{
+  uint64_t now = sim_now_us();
+  double t = signal_at(now, signal.temperatureC, signal.temperatureSwingC);
+  double rh = signal_at(now, signal.humidityRh, signal.humiditySwingRh);
+
+  if (signal.noise) {
+    t += gaussian() * temperatureRepeatabilityC[repeatability] / 3.0;
+    rh += gaussian() * humidityRepeatabilityRh[repeatability] / 3.0;
+  }
+
+  // Sensor range
+  t = fmin(fmax(t, -45.0), 130.0);
+  rh = fmin(fmax(rh, 0.0), 100.0);
+
+  words[0] = (uint16_t)lround((t + 45.0) * 65535.0 / 175.0);
+  words[1] = (uint16_t)lround(rh * 65535.0 / 100.0);
+}
+
+static double signal_at(uint64_t atUs, double mean, double swing)
+{
+  if (signal.periodS == 0) {
+    return mean;
+  }
+
+  double periodUs = signal.periodS * 1e6;
+  double phase = fmod((double)atUs, periodUs) / periodUs;
+
+  switch (signal.shape) {
+    case SIM_SHT31_SHAPE_SINE:
+      return mean - swing * cos(2.0 * M_PI * phase);
+    case SIM_SHT31_SHAPE_SQUARE:
+      return (phase < 0.5) ? mean - swing : mean + swing;
+    case SIM_SHT31_SHAPE_RAMP:
+      return (phase < 0.5) ? mean - swing + 4.0 * swing * phase
+                           : mean + 3.0 * swing - 4.0 * swing * phase;
+    default:
+      return mean;
+  }
+}
+
+/**
+ * @brief Standard normal deviate (xorshift64*, Box-Muller), repeatable per seed
+ */
+static double gaussian(void)
+{
+  double u[2];
+
+  for (int i = 0; i < 2; i++) {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    u[i] = ((rngState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  return sqrt(-2.0 * log(u[0] + 1e-300)) * cos(2.0 * M_PI * u[1]);
+}
+
+/**
+ * @brief Periodic mode: a new result every interval, ALERT follows it
+ */
+static void conversion_handler(void *context)
+{
+  (void)context;
+
+  measure(periodic->repeatability, resultWords);
+  conversions++;
+  update_alert(resultWords);
+
+  sim_event_schedule(&conversionEvent, periodic->intervalUs);
+}
+
+/**
+ * @brief Set or clear the alert flags against the limits
+ * Limits keep the 9 MSBs of T and 7 MSBs of RH; results are compared at
+ * full resolution with the dropped limit bits at zero. Set above high-set
+ * or below low-set, cleared once back between the clear limits;
+ * temperature and humidity separately.
+ */
+static void update_alert(const uint16_t *words)
+{
+  uint16_t t = words[0];
+  uint16_t rh = words[1];
+  uint16_t tLimit[LIMIT_COUNT];
+  uint16_t rhLimit[LIMIT_COUNT];
+
+  for (int i = 0; i < LIMIT_COUNT; i++) {
+    tLimit[i] = (uint16_t)((alertLimits[i] & 0x01FF) << 7);
+    rhLimit[i] = alertLimits[i] & 0xFE00;
+  }
+
+  if (t > tLimit[LIMIT_HIGH_SET] || t < tLimit[LIMIT_LOW_SET]) {
+    status |= SIM_SHT31_STATUS_T_ALERT;
+  } else if (t < tLimit[LIMIT_HIGH_CLEAR] && t > tLimit[LIMIT_LOW_CLEAR]) {
+    status &= ~SIM_SHT31_STATUS_T_ALERT;
+  }
+
+  if (rh > rhLimit[LIMIT_HIGH_SET] || rh < rhLimit[LIMIT_LOW_SET]) {
+    status |= SIM_SHT31_STATUS_RH_ALERT;
+  } else if (rh < rhLimit[LIMIT_HIGH_CLEAR] && rh > rhLimit[LIMIT_LOW_CLEAR]) {
+    status &= ~SIM_SHT31_STATUS_RH_ALERT;
+  }
+
+  bool alert = (status & (SIM_SHT31_STATUS_T_ALERT | SIM_SHT31_STATUS_RH_ALERT)) != 0;
+  if (alert) {
+    status |= SIM_SHT31_STATUS_ALERT;
+  }
+  set_alert_pin(alert);
+}
+
+/**
+ * @brief Drive ALERT; the MCU sees the edge as a GPIO event of its own
+ */
+static void set_alert_pin(bool high)
+{
+  if (high == alertPin) {
+    return;
+  }
+
+  alertPin = high;
+  stats.alertEdges++;
+  sim_event_schedule(&alertEvent, 0);
+}
+
+static void alert_handler(void *context)
+{
+  (void)context;
+  sim_gpio_set_input(SHT31_ALERT_PORT, SHT31_ALERT_PIN, alertPin);
+}
+
+/**
+ * @brief Alert limit word: RH bits 15:9, T bits 8:0 (as sht31.c encodes it)
+ */
+static uint16_t encode_limit(double temperatureC, double humidityRh)
+{
+  uint16_t tRaw = (uint16_t)lround((temperatureC + 45.0) * 65535.0 / 175.0);
+  uint16_t hRaw = (uint16_t)lround(humidityRh * 65535.0 / 100.0);
+
+  return (uint16_t)((hRaw & 0xFE00u) | (tRaw >> 7));
+}
+
+//==============================================================================
+// Private Functions - Faults and Power
+//==============================================================================
+
+/**
+ * @brief Use up one transfer of the first armed fault of @p kind
+ */
+static Fault_t *take_fault(SimSht31Fault_t kind)
+{
+  uint64_t now = sim_now_us();
+
+  for (uint32_t i = 0; i < faultCount; i++) {
+    Fault_t *fault = &faults[i];
+    if (fault->kind == kind && fault->remaining > 0 && now >= fault->atUs) {
+      fault->remaining--;
+      stats.faultHits++;
+      stats.lastFaultUs = now;
+      return fault;
+    }
+  }
+
+  return NULL;
+}
+
+static void hold_sda(uint32_t pulses)
+{
+  holdingSda = true;
+  pulsesToRelease = pulses;
+  holdingSinceUs = sim_now_us();
+  stats.stuck++;
+  sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, false);
+}
+
+static void release_sda(void)
+{
+  holdingSda = false;
+  stats.stuckUs += sim_now_us() - holdingSinceUs;
+  sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, true);
+}
+
+/**
+ * @brief SCL toggled by the MCU: a held SDA lets go after enough clocks
+ */
+static void scl_watch(bool high)
+{
+  if (!holdingSda || !high) {
+    return;
+  }
+
+  if (--pulsesToRelease == 0) {
+    stats.released++;
+    release_sda();
+  }
+}
+
+#if SENSOR_POWER_VDD_GPIO_ENABLED
+/**
+ * @brief Sensor supply from a GPIO: off loses all state
+ */
+static void vdd_watch(bool high)
+{
+  powered = high;
+
+  if (holdingSda) {
+    release_sda();
+  }
+  reset_state();
+  busyUntilUs = high ? sim_now_us() + SIM_SHT31_POWER_UP_US : 0;
+}
+#endif
+
+//==============================================================================
+// Private Functions - Report
+//==============================================================================
+
+static void record_sample(const uint16_t *words)
+{
+  stats.results++;
+
+  if (sampleCount == sampleCapacity) {
+    uint32_t capacity = sampleCapacity ? sampleCapacity * 2 : 4096;
+    Sample_t *grown = realloc(samples, capacity * sizeof(*samples));
+    if (grown == NULL) {
+      return;
+    }
+    samples = grown;
+    sampleCapacity = capacity;
+  }
+
+  samples[sampleCount++] = (Sample_t) {
+    .timeUs = sim_now_us(),
+    .temperatureCenti = (-45.0 + 175.0 * words[0] / 65535.0) * 100.0,
+    .humidityCenti = (100.0 * words[1] / 65535.0) * 100.0
+  };
+}
+
+/**
+ * @brief Compare each measured-value write with the last result read before it
+ * More than one 0.01 step beyond the firmware's rounding (half of
+ * @p quantum) means a bad conversion or a corrupted word that got through.
+ */
+static void check_writes(uint16_t clusterId, bool temperature, uint32_t quantum,
+                         WriteCheck_t *check)
+{
+  double allowed = 1.0 + quantum / 2;
+  const Sample_t *sample = NULL;
+  uint32_t next = 0;
+
+  *check = (WriteCheck_t) { 0 };
+
+  for (uint32_t i = 0; i < sim_stack_get_history_count(); i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+
+    if (write->clusterId != clusterId || write->attributeId != 0x0000
+        || write->manufacturerCode != 0) {
+      continue;
+    }
+
+    while (next < sampleCount && samples[next].timeUs <= write->timeUs) {
+      sample = &samples[next++];
+    }
+
+    check->total++;
+    if (write->value == (temperature ? SHT31_INVALID_TEMPERATURE : SHT31_INVALID_HUMIDITY)) {
+      check->invalid++;
+      continue;
+    }
+    if (sample == NULL) {
+      continue;                                 // Cluster init, before any reading
+    }
+
+    double error = fabs((double)write->value
+                        - (temperature ? sample->temperatureCenti : sample->humidityCenti));
+    if (error > allowed) {
+      check->wrong++;
+    }
+    check->worst = fmax(check->worst, error);
+  }
+}
+
+static void put_word(uint8_t *out, uint16_t word)
+{
+  out[0] = (uint8_t)(word >> 8);
+  out[1] = (uint8_t)(word & 0xFF);
+  out[2] = crc8(out, 2);
+}
+
+/**
+ * @brief Sensirion CRC-8: polynomial 0x31, init 0xFF
+ */
+static uint8_t crc8(const uint8_t *data, uint8_t len)
+{
+  uint8_t crc = 0xFF;
+
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
@@ -0,0 +1,895 @@
+/**
+ * @file sim_stack.c
+ * @brief Host simulation: Zigbee stack and application framework
+ *
+ * Just enough of the stack for the firmware to run its normal life: a
+ * network that comes up at boot or after steering, end-device polls, the
+ * attribute table with the reporting plugin's min/max/change rules, and
+ * the AF console prints. Every attribute write is kept in a history.
+ */
+
+#include "sim.h"
+#include "af.h"
+#include "app.h"
+#include "app/framework/plugin/network-steering/network-steering.h"
+#include "em_core.h"
+#include "sl_iostream.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define SIM_NODE_ID             0x1A2B
+#define SIM_PAN_ID              0x5E3D
+#define SIM_CHANNEL             15
+#define SIM_ATTRIBUTE_MAX       64
+#define SIM_STRING_MAX          64
+
+// ZCL report: frame control, sequence, command + attribute id, type, value
+#define SIM_REPORT_ZCL_HEADER   6
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef struct {
+  uint16_t clusterId;
+  uint16_t attributeId;
+  uint16_t manufacturerCode;
+  uint8_t type;
+  int64_t value;
+  uint32_t writes;
+  uint32_t changes;
+  uint32_t reports;
+  bool valid;
+} Attribute_t;
+
+typedef struct {
+  uint16_t clusterId;
+  uint16_t attributeId;
+  uint32_t minIntervalS;
+  uint32_t maxIntervalS;
+  int64_t reportableChange;
+  // Runtime
+  Attribute_t *attribute;
+  int64_t reportedValue;
+  uint64_t lastReportUs;
+  bool reported;
+  SimEvent_t event;
+} ReportEntry_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static EmberNetworkStatus networkState = EMBER_NO_NETWORK;
+static uint32_t appTasks = 0;
+static uint8_t wakeTimeoutQs = 0;
+
+static SimEvent_t joinEvent;
+static SimEvent_t leaveEvent;
+static SimEvent_t networkUpEvent;
+static SimEvent_t pollEvent;
+
+// Stack events due and waiting for the main loop, in activation order
+static sl_zigbee_event_t *pendingHead = NULL;
+static sl_zigbee_event_t *pendingTail = NULL;
+static uint32_t pendingCount = 0;
+
+static SimRadioStats_t radioStats;
+static sim_radio_trace_t radioTrace = NULL;
+
+static Attribute_t attributes[SIM_ATTRIBUTE_MAX];
+static uint32_t attributeCount = 0;
+
+// Reporting plugin defaults (README "Reporting")
+static ReportEntry_t reportTable[] = {
+  { ZCL_TEMP_MEASUREMENT_CLUSTER_ID, ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID, 30, 300, 10 },
+  { ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID,
+    ZCL_RELATIVE_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID, 30, 300, 100 },
+  { ZCL_POWER_CONFIG_CLUSTER_ID, ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID,
+    3600, 86400, 10 }
+};
+
+#define REPORT_TABLE_SIZE   (sizeof(reportTable) / sizeof(reportTable[0]))
+
+static SimAttributeWrite_t *history = NULL;
+static uint32_t historyCapacity = 0;
+static uint32_t historyCount = 0;       // Entries held
+static uint32_t historyHead = 0;        // Oldest entry once the ring is full
+static uint32_t historyDropped = 0;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static EmberAfStatus write_attribute(uint16_t clusterId, uint16_t attributeId,
+                                     uint16_t manufacturerCode, uint8_t *data,
+                                     uint8_t type);
+static uint8_t attribute_size(uint8_t type, const uint8_t *data);
+static int64_t attribute_value(uint8_t type, const uint8_t *data);
+static Attribute_t *find_attribute(uint16_t clusterId, uint16_t attributeId,
+                                   uint16_t manufacturerCode, bool create);
+static void record_history(const Attribute_t *attribute);
+static void report_check(ReportEntry_t *entry);
+static void report_handler(void *context);
+static void schedule_poll(void);
+static uint64_t poll_interval_us(void);
+static void poll_handler(void *context);
+static void join_handler(void *context);
+static void leave_handler(void *context);
+static void network_up_handler(void *context);
+static void network_started(void);
+static void radio_tx(SimFrame_t frame, uint16_t txBytes);
+static void print_line(const char *format, va_list args);
+static void stack_event_due(void *context);
+static void unqueue_event(sl_zigbee_event_t *event);
+
+//==============================================================================
+// Public Functions - Simulation
+//==============================================================================
+
+void sim_stack_init(void)
+{
+  sim_event_init(&joinEvent, join_handler, NULL, SIM_SOURCE_STACK);
+  sim_event_init(&leaveEvent, leave_handler, NULL, SIM_SOURCE_STACK);
+  sim_event_init(&networkUpEvent, network_up_handler, NULL, SIM_SOURCE_STACK);
+  sim_event_init(&pollEvent, poll_handler, NULL, SIM_SOURCE_STACK);
+
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    sim_event_init(&reportTable[i].event, report_handler, &reportTable[i], SIM_SOURCE_STACK);
+  }
+
+  if (sim_config()->startJoined) {
+    // Network state is restored from tokens; the stack reports it once up
+    networkState = EMBER_JOINED_NETWORK;
+    sim_event_schedule(&networkUpEvent, (uint64_t)SIM_NETWORK_UP_MS * 1000u);
+  }
+}
+
+void sim_stack_boot(void)
+{
+  // What the framework does at boot, in the same order
+  emberAfBasicClusterServerInitCallback(APP_ENDPOINT);
+  emberAfIdentifyClusterServerInitCallback(APP_ENDPOINT);
+  emberAfPowerConfigClusterServerInitCallback(APP_ENDPOINT);
+  emberAfTempMeasurementClusterServerInitCallback(APP_ENDPOINT);
+  emberAfRelativeHumidityMeasurementClusterServerInitCallback(APP_ENDPOINT);
+  emberAfMainInitCallback();
+}
+
+uint32_t sim_stack_run_events(void)
+{
+  // Events activated by these handlers wait for the next pass, as on the stack
+  uint32_t count = pendingCount;
+  uint32_t ran = 0;
+
+  while (count-- > 0 && pendingHead != NULL) {
+    sl_zigbee_event_t *event = pendingHead;
+    unqueue_event(event);
+    event->handler(event);
+    ran++;
+  }
+
+  return ran;
+}
+
+bool sim_stack_events_pending(void)
+{
+  return pendingHead != NULL;
+}
+
+void sim_stack_set_radio_trace(sim_radio_trace_t trace)
+{
+  radioTrace = trace;
+}
+
+bool sim_stack_set_reporting(uint16_t clusterId, uint16_t attributeId, uint32_t minIntervalS,
+                             uint32_t maxIntervalS, int64_t reportableChange)
+{
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    if (reportTable[i].clusterId == clusterId && reportTable[i].attributeId == attributeId) {
+      reportTable[i].minIntervalS = minIntervalS;
+      reportTable[i].maxIntervalS = maxIntervalS;
+      reportTable[i].reportableChange = reportableChange;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void sim_stack_get_radio_stats(SimRadioStats_t *stats)
+{
+  *stats = radioStats;
+}
+
+uint32_t sim_stack_get_history_count(void)
+{
+  return historyCount;
+}
+
+const SimAttributeWrite_t *sim_stack_get_history(uint32_t index)
+{
+  if (index >= historyCount) {
+    return NULL;
+  }
+
+  return &history[(historyHead + index) % historyCapacity];
+}
+
+uint32_t sim_stack_get_history_dropped(void)
+{
+  return historyDropped;
+}
+
+void sim_stack_print_attributes(FILE *out)
+{
+  fprintf(out, "%-8s %-6s %-6s %-4s %10s %10s %10s %12s\n",
+          "cluster", "attr", "mfg", "type", "writes", "changes", "reports", "value");
+
+  for (uint32_t i = 0; i < attributeCount; i++) {
+    const Attribute_t *attribute = &attributes[i];
+
+    fprintf(out, "0x%04X   0x%04X 0x%04X 0x%02X %10u %10u %10u %12lld\n",
+            attribute->clusterId, attribute->attributeId, attribute->manufacturerCode,
+            attribute->type, attribute->writes, attribute->changes, attribute->reports,
+            (long long)attribute->value);
+  }
+}
+
+//==============================================================================
+// Public Functions - Framework and Stack
+//==============================================================================
+
+// Callbacks the application does not implement: the generated stubs' defaults
+__attribute__((weak)) bool emberAfMessageSentCallback(EmberOutgoingMessageType type,
+                                                      uint16_t indexOrDestination,
+                                                      EmberApsFrame *apsFrame,
+                                                      uint16_t msgLen,
+                                                      uint8_t *message,
+                                                      EmberStatus status)
+{
+  (void)type;
+  (void)indexOrDestination;
+  (void)apsFrame;
+  (void)msgLen;
+  (void)message;
+  (void)status;
+  return false;
+}
+
+__attribute__((weak)) void emberAfPluginEndDeviceSupportPollCompletedCallback(EmberStatus status)
+{
+  (void)status;
+}
+
+EmberAfStatus emberAfWriteServerAttribute(uint8_t endpoint,
+                                          EmberAfClusterId cluster,
+                                          EmberAfAttributeId attributeID,
+                                          uint8_t *dataPtr,
+                                          EmberAfAttributeType dataType)
+{
+  (void)endpoint;
+  return write_attribute(cluster, attributeID, 0, dataPtr, dataType);
+}
+
+EmberAfStatus emberAfWriteManufacturerSpecificServerAttribute(uint8_t endpoint,
+                                                              EmberAfClusterId cluster,
+                                                              EmberAfAttributeId attributeID,
+                                                              uint16_t manufacturerCode,
+                                                              uint8_t *dataPtr,
+                                                              EmberAfAttributeType dataType)
+{
+  (void)endpoint;
+  return write_attribute(cluster, attributeID, manufacturerCode, dataPtr, dataType);
+}
+
+void emberAfCorePrintln(const char *format, ...)
+{
+  va_list args;
+
+  if (!sim_console_is_enabled()) {
+    return;
+  }
+
+  va_start(args, format);
+  print_line(format, args);
+  va_end(args);
+}
+
+void emberAfDebugPrintln(const char *format, ...)
+{
+  va_list args;
+
+  if (!sim_console_is_enabled()) {
+    return;
+  }
+
+  va_start(args, format);
+  print_line(format, args);
+  va_end(args);
+}
+
+sl_status_t sl_iostream_write(sl_iostream_t *stream, const void *buffer, size_t buffer_length)
+{
+  (void)stream;
+
+  if (sim_console_is_enabled()) {
+    fwrite(buffer, 1, buffer_length, stdout);
+  }
+
+  return SL_STATUS_OK;
+}
+
+EmberNetworkStatus emberAfNetworkState(void)
+{
+  return networkState;
+}
+
+EmberStatus emberAfPluginNetworkSteeringStart(void)
+{
+  if (networkState != EMBER_NO_NETWORK) {
+    return EMBER_INVALID_CALL;
+  }
+
+  networkState = EMBER_JOINING_NETWORK;
+  sim_event_schedule(&joinEvent, (uint64_t)sim_config()->joinMs * 1000u);
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberLeaveNetwork(void)
+{
+  if (networkState != EMBER_JOINED_NETWORK) {
+    return EMBER_INVALID_CALL;
+  }
+
+  networkState = EMBER_LEAVING_NETWORK;
+  sim_event_cancel(&pollEvent);
+  sim_event_schedule(&leaveEvent, (uint64_t)SIM_LEAVE_MS * 1000u);
+
+  return EMBER_SUCCESS;
+}
+
+EmberNodeId emberAfGetNodeId(void)
+{
+  return (networkState == EMBER_JOINED_NETWORK) ? SIM_NODE_ID : 0xFFFE;
+}
+
+EmberPanId emberAfGetPanId(void)
+{
+  return (networkState == EMBER_JOINED_NETWORK) ? SIM_PAN_ID : 0xFFFF;
+}
+
+uint8_t emberAfGetRadioChannel(void)
+{
+  return SIM_CHANNEL;
+}
+
+void emberAfSetWakeTimeoutQsCallback(uint8_t quarterSeconds)
+{
+  wakeTimeoutQs = quarterSeconds;
+}
+
+void emberAfAddToCurrentAppTasksCallback(uint32_t tasks)
+{
+  appTasks |= tasks;
+  schedule_poll();
+}
+
+void emberAfRemoveFromCurrentAppTasksCallback(uint32_t tasks)
+{
+  appTasks &= ~tasks;
+  schedule_poll();
+}
+
+EmberStatus emberAfSendImmediateDefaultResponse(EmberAfStatus status)
+{
+  (void)status;
+  return emberAfSendResponse();
+}
+
+void emberAfFillCommandIdentifyClusterIdentifyQueryResponse(uint16_t timeout)
+{
+  (void)timeout;
+}
+
+EmberStatus emberAfSendResponse(void)
+{
+  radioStats.responses++;
+  radio_tx(SIM_FRAME_RESPONSE, SIM_RESPONSE_TX_BYTES);
+  sim_busy_us(sim_config()->txEm0Us);
+
+  return EMBER_SUCCESS;
+}
+
+void sl_zigbee_event_init(sl_zigbee_event_t *event, void (*handler)(sl_zigbee_event_t *event))
+{
+  event->handler = handler;
+  event->pending = false;
+  event->isr = false;
+  event->nextPending = NULL;
+  sim_event_init(&event->event, stack_event_due, event, SIM_SOURCE_TIMER);
+}
+
+void sl_zigbee_af_isr_event_init(sl_zigbee_event_t *event,
+                                 void (*handler)(sl_zigbee_event_t *event))
+{
+  sl_zigbee_event_init(event, handler);
+  event->isr = true;
+}
+
+void sl_zigbee_event_set_active(sl_zigbee_event_t *event)
+{
+  // As the SDK: only ISR events may be touched from an interrupt
+  if (CORE_InIrqContext() && !event->isr) {
+    fprintf(stderr, "sim: stack event activated from an interrupt at %.6f s\n",
+            sim_now_us() / 1e6);
+    exit(1);
+  }
+
+  unqueue_event(event);
+  sim_event_schedule(&event->event, 0);
+}
+
+void sl_zigbee_event_set_delay_ms(sl_zigbee_event_t *event, uint32_t delay)
+{
+  if (CORE_InIrqContext() || event->isr) {
+    fprintf(stderr, "sim: %s delayed at %.6f s\n",
+            event->isr ? "ISR event" : "stack event from an interrupt", sim_now_us() / 1e6);
+    exit(1);
+  }
+
+  unqueue_event(event);
+  sim_event_schedule(&event->event, (uint64_t)delay * 1000u);
+}
+
+void sl_zigbee_event_set_inactive(sl_zigbee_event_t *event)
+{
+  unqueue_event(event);
+  sim_event_cancel(&event->event);
+}
+
+bool sl_zigbee_event_is_scheduled(sl_zigbee_event_t *event)
+{
+  return event->pending || event->event.scheduled;
+}
+
+// The framework's default; the firmware overrides it if it has tick work
+__attribute__((weak)) void emberAfMainTickCallback(void)
+{
+}
+
+uint32_t halCommonGetInt32uMillisecondTick(void)
+{
+  return (uint32_t)(sim_now_us() / 1000u);
+}
+
+uint8_t halGetResetInfo(void)
+{
+  return EMBER_RESET_POWER_ON;
+}
+
+//==============================================================================
+// Private Functions - Attributes
+//==============================================================================
+
+static EmberAfStatus write_attribute(uint16_t clusterId, uint16_t attributeId,
+                                     uint16_t manufacturerCode, uint8_t *data,
+                                     uint8_t type)
+{
+  Attribute_t *attribute = find_attribute(clusterId, attributeId, manufacturerCode, true);
+  uint8_t size = attribute_size(type, data);
+
+  if (attribute == NULL) {
+    return EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE;
+  }
+
+  EmberAfStatus status = emberAfPreAttributeChangeCallback(APP_ENDPOINT, clusterId,
+                                                           attributeId, CLUSTER_MASK_SERVER,
+                                                           manufacturerCode, type, size,
+                                                           data);
+  if (status != EMBER_ZCL_STATUS_SUCCESS) {
+    return status;
+  }
+
+  int64_t value = attribute_value(type, data);
+
+  attribute->type = type;
+  attribute->writes++;
+  if (!attribute->valid || attribute->value != value) {
+    attribute->changes++;
+  }
+  attribute->value = value;
+  attribute->valid = true;
+  record_history(attribute);
+
+  emberAfPostAttributeChangeCallback(APP_ENDPOINT, clusterId, attributeId,
+                                     CLUSTER_MASK_SERVER, manufacturerCode, type, size, data);
+
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    if (reportTable[i].attribute == attribute) {
+      report_check(&reportTable[i]);
+    }
+  }
+
+  return EMBER_ZCL_STATUS_SUCCESS;
+}
+
+static uint8_t attribute_size(uint8_t type, const uint8_t *data)
+{
+  switch (type) {
+    case ZCL_INT16U_ATTRIBUTE_TYPE:
+    case ZCL_INT16S_ATTRIBUTE_TYPE:
+      return 2;
+    case ZCL_INT32U_ATTRIBUTE_TYPE:
+      return 4;
+    case ZCL_CHAR_STRING_ATTRIBUTE_TYPE:
+      return (data != NULL) ? (uint8_t)strnlen((const char *)data, SIM_STRING_MAX) : 0;
+    default:
+      return 1;
+  }
+}
+
+static int64_t attribute_value(uint8_t type, const uint8_t *data)
+{
+  switch (type) {
+    case ZCL_INT16U_ATTRIBUTE_TYPE: {
+      uint16_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case ZCL_INT16S_ATTRIBUTE_TYPE: {
+      int16_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case ZCL_INT32U_ATTRIBUTE_TYPE: {
+      uint32_t value;
+      memcpy(&value, data, sizeof(value));
+      return value;
+    }
+    case ZCL_CHAR_STRING_ATTRIBUTE_TYPE:
+      return attribute_size(type, data);
+    default:
+      return data[0];
+  }
+}
+
+static Attribute_t *find_attribute(uint16_t clusterId, uint16_t attributeId,
+                                   uint16_t manufacturerCode, bool create)
+{
+  for (uint32_t i = 0; i < attributeCount; i++) {
+    Attribute_t *attribute = &attributes[i];
+    if (attribute->clusterId == clusterId && attribute->attributeId == attributeId
+        && attribute->manufacturerCode == manufacturerCode) {
+      return attribute;
+    }
+  }
+
+  if (!create || attributeCount == SIM_ATTRIBUTE_MAX) {
+    return NULL;
+  }
+
+  Attribute_t *attribute = &attributes[attributeCount++];
+  memset(attribute, 0, sizeof(*attribute));
+  attribute->clusterId = clusterId;
+  attribute->attributeId = attributeId;
+  attribute->manufacturerCode = manufacturerCode;
+
+  // Bind to its reporting entry, if the attribute is reportable
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    if (manufacturerCode == 0 && reportTable[i].clusterId == clusterId
+        && reportTable[i].attributeId == attributeId) {
+      reportTable[i].attribute = attribute;
+    }
+  }
+
+  return attribute;
+}
+
+static void record_history(const Attribute_t *attribute)
+{
+  if (historyCount == historyCapacity && historyCapacity < SIM_HISTORY_MAX) {
+    uint32_t capacity = (historyCapacity == 0) ? 4096 : historyCapacity * 2;
+    SimAttributeWrite_t *grown = realloc(history, capacity * sizeof(*history));
+    if (grown != NULL) {
+      history = grown;
+      historyCapacity = capacity;
+    }
+  }
+
+  uint32_t slot;
+
+  if (historyCount < historyCapacity) {
+    slot = (historyHead + historyCount++) % historyCapacity;
+  } else if (historyCapacity > 0) {
+    // Full: overwrite the oldest
+    slot = historyHead;
+    historyHead = (historyHead + 1) % historyCapacity;
+    historyDropped++;
+  } else {
+    historyDropped++;
+    return;
+  }
+
+  history[slot] = (SimAttributeWrite_t) {
+    .timeUs = sim_now_us(),
+    .clusterId = attribute->clusterId,
+    .attributeId = attribute->attributeId,
+    .manufacturerCode = attribute->manufacturerCode,
+    .type = attribute->type,
+    .value = attribute->value
+  };
+}
+
+//==============================================================================
+// Private Functions - Reporting
+//==============================================================================
+
+/**
+ * @brief Schedule the next report of @p entry
+ * Due at the min interval when the value moved by the reportable change,
+ * otherwise at the max interval.
+ */
+static void report_check(ReportEntry_t *entry)
+{
+  if (networkState != EMBER_JOINED_NETWORK || entry->attribute == NULL) {
+    return;
+  }
+
+  if (!entry->reported) {
+    sim_event_schedule(&entry->event, 0);
+    return;
+  }
+
+  int64_t delta = entry->attribute->value - entry->reportedValue;
+  if (delta < 0) {
+    delta = -delta;
+  }
+
+  uint64_t dueUs = entry->lastReportUs + (uint64_t)entry->maxIntervalS * 1000000u;
+
+  if (delta >= entry->reportableChange) {
+    dueUs = entry->lastReportUs + (uint64_t)entry->minIntervalS * 1000000u;
+  }
+
+  sim_event_schedule_at(&entry->event, dueUs);
+}
+
+static void report_handler(void *context)
+{
+  ReportEntry_t *entry = context;
+
+  if (networkState != EMBER_JOINED_NETWORK || entry->attribute == NULL) {
+    return;
+  }
+
+  Attribute_t *attribute = entry->attribute;
+  int64_t delta = attribute->value - entry->reportedValue;
+  bool maxDue = (sim_now_us() >= entry->lastReportUs + (uint64_t)entry->maxIntervalS * 1000000u);
+
+  if (entry->reported && !maxDue && (delta < entry->reportableChange)
+      && (-delta < entry->reportableChange)) {
+    // Moved back inside the reportable change before the min interval ran out
+    report_check(entry);
+    return;
+  }
+
+  uint16_t msgLen = SIM_REPORT_ZCL_HEADER + attribute_size(attribute->type, NULL);
+  uint8_t message[SIM_REPORT_ZCL_HEADER + 4] = { 0 };
+  EmberApsFrame apsFrame = {
+    .profileId = 0x0104,
+    .clusterId = entry->clusterId,
+    .sourceEndpoint = APP_ENDPOINT,
+    .destinationEndpoint = 1
+  };
+
+  attribute->reports++;
+  entry->reportedValue = attribute->value;
+  entry->lastReportUs = sim_now_us();
+  entry->reported = true;
+
+  radioStats.reports++;
+  radio_tx(SIM_FRAME_REPORT, SIM_REPORT_TX_BYTES);
+  sim_busy_us(sim_config()->txEm0Us);
+
+  emberAfMessageSentCallback(EMBER_OUTGOING_DIRECT, 0x0000, &apsFrame, msgLen, message,
+                             EMBER_SUCCESS);
+
+  report_check(entry);
+}
+
+//==============================================================================
+// Private Functions - Network
+//==============================================================================
+
+/**
+ * @brief (Re)arm the poll timer for the current poll rate
+ * Pulls the next poll in when the rate goes up; never pushes it out.
+ */
+static void schedule_poll(void)
+{
+  if (networkState != EMBER_JOINED_NETWORK) {
+    return;
+  }
+
+  uint64_t dueUs = sim_now_us() + poll_interval_us();
+
+  if (!pollEvent.scheduled || dueUs < pollEvent.dueUs) {
+    sim_event_schedule_at(&pollEvent, dueUs);
+  }
+}
+
+static uint64_t poll_interval_us(void)
+{
+  if ((appTasks & EMBER_AF_WAITING_FOR_DATA_ACK) && wakeTimeoutQs != 0) {
+    return (uint64_t)wakeTimeoutQs * 250000u;
+  }
+
+  return (uint64_t)sim_config()->longPollMs * 1000u;
+}
+
+static void poll_handler(void *context)
+{
+  (void)context;
+
+  if (networkState != EMBER_JOINED_NETWORK) {
+    return;
+  }
+
+  radioStats.polls++;
+  radioStats.rxBytes += SIM_POLL_RX_BYTES;
+  radioStats.rxAirUs += SIM_POLL_RX_BYTES * SIM_US_PER_BYTE;
+  radio_tx(SIM_FRAME_POLL, SIM_POLL_TX_BYTES);
+  sim_busy_us(sim_config()->pollEm0Us);
+
+  emberAfPluginEndDeviceSupportPollCompletedCallback(EMBER_SUCCESS);
+
+  schedule_poll();
+}
+
+static void join_handler(void *context)
+{
+  (void)context;
+
+  networkState = EMBER_JOINED_NETWORK;
+  radioStats.joins++;
+  network_started();
+
+  emberAfStackStatusCallback(EMBER_NETWORK_UP);
+  emberAfPluginNetworkSteeringCompleteCallback(EMBER_SUCCESS, 1, 1, 0);
+}
+
+static void leave_handler(void *context)
+{
+  (void)context;
+
+  networkState = EMBER_NO_NETWORK;
+  radioStats.leaves++;
+
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    sim_event_cancel(&reportTable[i].event);
+    reportTable[i].reported = false;
+  }
+
+  emberAfStackStatusCallback(EMBER_NETWORK_DOWN);
+}
+
+static void network_up_handler(void *context)
+{
+  (void)context;
+
+  network_started();
+  emberAfStackStatusCallback(EMBER_NETWORK_UP);
+}
+
+/**
+ * @brief Start polling and report every reportable attribute once
+ */
+static void network_started(void)
+{
+  schedule_poll();
+
+  for (uint32_t i = 0; i < REPORT_TABLE_SIZE; i++) {
+    report_check(&reportTable[i]);
+  }
+}
+
+static void radio_tx(SimFrame_t frame, uint16_t txBytes)
+{
+  radioStats.txBytes += txBytes;
+  radioStats.txAirUs += txBytes * SIM_US_PER_BYTE;
+
+  if (radioTrace != NULL) {
+    radioTrace(frame, txBytes);
+  }
+}
+
+/**
+ * @brief Print one console line
+ * The firmware formats 32-bit values with %lu/%ld (long is 32 bits on the
+ * target); the l is dropped so the host vprintf reads an int.
+ */
+static void print_line(const char *format, va_list args)
+{
+  char hostFormat[256];
+  size_t out = 0;
+
+  for (const char *p = format; *p != '\0' && out < sizeof(hostFormat) - 1; p++) {
+    hostFormat[out++] = *p;
+    if (*p != '%') {
+      continue;
+    }
+    // Copy flags, width and precision, then drop a single l
+    while (p[1] != '\0' && strchr("-+ #0123456789.*", p[1]) != NULL
+           && out < sizeof(hostFormat) - 1) {
+      hostFormat[out++] = *++p;
+    }
+    if (p[1] == 'l' && p[2] != 'l') {
+      p++;
+    }
+  }
+  hostFormat[out] = '\0';
+
+  printf("[%12.3f] ", (double)sim_now_us() / 1e6);
+  vprintf(hostFormat, args);
+  putchar('\n');
+}
+
+//==============================================================================
+// Private Functions - Stack Events
+//==============================================================================
+
+/**
+ * @brief Stack event delay over: queue it for the main loop
+ */
+static void stack_event_due(void *context)
+{
+  sl_zigbee_event_t *event = context;
+
+  if (event->pending) {
+    return;
+  }
+
+  event->pending = true;
+  event->nextPending = NULL;
+  if (pendingTail != NULL) {
+    pendingTail->nextPending = event;
+  } else {
+    pendingHead = event;
+  }
+  pendingTail = event;
+  pendingCount++;
+}
+
+static void unqueue_event(sl_zigbee_event_t *event)
+{
+  if (!event->pending) {
+    return;
+  }
+
+  sl_zigbee_event_t *previous = NULL;
+  for (sl_zigbee_event_t *entry = pendingHead; entry != NULL; entry = entry->nextPending) {
+    if (entry == event) {
+      if (previous != NULL) {
+        previous->nextPending = event->nextPending;
+      } else {
+        pendingHead = event->nextPending;
+      }
+      if (pendingTail == event) {
+        pendingTail = previous;
+      }
+      break;
+    }
+    previous = entry;
+  }
+
+  event->pending = false;
+  event->nextPending = NULL;
+  pendingCount--;
+}
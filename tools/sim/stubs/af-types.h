@@ -0,0 +1,6 @@
+/**
+ * @file af-types.h
+ * @brief Host stub: AF types (all in af.h)
+ */
+
+#include "af.h"
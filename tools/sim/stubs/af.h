@@ -0,0 +1,247 @@
+/**
+ * @file af.h
+ * @brief Host stub: Zigbee application framework
+ *
+ * The AF types, constants and calls the firmware uses, implemented by the
+ * simulated stack (sim_stack.c), plus the prototypes of the callbacks the
+ * firmware implements and the simulated stack invokes.
+ */
+
+#ifndef SIM_AF_H
+#define SIM_AF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sl_sleeptimer.h"
+#include "sl_cli.h"
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef uint8_t EmberStatus;
+typedef uint8_t EmberAfStatus;
+typedef uint16_t EmberNodeId;
+typedef uint16_t EmberPanId;
+typedef uint16_t EmberAfClusterId;
+typedef uint16_t EmberAfAttributeId;
+typedef uint8_t EmberAfAttributeType;
+typedef uint8_t EmberNetworkStatus;
+typedef uint8_t EmberOutgoingMessageType;
+
+// Stack event: handler runs from the main loop once active or its delay ends
+typedef struct sl_zigbee_event_s sl_zigbee_event_t;
+
+struct sl_zigbee_event_s {
+  void (*handler)(sl_zigbee_event_t *event);
+  SimEvent_t event;                 // Delay expiry
+  bool pending;                     // Due, waiting for the main loop
+  bool isr;                         // sl_zigbee_af_isr_event_init(): activate only
+  sl_zigbee_event_t *nextPending;
+};
+
+typedef enum {
+  EMBER_AF_JOINABLE_NETWORK_FOUND,
+  EMBER_AF_NETWORK_JOINED,
+  EMBER_AF_NETWORK_LEFT
+} EmberAfNetworkEvent;
+
+typedef struct {
+  uint16_t profileId;
+  uint16_t clusterId;
+  uint8_t sourceEndpoint;
+  uint8_t destinationEndpoint;
+  uint16_t options;
+  uint16_t groupId;
+  uint8_t sequence;
+  uint8_t radius;
+} EmberApsFrame;
+
+typedef struct {
+  EmberApsFrame *apsFrame;
+  uint8_t commandId;
+  uint8_t direction;
+  uint16_t mfgCode;
+  uint8_t *buffer;
+  uint16_t bufLen;
+} EmberAfClusterCommand;
+
+typedef struct {
+  uint8_t type;
+  EmberApsFrame *apsFrame;
+  uint8_t *message;
+  uint16_t msgLen;
+  EmberNodeId source;
+  uint8_t lastHopLqi;
+  int8_t lastHopRssi;
+} EmberAfIncomingMessage;
+
+//==============================================================================
+// Constants
+//==============================================================================
+
+#define EMBER_SUCCESS                                   0x00
+#define EMBER_ERR_FATAL                                 0x01
+#define EMBER_INVALID_CALL                              0x70
+#define EMBER_NETWORK_UP                                0x90
+#define EMBER_NETWORK_DOWN                              0x91
+#define EMBER_JOIN_FAILED                               0x94
+
+#define EMBER_NO_NETWORK                                0x00
+#define EMBER_JOINING_NETWORK                           0x01
+#define EMBER_JOINED_NETWORK                            0x02
+#define EMBER_LEAVING_NETWORK                           0x04
+
+#define EMBER_OUTGOING_DIRECT                           0x00
+
+#define EMBER_RESET_UNKNOWN                             0x00
+#define EMBER_RESET_EXTERNAL                            0x01
+#define EMBER_RESET_POWER_ON                            0x02
+#define EMBER_RESET_WATCHDOG                            0x03
+#define EMBER_RESET_SOFTWARE                            0x0B
+
+#define EMBER_AF_WAITING_FOR_DATA_ACK                   0x00000001
+
+#define EMBER_ZCL_STATUS_SUCCESS                        0x00
+#define EMBER_ZCL_STATUS_UNSUPPORTED_ATTRIBUTE          0x86
+#define EMBER_ZCL_POWER_SOURCE_SINGLE_PHASE_MAINS       0x01
+#define EMBER_ZCL_POWER_SOURCE_BATTERY                  0x03
+#define EMBER_ZCL_BATTERY_SIZE_AA                       0x03
+
+#define CLUSTER_MASK_SERVER                             0x40
+
+#define ZCL_BASIC_CLUSTER_ID                            0x0000
+#define ZCL_POWER_CONFIG_CLUSTER_ID                     0x0001
+#define ZCL_IDENTIFY_CLUSTER_ID                         0x0003
+#define ZCL_TEMP_MEASUREMENT_CLUSTER_ID                 0x0402
+#define ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID    0x0405
+
+#define ZCL_ZCL_VERSION_ATTRIBUTE_ID                    0x0000
+#define ZCL_HW_VERSION_ATTRIBUTE_ID                     0x0003
+#define ZCL_MANUFACTURER_NAME_ATTRIBUTE_ID              0x0004
+#define ZCL_MODEL_IDENTIFIER_ATTRIBUTE_ID               0x0005
+#define ZCL_DATE_CODE_ATTRIBUTE_ID                      0x0006
+#define ZCL_POWER_SOURCE_ATTRIBUTE_ID                   0x0007
+#define ZCL_SW_BUILD_ID_ATTRIBUTE_ID                    0x4000
+
+#define ZCL_IDENTIFY_TIME_ATTRIBUTE_ID                  0x0000
+
+#define ZCL_BATTERY_VOLTAGE_ATTRIBUTE_ID                0x0020
+#define ZCL_BATTERY_PERCENTAGE_REMAINING_ATTRIBUTE_ID   0x0021
+#define ZCL_BATTERY_SIZE_ATTRIBUTE_ID                   0x0031
+#define ZCL_BATTERY_QUANTITY_ATTRIBUTE_ID               0x0033
+#define ZCL_BATTERY_VOLTAGE_MIN_THRESHOLD_ATTRIBUTE_ID  0x0036
+#define ZCL_BATTERY_VOLTAGE_THRESHOLD1_ATTRIBUTE_ID     0x0037
+#define ZCL_BATTERY_ALARM_STATE_ATTRIBUTE_ID            0x003E
+
+#define ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID            0x0000
+#define ZCL_TEMP_MIN_MEASURED_VALUE_ATTRIBUTE_ID        0x0001
+#define ZCL_TEMP_MAX_MEASURED_VALUE_ATTRIBUTE_ID        0x0002
+#define ZCL_TEMP_TOLERANCE_ATTRIBUTE_ID                 0x0003
+
+#define ZCL_RELATIVE_HUMIDITY_MEASURED_VALUE_ATTRIBUTE_ID      0x0000
+#define ZCL_RELATIVE_HUMIDITY_MIN_MEASURED_VALUE_ATTRIBUTE_ID  0x0001
+#define ZCL_RELATIVE_HUMIDITY_MAX_MEASURED_VALUE_ATTRIBUTE_ID  0x0002
+#define ZCL_RELATIVE_HUMIDITY_TOLERANCE_ATTRIBUTE_ID           0x0003
+
+#define ZCL_BITMAP8_ATTRIBUTE_TYPE                      0x18
+#define ZCL_INT8U_ATTRIBUTE_TYPE                        0x20
+#define ZCL_INT16U_ATTRIBUTE_TYPE                       0x21
+#define ZCL_INT32U_ATTRIBUTE_TYPE                       0x23
+#define ZCL_INT16S_ATTRIBUTE_TYPE                       0x29
+#define ZCL_ENUM8_ATTRIBUTE_TYPE                        0x30
+#define ZCL_CHAR_STRING_ATTRIBUTE_TYPE                  0x42
+
+//==============================================================================
+// Framework and Stack Calls (sim_stack.c)
+//==============================================================================
+
+EmberAfStatus emberAfWriteServerAttribute(uint8_t endpoint,
+                                          EmberAfClusterId cluster,
+                                          EmberAfAttributeId attributeID,
+                                          uint8_t *dataPtr,
+                                          EmberAfAttributeType dataType);
+EmberAfStatus emberAfWriteManufacturerSpecificServerAttribute(uint8_t endpoint,
+                                                              EmberAfClusterId cluster,
+                                                              EmberAfAttributeId attributeID,
+                                                              uint16_t manufacturerCode,
+                                                              uint8_t *dataPtr,
+                                                              EmberAfAttributeType dataType);
+
+void emberAfCorePrintln(const char *format, ...);
+void emberAfDebugPrintln(const char *format, ...);
+
+EmberNetworkStatus emberAfNetworkState(void);
+EmberStatus emberLeaveNetwork(void);
+EmberNodeId emberAfGetNodeId(void);
+EmberPanId emberAfGetPanId(void);
+uint8_t emberAfGetRadioChannel(void);
+
+void emberAfSetWakeTimeoutQsCallback(uint8_t quarterSeconds);
+void emberAfAddToCurrentAppTasksCallback(uint32_t tasks);
+void emberAfRemoveFromCurrentAppTasksCallback(uint32_t tasks);
+
+EmberStatus emberAfSendImmediateDefaultResponse(EmberAfStatus status);
+void emberAfFillCommandIdentifyClusterIdentifyQueryResponse(uint16_t timeout);
+EmberStatus emberAfSendResponse(void);
+
+void sl_zigbee_event_init(sl_zigbee_event_t *event, void (*handler)(sl_zigbee_event_t *event));
+// Event an interrupt may activate; it cannot be delayed
+void sl_zigbee_af_isr_event_init(sl_zigbee_event_t *event,
+                                 void (*handler)(sl_zigbee_event_t *event));
+void sl_zigbee_event_set_active(sl_zigbee_event_t *event);
+void sl_zigbee_event_set_delay_ms(sl_zigbee_event_t *event, uint32_t delay);
+void sl_zigbee_event_set_inactive(sl_zigbee_event_t *event);
+bool sl_zigbee_event_is_scheduled(sl_zigbee_event_t *event);
+
+uint32_t halCommonGetInt32uMillisecondTick(void);
+uint8_t halGetResetInfo(void);
+
+//==============================================================================
+// Application Callbacks (implemented by the firmware)
+//==============================================================================
+
+void emberAfMainInitCallback(void);
+void emberAfMainTickCallback(void);
+void emberAfStackStatusCallback(EmberStatus status);
+bool emberAfMessageSentCallback(EmberOutgoingMessageType type,
+                                uint16_t indexOrDestination,
+                                EmberApsFrame *apsFrame,
+                                uint16_t msgLen,
+                                uint8_t *message,
+                                EmberStatus status);
+bool emberAfPreMessageReceivedCallback(EmberAfIncomingMessage *incomingMessage);
+void emberAfPluginEndDeviceSupportPollCompletedCallback(EmberStatus status);
+void emberAfPluginNetworkSteeringCompleteCallback(EmberStatus status,
+                                                  uint8_t totalBeacons,
+                                                  uint8_t joinAttempts,
+                                                  uint8_t finalState);
+
+void emberAfBasicClusterServerInitCallback(uint8_t endpoint);
+void emberAfIdentifyClusterServerInitCallback(uint8_t endpoint);
+void emberAfPowerConfigClusterServerInitCallback(uint8_t endpoint);
+void emberAfTempMeasurementClusterServerInitCallback(uint8_t endpoint);
+void emberAfRelativeHumidityMeasurementClusterServerInitCallback(uint8_t endpoint);
+bool emberAfIdentifyClusterIdentifyCallback(uint16_t identifyTime);
+bool emberAfIdentifyClusterIdentifyQueryCallback(void);
+bool emberAfBasicClusterResetToFactoryDefaultsCallback(void);
+bool emberAfPreCommandReceivedCallback(EmberAfClusterCommand *cmd);
+EmberAfStatus emberAfPreAttributeChangeCallback(uint8_t endpoint,
+                                                EmberAfClusterId clusterId,
+                                                EmberAfAttributeId attributeId,
+                                                uint8_t mask,
+                                                uint16_t manufacturerCode,
+                                                uint8_t type,
+                                                uint8_t size,
+                                                uint8_t *value);
+void emberAfPostAttributeChangeCallback(uint8_t endpoint,
+                                        EmberAfClusterId clusterId,
+                                        EmberAfAttributeId attributeId,
+                                        uint8_t mask,
+                                        uint16_t manufacturerCode,
+                                        uint8_t type,
+                                        uint8_t size,
+                                        uint8_t *value);
+
+#endif // SIM_AF_H
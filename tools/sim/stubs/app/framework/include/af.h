@@ -0,0 +1,6 @@
+/**
+ * @file af.h
+ * @brief Host stub: framework include path, forwards to the stub af.h
+ */
+
+#include "../../../af.h"
@@ -0,0 +1,13 @@
+/**
+ * @file network-steering.h
+ * @brief Host stub: network steering plugin
+ */
+
+#ifndef SIM_NETWORK_STEERING_H
+#define SIM_NETWORK_STEERING_H
+
+#include "../../../../af.h"
+
+EmberStatus emberAfPluginNetworkSteeringStart(void);
+
+#endif // SIM_NETWORK_STEERING_H
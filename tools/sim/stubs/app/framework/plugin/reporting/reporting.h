@@ -0,0 +1,6 @@
+/**
+ * @file reporting.h
+ * @brief Host stub: reporting plugin (modelled inside sim_stack.c)
+ */
+
+#include "../../../../af.h"
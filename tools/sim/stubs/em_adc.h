@@ -0,0 +1,106 @@
+/**
+ * @file em_adc.h
+ * @brief Host stub: ADC
+ *
+ * A single conversion completes after the oversampled conversion time and
+ * returns the simulated AVDD (SimConfig_t.batteryMv).
+ */
+
+#ifndef EM_ADC_H
+#define EM_ADC_H
+
+#include <stdint.h>
+#include "em_device.h"
+
+typedef enum {
+  adcStartSingle = 1
+} ADC_Start_TypeDef;
+
+typedef enum {
+  adcOvsRateSel2,
+  adcOvsRateSel4,
+  adcOvsRateSel8,
+  adcOvsRateSel16,
+  adcOvsRateSel32,
+  adcOvsRateSel64,
+  adcOvsRateSel128,
+  adcOvsRateSel256,
+  adcOvsRateSel512,
+  adcOvsRateSel1024,
+  adcOvsRateSel2048,
+  adcOvsRateSel4096
+} ADC_OvsRateSel_TypeDef;
+
+typedef enum {
+  adcWarmupNormal,
+  adcWarmupKeepInStandby,
+  adcWarmupKeepInSlowAcq,
+  adcWarmupKeepADCWarm
+} ADC_Warmup_TypeDef;
+
+typedef enum {
+  adcAcqTime1,
+  adcAcqTime2,
+  adcAcqTime4,
+  adcAcqTime8,
+  adcAcqTime16,
+  adcAcqTime32,
+  adcAcqTime64,
+  adcAcqTime128,
+  adcAcqTime256
+} ADC_AcqTime_TypeDef;
+
+typedef enum {
+  adcRef1V25,
+  adcRef2V5,
+  adcRefVDD,
+  adcRef5V
+} ADC_Ref_TypeDef;
+
+typedef enum {
+  adcRes12Bit,
+  adcRes8Bit,
+  adcRes6Bit,
+  adcResOVS
+} ADC_Res_TypeDef;
+
+typedef enum {
+  adcSingleInputAVDD,
+  adcSingleInputDVDD
+} ADC_SingleInput_TypeDef;
+
+typedef struct {
+  ADC_OvsRateSel_TypeDef ovsRateSel;
+  ADC_Warmup_TypeDef warmUpMode;
+  uint8_t timebase;
+  uint8_t prescale;
+  bool tailgate;
+} ADC_Init_TypeDef;
+
+#define ADC_INIT_DEFAULT  { adcOvsRateSel2, adcWarmupNormal, 0, 0, false }
+
+typedef struct {
+  ADC_AcqTime_TypeDef acqTime;
+  ADC_Ref_TypeDef reference;
+  ADC_Res_TypeDef resolution;
+  ADC_SingleInput_TypeDef input;
+  bool diff;
+  bool prsEnable;
+  bool leftAdjust;
+  bool rep;
+} ADC_InitSingle_TypeDef;
+
+#define ADC_INITSINGLE_DEFAULT \
+  { adcAcqTime1, adcRef1V25, adcRes12Bit, adcSingleInputAVDD, false, false, false, false }
+
+void ADC_Init(ADC_TypeDef *adc, const ADC_Init_TypeDef *init);
+void ADC_InitSingle(ADC_TypeDef *adc, const ADC_InitSingle_TypeDef *init);
+void ADC_Start(ADC_TypeDef *adc, ADC_Start_TypeDef cmd);
+uint32_t ADC_DataSingleGet(ADC_TypeDef *adc);
+uint8_t ADC_TimebaseCalc(uint32_t hfperFreq);
+uint8_t ADC_PrescaleCalc(uint32_t adcFreq, uint32_t hfperFreq);
+void ADC_IntEnable(ADC_TypeDef *adc, uint32_t flags);
+void ADC_IntDisable(ADC_TypeDef *adc, uint32_t flags);
+void ADC_IntClear(ADC_TypeDef *adc, uint32_t flags);
+
+#endif // EM_ADC_H
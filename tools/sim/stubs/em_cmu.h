@@ -0,0 +1,21 @@
+/**
+ * @file em_cmu.h
+ * @brief Host stub: clock management
+ */
+
+#ifndef EM_CMU_H
+#define EM_CMU_H
+
+#include <stdbool.h>
+#include "em_device.h"
+
+typedef enum {
+  cmuClock_HFPER,
+  cmuClock_GPIO,
+  cmuClock_I2C0,
+  cmuClock_ADC0
+} CMU_Clock_TypeDef;
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+
+#endif // EM_CMU_H
@@ -0,0 +1,24 @@
+/**
+ * @file em_core.h
+ * @brief Host stub: interrupt masking
+ *
+ * The simulation is single threaded and only runs "interrupts" from its
+ * event loop, so critical sections need no masking. The event loop tracks
+ * whether a peripheral or timer handler is running (sim.c).
+ */
+
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+#include <stdbool.h>
+#include "em_device.h"
+
+#define CORE_DECLARE_IRQ_STATE      int irqState_ = 0
+#define CORE_ENTER_ATOMIC()         ((void)irqState_)
+#define CORE_EXIT_ATOMIC()          ((void)irqState_)
+#define CORE_ENTER_CRITICAL()       ((void)irqState_)
+#define CORE_EXIT_CRITICAL()        ((void)irqState_)
+
+bool CORE_InIrqContext(void);
+
+#endif // EM_CORE_H
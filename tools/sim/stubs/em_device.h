@@ -0,0 +1,91 @@
+/**
+ * @file em_device.h
+ * @brief Host stub: EFR32MG1 peripheral registers and core intrinsics
+ *
+ * Only the registers and bits the firmware touches. The peripheral
+ * instances are plain structs owned by the simulation (sim_hw.c).
+ */
+
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CMD;
+  volatile uint32_t STATE;
+  volatile uint32_t STATUS;
+  volatile uint32_t IF;
+  volatile uint32_t IEN;
+  volatile uint32_t ROUTEPEN;
+  volatile uint32_t ROUTELOC0;
+} I2C_TypeDef;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CMD;
+  volatile uint32_t STATUS;
+  volatile uint32_t SINGLEDATA;
+  volatile uint32_t IF;
+  volatile uint32_t IEN;
+} ADC_TypeDef;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern I2C_TypeDef *const I2C0;
+extern ADC_TypeDef *const ADC0;
+extern DWT_Type *const DWT;
+extern CoreDebug_Type *const CoreDebug;
+
+typedef enum {
+  GPIO_EVEN_IRQn = 10,
+  I2C0_IRQn = 17,
+  GPIO_ODD_IRQn = 18,
+  ADC0_IRQn = 25
+} IRQn_Type;
+
+#define I2C_STATE_BUSY                  (0x1UL << 0)
+#define I2C_CMD_ABORT                   (0x1UL << 5)
+#define I2C_ROUTEPEN_SDAPEN             (0x1UL << 0)
+#define I2C_ROUTEPEN_SCLPEN             (0x1UL << 1)
+#define _I2C_ROUTELOC0_SDALOC_LOC14     0x0000000EUL
+#define _I2C_ROUTELOC0_SCLLOC_LOC14     0x00000E00UL
+
+#define I2C_IF_START                    (0x1UL << 0)
+#define I2C_IF_RSTART                   (0x1UL << 1)
+#define I2C_IF_ADDR                     (0x1UL << 2)
+#define I2C_IF_TXC                      (0x1UL << 3)
+#define I2C_IF_RXDATAV                  (0x1UL << 5)
+#define I2C_IF_ACK                      (0x1UL << 6)
+#define I2C_IF_NACK                     (0x1UL << 7)
+#define I2C_IF_MSTOP                    (0x1UL << 8)
+#define I2C_IF_ARBLOST                  (0x1UL << 9)
+#define I2C_IF_BUSERR                   (0x1UL << 10)
+#define I2C_IF_BUSHOLD                  (0x1UL << 11)
+#define I2C_IF_CLTO                     (0x1UL << 16)
+#define _I2C_IF_MASK                    0x0007FFFFUL
+
+#define ADC_STATUS_SINGLEACT            (0x1UL << 8)
+#define ADC_IF_SINGLE                   (0x1UL << 0)
+#define ADC_IEN_SINGLE                  (0x1UL << 0)
+
+#define CoreDebug_DEMCR_TRCENA_Msk      (0x1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk          (0x1UL << 0)
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+uint32_t SystemCoreClockGet(void);
+
+#define __DMB()                         __sync_synchronize()
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,16 @@
+/**
+ * @file em_emu.h
+ * @brief Host stub: energy management unit
+ */
+
+#ifndef EM_EMU_H
+#define EM_EMU_H
+
+#include "em_device.h"
+
+/**
+ * @brief Sleep in EM1 until the next event (advances the virtual clock)
+ */
+void EMU_EnterEM1(void);
+
+#endif // EM_EMU_H
@@ -0,0 +1,44 @@
+/**
+ * @file em_gpio.h
+ * @brief Host stub: GPIO
+ *
+ * Pin levels are owned by the simulation; inputs float high (pull-ups)
+ * unless a model drives them, see sim_gpio_set_input().
+ */
+
+#ifndef EM_GPIO_H
+#define EM_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_device.h"
+
+typedef enum {
+  gpioPortA = 0,
+  gpioPortB = 1,
+  gpioPortC = 2,
+  gpioPortD = 3,
+  gpioPortF = 5
+} GPIO_Port_TypeDef;
+
+typedef enum {
+  gpioModeDisabled,
+  gpioModeInput,
+  gpioModeInputPull,
+  gpioModeInputPullFilter,
+  gpioModePushPull,
+  gpioModeWiredAnd,
+  gpioModeWiredAndFilter,
+  gpioModeWiredAndPullUp,
+  gpioModeWiredAndPullUpFilter
+} GPIO_Mode_TypeDef;
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin,
+                     GPIO_Mode_TypeDef mode, unsigned int out);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo,
+                       bool risingEdge, bool fallingEdge, bool enable);
+
+#endif // EM_GPIO_H
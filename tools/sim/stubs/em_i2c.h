@@ -0,0 +1,68 @@
+/**
+ * @file em_i2c.h
+ * @brief Host stub: I2C master
+ *
+ * The device model attached at the address (sim_i2c_attach()) answers
+ * when the transfer starts; completion is signalled after the on-wire
+ * time at the configured clock.
+ */
+
+#ifndef EM_I2C_H
+#define EM_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_device.h"
+#include "em_gpio.h"
+
+#define I2C_FLAG_WRITE          0x0001
+#define I2C_FLAG_READ           0x0002
+#define I2C_FLAG_WRITE_READ     0x0004
+#define I2C_FLAG_WRITE_WRITE    0x0008
+
+#define I2C_FREQ_STANDARD_MAX   92000
+
+typedef enum {
+  i2cClockHLRStandard,
+  i2cClockHLRAsymetric,
+  i2cClockHLRFast
+} I2C_ClockHLR_TypeDef;
+
+typedef struct {
+  bool enable;
+  bool master;
+  uint32_t refFreq;
+  uint32_t freq;
+  I2C_ClockHLR_TypeDef clhr;
+} I2C_Init_TypeDef;
+
+#define I2C_INIT_DEFAULT  { true, true, 0, I2C_FREQ_STANDARD_MAX, i2cClockHLRStandard }
+
+typedef struct {
+  uint16_t addr;
+  uint16_t flags;
+  struct {
+    uint8_t *data;
+    uint16_t len;
+  } buf[2];
+} I2C_TransferSeq_TypeDef;
+
+typedef enum {
+  i2cTransferInProgress = 1,
+  i2cTransferDone = 0,
+  i2cTransferNack = -1,
+  i2cTransferBusErr = -2,
+  i2cTransferArbLost = -3,
+  i2cTransferUsageFault = -4,
+  i2cTransferSwFault = -5
+} I2C_TransferReturn_TypeDef;
+
+void I2C_Init(I2C_TypeDef *i2c, const I2C_Init_TypeDef *init);
+void I2C_Enable(I2C_TypeDef *i2c, bool enable);
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq);
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c);
+void I2C_IntEnable(I2C_TypeDef *i2c, uint32_t flags);
+void I2C_IntDisable(I2C_TypeDef *i2c, uint32_t flags);
+void I2C_IntClear(I2C_TypeDef *i2c, uint32_t flags);
+
+#endif // EM_I2C_H
@@ -0,0 +1,17 @@
+/**
+ * @file gpiointerrupt.h
+ * @brief Host stub: GPIO interrupt dispatcher
+ */
+
+#ifndef GPIOINTERRUPT_H
+#define GPIOINTERRUPT_H
+
+#include <stdint.h>
+
+typedef void (*GPIOINT_IrqCallbackPtr_t)(uint8_t intNo);
+
+void GPIOINT_Init(void);
+void GPIOINT_CallbackRegister(uint8_t intNo, GPIOINT_IrqCallbackPtr_t callbackPtr);
+void GPIOINT_CallbackUnRegister(uint8_t intNo);
+
+#endif // GPIOINTERRUPT_H
@@ -0,0 +1,25 @@
+/**
+ * @file sl_cli.h
+ * @brief Host stub: CLI command arguments
+ *
+ * The simulation calls the firmware's CLI handlers directly with an
+ * argv-style argument list, see sim_cli().
+ */
+
+#ifndef SL_CLI_H
+#define SL_CLI_H
+
+#include <stdint.h>
+
+typedef struct {
+  int argc;
+  char **argv;
+} sl_cli_command_arg_t;
+
+int sl_cli_get_argument_count(sl_cli_command_arg_t *arguments);
+uint8_t sl_cli_get_argument_uint8(sl_cli_command_arg_t *arguments, int index);
+uint16_t sl_cli_get_argument_uint16(sl_cli_command_arg_t *arguments, int index);
+uint32_t sl_cli_get_argument_uint32(sl_cli_command_arg_t *arguments, int index);
+char *sl_cli_get_argument_string(sl_cli_command_arg_t *arguments, int index);
+
+#endif // SL_CLI_H
@@ -0,0 +1,13 @@
+/**
+ * @file sl_component_catalog.h
+ * @brief Host stub: component catalog of the simulated build
+ *
+ * Power manager present; no LED, so the firmware's LED paths are left out.
+ */
+
+#ifndef SL_COMPONENT_CATALOG_H
+#define SL_COMPONENT_CATALOG_H
+
+#define SL_CATALOG_POWER_MANAGER_PRESENT
+
+#endif // SL_COMPONENT_CATALOG_H
@@ -0,0 +1,19 @@
+/**
+ * @file sl_iostream.h
+ * @brief Host stub: console stream (stdout when the console is enabled)
+ */
+
+#ifndef SL_IOSTREAM_H
+#define SL_IOSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sl_status.h"
+
+typedef struct sl_iostream sl_iostream_t;
+
+#define SL_IOSTREAM_STDOUT  ((sl_iostream_t *)0)
+
+sl_status_t sl_iostream_write(sl_iostream_t *stream, const void *buffer, size_t buffer_length);
+
+#endif // SL_IOSTREAM_H
@@ -0,0 +1,54 @@
+/**
+ * @file sl_power_manager.h
+ * @brief Host stub: power manager
+ *
+ * Requirements and transition events behave as in the SDK; the
+ * simulation decides the sleep mode from them each time it idles.
+ */
+
+#ifndef SL_POWER_MANAGER_H
+#define SL_POWER_MANAGER_H
+
+#include <stdint.h>
+
+typedef enum {
+  SL_POWER_MANAGER_EM0 = 0,
+  SL_POWER_MANAGER_EM1,
+  SL_POWER_MANAGER_EM2,
+  SL_POWER_MANAGER_EM3,
+  SL_POWER_MANAGER_EM4
+} sl_power_manager_em_t;
+
+typedef uint32_t sl_power_manager_em_transition_event_t;
+
+#define SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM0  (1 << 0)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM0   (1 << 1)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM1  (1 << 2)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM1   (1 << 3)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM2  (1 << 4)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM2   (1 << 5)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM3  (1 << 6)
+#define SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM3   (1 << 7)
+
+typedef void (*sl_power_manager_em_transition_on_event_t)(sl_power_manager_em_t from,
+                                                          sl_power_manager_em_t to);
+
+typedef struct {
+  sl_power_manager_em_transition_event_t event_mask;
+  sl_power_manager_em_transition_on_event_t on_event;
+} sl_power_manager_em_transition_event_info_t;
+
+typedef struct sl_power_manager_em_transition_event_handle {
+  struct sl_power_manager_em_transition_event_handle *next;
+  const sl_power_manager_em_transition_event_info_t *info;
+} sl_power_manager_em_transition_event_handle_t;
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em);
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em);
+void sl_power_manager_subscribe_em_transition_event(
+  sl_power_manager_em_transition_event_handle_t *event_handle,
+  const sl_power_manager_em_transition_event_info_t *event_info);
+void sl_power_manager_unsubscribe_em_transition_event(
+  sl_power_manager_em_transition_event_handle_t *event_handle);
+
+#endif // SL_POWER_MANAGER_H
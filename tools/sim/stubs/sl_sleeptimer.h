@@ -0,0 +1,63 @@
+/**
+ * @file sl_sleeptimer.h
+ * @brief Host stub: sleeptimer on the simulation's virtual clock
+ *
+ * Same 32768 Hz tick as the RTCC-backed driver. Each handle carries the
+ * event that puts it on the simulation queue.
+ */
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_status.h"
+#include "sim_event.h"
+
+typedef struct sl_sleeptimer_timer_handle sl_sleeptimer_timer_handle_t;
+
+typedef void (*sl_sleeptimer_timer_callback_t)(sl_sleeptimer_timer_handle_t *handle,
+                                               void *data);
+
+struct sl_sleeptimer_timer_handle {
+  void *callback_data;
+  sl_sleeptimer_timer_callback_t callback;
+  uint32_t timeout_periodic;        // Ticks; 0 for a one-shot timer
+  SimEvent_t event;
+};
+
+sl_status_t sl_sleeptimer_start_timer(sl_sleeptimer_timer_handle_t *handle,
+                                      uint32_t timeout,
+                                      sl_sleeptimer_timer_callback_t callback,
+                                      void *callback_data,
+                                      uint8_t priority,
+                                      uint16_t option_flags);
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags);
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                                  uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback,
+                                                  void *callback_data,
+                                                  uint8_t priority,
+                                                  uint16_t option_flags);
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle);
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle,
+                                           bool *running);
+sl_status_t sl_sleeptimer_get_timer_time_remaining(sl_sleeptimer_timer_handle_t *handle,
+                                                   uint32_t *time);
+
+void sl_sleeptimer_delay_millisecond(uint16_t time_ms);
+
+uint32_t sl_sleeptimer_get_tick_count(void);
+uint64_t sl_sleeptimer_get_tick_count64(void);
+uint32_t sl_sleeptimer_get_timer_frequency(void);
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick);
+uint64_t sl_sleeptimer_tick64_to_ms(uint64_t tick);
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms);
+sl_status_t sl_sleeptimer_ms32_to_tick(uint32_t time_ms, uint32_t *tick);
+
+#endif // SL_SLEEPTIMER_H
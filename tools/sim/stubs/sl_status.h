@@ -0,0 +1,20 @@
+/**
+ * @file sl_status.h
+ * @brief Host stub: platform status codes
+ */
+
+#ifndef SL_STATUS_H
+#define SL_STATUS_H
+
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                0x0000
+#define SL_STATUS_FAIL              0x0001
+#define SL_STATUS_INVALID_STATE     0x0002
+#define SL_STATUS_NOT_READY         0x0003
+#define SL_STATUS_NULL_POINTER      0x0022
+#define SL_STATUS_INVALID_PARAMETER 0x0021
+
+#endif // SL_STATUS_H
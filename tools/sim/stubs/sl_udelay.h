@@ -0,0 +1,13 @@
+/**
+ * @file sl_udelay.h
+ * @brief Host stub: busy-wait delay (advances the virtual clock in EM0)
+ */
+
+#ifndef SL_UDELAY_H
+#define SL_UDELAY_H
+
+#include <stdint.h>
+
+void sl_udelay_wait(unsigned us);
+
+#endif // SL_UDELAY_H
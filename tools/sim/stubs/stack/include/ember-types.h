@@ -0,0 +1,6 @@
+/**
+ * @file ember-types.h
+ * @brief Host stub: stack types (all in af.h)
+ */
+
+#include "../../af.h"
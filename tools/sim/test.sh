@@ -0,0 +1,64 @@
+#!/bin/bash
+set -euo pipefail
+
+echo "=========================================="
+echo "  EFR32MG1 SED Host Tests"
+echo "=========================================="
+
+# Builds every tools/sim/tests/test_*.c as its own program against the
+# firmware sources and the simulation harness (as tools/sim/build.sh does)
+# and runs it. Each test checks firmware behaviour in virtual time and
+# exits non-zero on a failed check.
+#
+# Usage: tools/sim/test.sh [name...]
+#   names default to every test (test_foo.c is "foo"); SIM_VERBOSE=1 shows
+#   the firmware console
+#
+# Output: exit status 1 if any test fails to build or fails a check
+
+REPO_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+SIM_DIR="$REPO_DIR/tools/sim"
+TEST_DIR="$SIM_DIR/tests"
+BUILD_DIR="$REPO_DIR/build/sim/tests"
+
+CC="${CC:-gcc}"
+CFLAGS="${CFLAGS:--O2 -g}"
+
+mkdir -p "$BUILD_DIR"
+
+COMMON_SOURCES=("$REPO_DIR"/src/*.c "$SIM_DIR"/sim.c "$SIM_DIR"/sim_hw.c \
+                "$SIM_DIR"/sim_sht31.c "$SIM_DIR"/sim_stack.c "$TEST_DIR"/test.c)
+
+SELECTED=("$@")
+FAILED=()
+
+for source in "$TEST_DIR"/test_*.c; do
+    name="$(basename "$source" .c)"
+    name="${name#test_}"
+
+    if [ ${#SELECTED[@]} -gt 0 ] && [[ ! " ${SELECTED[*]} " =~ " $name " ]]; then
+        continue
+    fi
+
+    echo ""
+    echo "[$name]"
+
+    if ! $CC -std=gnu99 $CFLAGS -Wall \
+            -I "$SIM_DIR/stubs" -I "$SIM_DIR" -I "$TEST_DIR" -I "$REPO_DIR/src" \
+            "${COMMON_SOURCES[@]}" "$source" \
+            -lm -o "$BUILD_DIR/$name"; then
+        FAILED+=("$name (build)")
+        continue
+    fi
+
+    if ! "$BUILD_DIR/$name"; then
+        FAILED+=("$name")
+    fi
+done
+
+echo ""
+if [ ${#FAILED[@]} -ne 0 ]; then
+    echo "✗ Failed: ${FAILED[*]}"
+    exit 1
+fi
+echo "✓ All tests passed"
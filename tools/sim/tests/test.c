@@ -0,0 +1,64 @@
+/**
+ * @file test.c
+ * @brief Host tests: shared checks and boot helpers
+ */
+
+#include "test.h"
+#include "sht31.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static uint32_t checks = 0;
+static uint32_t failures = 0;
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+void test_check(bool ok, const char *file, int line, const char *format, ...)
+{
+  checks++;
+
+  if (ok) {
+    return;
+  }
+
+  va_list args;
+
+  failures++;
+  fprintf(stderr, "FAIL %s:%d [%.3f s]: ", file, line, sim_now_us() / 1e6);
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fprintf(stderr, "\n");
+}
+
+void test_boot(bool joined, const SimI2cDevice_t *sensor)
+{
+  sim_config()->startJoined = joined;
+  sim_console_enable(getenv("SIM_VERBOSE") != NULL);
+
+  sim_stack_init();
+  sim_sht31_init();
+  if (sensor != NULL) {
+    sim_i2c_attach(SHT31_I2C_ADDR, sensor);
+  }
+
+  sim_stack_boot();
+}
+
+void test_run_ms(uint64_t ms)
+{
+  sim_run_until(sim_now_us() + ms * 1000u);
+}
+
+int test_finish(void)
+{
+  printf("%u checks, %u failed\n", checks, failures);
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file test.h
+ * @brief Host tests: checks and boot helpers shared by tools/sim/tests
+ *
+ * Each test_*.c is its own program, linked with the firmware sources and
+ * the simulation harness by tools/sim/test.sh. A failed check prints where
+ * and why and the test carries on; main() returns test_finish().
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim.h"
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+/**
+ * @brief Check a condition; on failure print the location and message
+ */
+#define TEST_CHECK(condition, ...) \
+  test_check((condition), __FILE__, __LINE__, __VA_ARGS__)
+
+void test_check(bool ok, const char *file, int line, const char *format, ...)
+  __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Boot the firmware on the simulation
+ * Stack model, then the SHT31 model (or @p sensor at the SHT31 address when
+ * not NULL), then the framework init callbacks. Console output follows
+ * SIM_VERBOSE in the environment.
+ * @param joined Boot with network tokens (joined) or without
+ * @param sensor Replacement bus device, or NULL for the SHT31 model
+ */
+void test_boot(bool joined, const SimI2cDevice_t *sensor);
+
+/**
+ * @brief Run the firmware main loop for @p ms of virtual time
+ */
+void test_run_ms(uint64_t ms);
+
+/**
+ * @brief Print the tally
+ * @return Process exit status: 0 when every check passed
+ */
+int test_finish(void);
+
+#endif // TEST_H
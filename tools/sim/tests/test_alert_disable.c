@@ -0,0 +1,80 @@
+/**
+ * @file test_alert_disable.c
+ * @brief Host test: leaving ALERT mode while the sensor is busy
+ *
+ * sht31_alert_disable() cannot stop periodic acquisition while a fetch or
+ * a limit update owns the sensor. It must then report failure with ALERT
+ * still enabled, and the application must retry until the sensor is back
+ * in single-shot mode.
+ */
+
+#include "test.h"
+#include "app.h"
+#include "sht31.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_SETTLE_MS              1000
+// Boot ends off the sample schedule, so ALERT is not enabled mid-sample
+#define TEST_BOOT_MS                (APP_SENSOR_READ_PERIOD_MS * 2 + TEST_SETTLE_MS)
+#define TEST_RETRY_MS               (APP_SENSOR_ALERT_RETRY_MS * 3)
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(true, NULL);
+  test_run_ms(TEST_BOOT_MS);
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK, "sensor health %d after boot",
+             sht31_get_health());
+
+  app_set_sensor_alert_mode(true);
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(sht31_alert_is_enabled(), "ALERT not enabled");
+  TEST_CHECK(sht31_get_mode() == SHT31_MODE_PERIODIC, "mode %d with ALERT enabled",
+             sht31_get_mode());
+
+  // Idle sensor: disables at once
+  TEST_CHECK(sht31_alert_disable(), "disable failed on an idle sensor");
+  TEST_CHECK(!sht31_alert_is_enabled(), "ALERT still enabled");
+  TEST_CHECK(sht31_get_mode() == SHT31_MODE_SINGLE_SHOT, "mode %d after disable",
+             sht31_get_mode());
+
+  app_set_sensor_alert_mode(true);
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(sht31_alert_is_enabled(), "ALERT not re-enabled");
+
+  // Fetch in flight: the driver refuses and leaves everything as it was
+  app_start_sensor_measurement();
+  TEST_CHECK(sht31_is_busy(), "no fetch in flight");
+  TEST_CHECK(!sht31_alert_disable(), "disable accepted during a fetch");
+  TEST_CHECK(sht31_alert_is_enabled(), "ALERT dropped by a refused disable");
+  TEST_CHECK(sht31_get_mode() == SHT31_MODE_PERIODIC, "mode %d after a refused disable",
+             sht31_get_mode());
+  TEST_CHECK(!sht31_set_alert_window(2100, 4500), "window update accepted during a fetch");
+
+  // The application retries once the fetch is done
+  app_start_sensor_measurement();
+  TEST_CHECK(sht31_is_busy(), "no fetch in flight");
+  app_set_sensor_alert_mode(false);
+  TEST_CHECK(sht31_alert_is_enabled(), "disabled while the fetch was in flight");
+  test_run_ms(TEST_RETRY_MS);
+  TEST_CHECK(!sht31_alert_is_enabled(), "ALERT still enabled after the retry");
+  TEST_CHECK(sht31_get_mode() == SHT31_MODE_SINGLE_SHOT, "mode %d after the retry",
+             sht31_get_mode());
+
+  // Single-shot sampling carries on afterwards
+  Sht31Stats_t before;
+  Sht31Stats_t after;
+
+  sht31_get_stats(&before);
+  test_run_ms(APP_SENSOR_READ_PERIOD_MS + APP_SENSOR_READ_TOLERANCE_MS + TEST_SETTLE_MS);
+  sht31_get_stats(&after);
+  TEST_CHECK(after.conversionMs > before.conversionMs, "no conversion after leaving ALERT");
+
+  return test_finish();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test_alert_window.c
+ * @brief Host test: ALERT keeps firing after a move the filter skips
+ *
+ * The sensor compares its results against alert limits that keep only the
+ * top 9 bits of temperature (~0.34 °C). Around 20.8 °C a window truncated
+ * to that resolution asserts ALERT on a 0.2 °C drift, which the report
+ * filter then skips. Unless the window is written again after that sample,
+ * ALERT stays asserted and a real move later raises no edge, so it waits
+ * for the backstop read. Here the drift must not be written nor keep
+ * ALERT firing, and the move after it must be written within a few
+ * ALERT-mode conversions. Once re-centred on the move, ALERT must release
+ * again.
+ */
+
+#include "test.h"
+#include "app.h"
+#include "sht31.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_SETTLE_MS              1000
+// Boot ends off the sample schedule, so ALERT is not enabled mid-sample
+#define TEST_BOOT_MS                (APP_SENSOR_READ_PERIOD_MS * 2 + TEST_SETTLE_MS)
+#define TEST_DRIFT_MS               60000
+#define TEST_MOVE_MS                10000   // A few conversions at 0.5 mps
+#define TEST_DRIFT_MAX_ALERTS       1       // The drift itself, at most
+
+#define TEST_TEMPERATURE_C          20.8    // High limit truncated by most of a step
+#define TEST_DRIFT_C                0.2     // Inside the hysteresis
+#define TEST_MOVE_C                 0.9     // To 21.7 C, where the clear limits are one step apart
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void set_temperature(double temperatureC);
+static uint32_t count_writes(void);
+static int64_t last_write(void);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(true, NULL);
+  set_temperature(TEST_TEMPERATURE_C);
+  test_run_ms(TEST_BOOT_MS);
+  TEST_CHECK(last_write() == (int64_t)(TEST_TEMPERATURE_C * 100),
+             "temperature %lld written after boot", (long long)last_write());
+
+  app_set_sensor_alert_mode(true);
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(sht31_alert_is_enabled(), "ALERT not enabled");
+
+  // Drift inside the hysteresis: nothing written, and ALERT released
+  uint32_t writesBefore = count_writes();
+  SimStats_t before;
+  SimStats_t after;
+
+  sim_get_stats(&before);
+  set_temperature(TEST_TEMPERATURE_C + TEST_DRIFT_C);
+  test_run_ms(TEST_DRIFT_MS);
+  sim_get_stats(&after);
+  TEST_CHECK(count_writes() == writesBefore, "%u temperature writes on a %.1f C drift",
+             count_writes() - writesBefore, TEST_DRIFT_C);
+  uint32_t alerts = after.wakesBySource[SIM_SOURCE_GPIO] - before.wakesBySource[SIM_SOURCE_GPIO];
+  TEST_CHECK(alerts <= TEST_DRIFT_MAX_ALERTS, "%u ALERT wakes in %u s of a %.1f C drift", alerts,
+             TEST_DRIFT_MS / 1000u, TEST_DRIFT_C);
+
+  // A real move afterwards still raises ALERT and is written
+  set_temperature(TEST_TEMPERATURE_C + TEST_MOVE_C);
+  test_run_ms(TEST_MOVE_MS);
+  TEST_CHECK(count_writes() > writesBefore, "no temperature write %u s after a %.1f C move",
+             TEST_MOVE_MS / 1000u, TEST_MOVE_C);
+  TEST_CHECK(last_write() == (int64_t)((TEST_TEMPERATURE_C + TEST_MOVE_C) * 100 + 0.5),
+             "temperature %lld written after the move", (long long)last_write());
+
+  sim_get_stats(&before);
+  test_run_ms(TEST_DRIFT_MS);
+  sim_get_stats(&after);
+  alerts = after.wakesBySource[SIM_SOURCE_GPIO] - before.wakesBySource[SIM_SOURCE_GPIO];
+  TEST_CHECK(alerts == 0, "%u ALERT wakes in %u s after the move", alerts, TEST_DRIFT_MS / 1000u);
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void set_temperature(double temperatureC)
+{
+  SimSht31Signal_t signal;
+
+  sim_sht31_get_signal(&signal);
+  signal.shape = SIM_SHT31_SHAPE_CONSTANT;
+  signal.temperatureC = temperatureC;
+  signal.noise = false;
+  sim_sht31_set_signal(&signal);
+}
+
+/**
+ * @brief Temperature MeasuredValue writes so far
+ */
+static uint32_t count_writes(void)
+{
+  uint32_t writes = 0;
+
+  for (uint32_t i = 0; i < sim_stack_get_history_count(); i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+
+    if (write->clusterId == ZCL_TEMP_MEASUREMENT_CLUSTER_ID && write->attributeId == 0x0000
+        && write->manufacturerCode == 0) {
+      writes++;
+    }
+  }
+
+  return writes;
+}
+
+/**
+ * @brief Last temperature MeasuredValue written, -1 if none
+ */
+static int64_t last_write(void)
+{
+  for (uint32_t i = sim_stack_get_history_count(); i > 0; i--) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i - 1);
+
+    if (write->clusterId == ZCL_TEMP_MEASUREMENT_CLUSTER_ID && write->attributeId == 0x0000
+        && write->manufacturerCode == 0) {
+      return write->value;
+    }
+  }
+
+  return -1;
+}
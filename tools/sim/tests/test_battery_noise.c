@@ -0,0 +1,118 @@
+/**
+ * @file test_battery_noise.c
+ * @brief Host test: battery percentage stability with a noisy ADC
+ *
+ * The simulated ADC adds Gaussian noise to every 12-bit conversion. With the
+ * driver's hardware oversampling the reported percentage must hold still at
+ * a constant battery voltage: no more than one percent apart over many
+ * measurements, and the averaged voltage must scatter well below the noise
+ * of a single conversion.
+ */
+
+#include "test.h"
+#include "battery.h"
+#include <math.h>
+#include <stdio.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_NOISE_LSB              3.0     // Per-conversion RMS, 12-bit codes
+#define TEST_MEASUREMENTS           200
+#define TEST_PERCENT_SPREAD_MAX     1
+#define TEST_MEASUREMENT_MS         10      // Conversion done well within this
+
+// 12-bit code of AVDD/3 against the 1.25 V reference, in pack millivolts
+#define TEST_MV_PER_LSB             (3750.0 / 4096.0)
+
+// Alkaline pack voltages across the curve, on and between table points
+static const uint16_t testVoltages[] = {
+  2150, 2300, 2400, 2550, 2580, 2700, 2800, 2900, 3000
+};
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static bool measured = false;
+static uint16_t measuredMv = 0;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void measurement_done(uint16_t voltage_mv);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(false, NULL);
+  sim_config()->adcNoiseLsb = TEST_NOISE_LSB;
+  battery_set_chemistry(BATTERY_CHEMISTRY_ALKALINE);
+
+  for (size_t v = 0; v < sizeof(testVoltages) / sizeof(testVoltages[0]); v++) {
+    uint8_t minPercent = 100;
+    uint8_t maxPercent = 0;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    uint32_t count = 0;
+
+    sim_config()->batteryMv = testVoltages[v];
+
+    for (uint32_t i = 0; i < TEST_MEASUREMENTS; i++) {
+      measured = false;
+      if (!battery_start_measurement(measurement_done)) {
+        TEST_CHECK(false, "%u mV: measurement %u refused", testVoltages[v], i);
+        test_run_ms(TEST_MEASUREMENT_MS);
+        continue;
+      }
+      test_run_ms(TEST_MEASUREMENT_MS);
+      if (!measured) {
+        TEST_CHECK(false, "%u mV: measurement %u never completed", testVoltages[v], i);
+        continue;
+      }
+
+      uint8_t percent = battery_voltage_to_percentage(measuredMv);
+      minPercent = (percent < minPercent) ? percent : minPercent;
+      maxPercent = (percent > maxPercent) ? percent : maxPercent;
+      sum += measuredMv;
+      sumSquares += (double)measuredMv * measuredMv;
+      count++;
+    }
+
+    if (count == 0) {
+      continue;
+    }
+
+    double mean = sum / count;
+    double sigma = sqrt(fmax(0.0, sumSquares / count - mean * mean));
+
+    TEST_CHECK(maxPercent - minPercent <= TEST_PERCENT_SPREAD_MAX,
+               "%u mV: percentage %u..%u", testVoltages[v], minPercent, maxPercent);
+    TEST_CHECK(fabs(mean - testVoltages[v]) <= TEST_MV_PER_LSB,
+               "%u mV: mean %.1f mV", testVoltages[v], mean);
+    TEST_CHECK(sigma <= TEST_NOISE_LSB * TEST_MV_PER_LSB / 2.0,
+               "%u mV: %.2f mV RMS, single conversion %.2f mV", testVoltages[v], sigma,
+               TEST_NOISE_LSB * TEST_MV_PER_LSB);
+
+    printf("%u mV: %u..%u %%, %.2f mV RMS (single conversion %.2f mV)\n",
+           testVoltages[v], minPercent, maxPercent, sigma,
+           TEST_NOISE_LSB * TEST_MV_PER_LSB);
+  }
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void measurement_done(uint16_t voltage_mv)
+{
+  measured = true;
+  measuredMv = voltage_mv;
+}
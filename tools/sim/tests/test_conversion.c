@@ -0,0 +1,108 @@
+/**
+ * @file test_conversion.c
+ * @brief Host test: SHT31 raw-to-ZCL conversion, every raw input
+ *
+ * Checks sht31_raw_to_centi_celsius() and sht31_raw_to_centi_rh() against
+ * the datasheet formulas in double precision for all 65536 raw values.
+ * The integer results must equal the reference rounded to nearest, stay
+ * within the datasheet range and never decrease as the raw value rises.
+ */
+
+#include "test.h"
+#include "sht31.h"
+#include <math.h>
+#include <stdio.h>
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static double reference_centi_celsius(uint16_t raw);
+static double reference_centi_rh(uint16_t raw);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  uint32_t temperatureMismatches = 0;
+  uint32_t humidityMismatches = 0;
+  double worstTemperatureError = 0.0;
+  double worstHumidityError = 0.0;
+  int16_t lastTemperature = INT16_MIN;
+  uint16_t lastHumidity = 0;
+
+  for (uint32_t raw = 0; raw <= 0xFFFF; raw++) {
+    int16_t temperature = sht31_raw_to_centi_celsius((uint16_t)raw);
+    uint16_t humidity = sht31_raw_to_centi_rh((uint16_t)raw);
+    double temperatureRef = reference_centi_celsius((uint16_t)raw);
+    double humidityRef = reference_centi_rh((uint16_t)raw);
+    double temperatureError = fabs(temperature - temperatureRef);
+    double humidityError = fabs(humidity - humidityRef);
+
+    if (temperature != (int16_t)lround(temperatureRef)) {
+      if (temperatureMismatches++ == 0) {
+        TEST_CHECK(false, "raw 0x%04X: %d cC, reference %.4f", raw, temperature,
+                   temperatureRef);
+      }
+    }
+    if (humidity != (uint16_t)lround(humidityRef)) {
+      if (humidityMismatches++ == 0) {
+        TEST_CHECK(false, "raw 0x%04X: %u c%%RH, reference %.4f", raw, humidity,
+                   humidityRef);
+      }
+    }
+
+    if (temperatureError > worstTemperatureError) {
+      worstTemperatureError = temperatureError;
+    }
+    if (humidityError > worstHumidityError) {
+      worstHumidityError = humidityError;
+    }
+
+    if (temperature < lastTemperature || humidity < lastHumidity) {
+      TEST_CHECK(false, "raw 0x%04X: output decreased", raw);
+    }
+    lastTemperature = temperature;
+    lastHumidity = humidity;
+  }
+
+  TEST_CHECK(temperatureMismatches == 0, "%u temperature mismatches",
+             temperatureMismatches);
+  TEST_CHECK(humidityMismatches == 0, "%u humidity mismatches", humidityMismatches);
+  TEST_CHECK(worstTemperatureError <= 0.5, "temperature off by %.4f cC",
+             worstTemperatureError);
+  TEST_CHECK(worstHumidityError <= 0.5, "humidity off by %.4f c%%RH", worstHumidityError);
+
+  // Datasheet range end points
+  TEST_CHECK(sht31_raw_to_centi_celsius(0x0000) == -4500, "T(0x0000) != -45.00");
+  TEST_CHECK(sht31_raw_to_centi_celsius(0xFFFF) == 13000, "T(0xFFFF) != 130.00");
+  TEST_CHECK(sht31_raw_to_centi_rh(0x0000) == 0, "RH(0x0000) != 0.00");
+  TEST_CHECK(sht31_raw_to_centi_rh(0xFFFF) == 10000, "RH(0xFFFF) != 100.00");
+
+  printf("65536 inputs, worst error %.4f cC, %.4f c%%RH\n",
+         worstTemperatureError, worstHumidityError);
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Datasheet formula: T = -45 + 175 * raw / (2^16 - 1) °C
+ */
+static double reference_centi_celsius(uint16_t raw)
+{
+  return (-45.0 + 175.0 * raw / 65535.0) * 100.0;
+}
+
+/**
+ * @brief Datasheet formula: RH = 100 * raw / (2^16 - 1) %
+ */
+static double reference_centi_rh(uint16_t raw)
+{
+  return (100.0 * raw / 65535.0) * 100.0;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test_conversion_sleep.c
+ * @brief Host test: the core sleeps while the SHT31 converts
+ *
+ * A stand-in sensor at the SHT31 address timestamps every single-shot
+ * measure command and the read-back that follows it. Between the two the
+ * core must be asleep: EM0 and EM1 together stay under a millisecond (the
+ * command transfer and one main-loop pass) and the rest of the window is
+ * EM2. The measurement started from the init callbacks overlaps the rest of
+ * start-up (battery ADC, network restore), so only windows opened after
+ * boot are checked.
+ */
+
+#include "test.h"
+#include "sht31.h"
+#include <stdio.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_HOURS                  1
+#define TEST_AWAKE_MAX_US           1000    // Command transfer + one pass
+#define TEST_MIN_WINDOWS            300     // One sample per 10 s, less start-up
+
+// Results the stand-in returns: ~25 °C, 50 %RH
+#define TEST_RAW_TEMPERATURE        0x6666
+#define TEST_RAW_HUMIDITY           0x8000
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static bool booted = false;
+static bool converting = false;
+static uint8_t commandLsb = 0;
+static uint64_t commandUs = 0;
+static SimStats_t commandStats;
+
+static uint32_t windows = 0;
+static uint64_t worstAwakeUs = 0;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static bool sensor_write(const uint8_t *data, uint16_t len);
+static bool sensor_read(uint8_t *data, uint16_t len);
+static uint32_t conversion_us(uint8_t lsb);
+static uint8_t crc8(const uint8_t *data, uint8_t len);
+static void put_word(uint8_t *out, uint16_t word);
+
+static const SimI2cDevice_t sensor = {
+  .write = sensor_write,
+  .read = sensor_read
+};
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(true, &sensor);
+  booted = true;
+  test_run_ms((uint64_t)TEST_HOURS * 3600u * 1000u);
+
+  TEST_CHECK(windows >= TEST_MIN_WINDOWS, "only %u conversion windows seen", windows);
+  printf("%u conversion windows, worst awake %llu us\n",
+         windows, (unsigned long long)worstAwakeUs);
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static bool sensor_write(const uint8_t *data, uint16_t len)
+{
+  if (len == 2 && data[0] == SHT31_CMD_READ_MSB) {
+    converting = booted;
+    commandLsb = data[1];
+    commandUs = sim_now_us();
+    sim_get_stats(&commandStats);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Read-back: close the window and check where the time went
+ */
+static bool sensor_read(uint8_t *data, uint16_t len)
+{
+  if (len != 6) {
+    return false;
+  }
+
+  put_word(&data[0], TEST_RAW_TEMPERATURE);
+  put_word(&data[3], TEST_RAW_HUMIDITY);
+
+  if (!converting) {
+    return true;
+  }
+
+  SimStats_t now;
+  sim_get_stats(&now);
+  converting = false;
+  windows++;
+
+  uint64_t windowUs = sim_now_us() - commandUs;
+  uint64_t awakeUs = (now.residencyUs[SIM_MODE_EM0] - commandStats.residencyUs[SIM_MODE_EM0])
+                     + (now.residencyUs[SIM_MODE_EM1] - commandStats.residencyUs[SIM_MODE_EM1]);
+  uint64_t sleptUs = now.residencyUs[SIM_MODE_EM2] - commandStats.residencyUs[SIM_MODE_EM2];
+
+  if (awakeUs > worstAwakeUs) {
+    worstAwakeUs = awakeUs;
+  }
+
+  TEST_CHECK(windowUs >= conversion_us(commandLsb),
+             "read %llu us after command 0x24%02X, before the conversion ends",
+             (unsigned long long)windowUs, commandLsb);
+  TEST_CHECK(awakeUs <= TEST_AWAKE_MAX_US,
+             "%llu us awake in a %llu us conversion window",
+             (unsigned long long)awakeUs, (unsigned long long)windowUs);
+  TEST_CHECK(sleptUs + awakeUs == windowUs,
+             "window %llu us, EM2 %llu us + awake %llu us",
+             (unsigned long long)windowUs, (unsigned long long)sleptUs,
+             (unsigned long long)awakeUs);
+
+  return true;
+}
+
+/**
+ * @brief Datasheet maximum conversion time per single-shot command
+ */
+static uint32_t conversion_us(uint8_t lsb)
+{
+  switch (lsb) {
+    case SHT31_CMD_READ_LOW_LSB:
+      return 4000;
+    case SHT31_CMD_READ_MEDIUM_LSB:
+      return 6000;
+    default:
+      return 15000;
+  }
+}
+
+static uint8_t crc8(const uint8_t *data, uint8_t len)
+{
+  uint8_t crc = 0xFF;
+
+  for (uint8_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+
+  return crc;
+}
+
+static void put_word(uint8_t *out, uint16_t word)
+{
+  out[0] = (uint8_t)(word >> 8);
+  out[1] = (uint8_t)(word & 0xFF);
+  out[2] = crc8(out, 2);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_deferred_work.c
+ * @brief Host test: deferred work never runs in interrupt context
+ *
+ * Items posted from an interrupt run from the main loop, in order. Posting
+ * into a full ring drops the item and counts an overflow instead of running
+ * the handler there and then. Posts from thread context run at once.
+ */
+
+#include "test.h"
+#include "deferred_work.h"
+#include "em_core.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_EXTRA_POSTS            3       // Beyond a full ring
+#define TEST_DRAIN_MS               10
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static SimEvent_t irqEvent;
+static uint32_t postsRefused = 0;
+static uint32_t ran = 0;
+static uint32_t ranInIrq = 0;
+static uint32_t outOfOrder = 0;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void irq_handler(void *context);
+static void work(uint32_t arg0, uint32_t arg1);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(false, NULL);
+  deferred_work_reset_stats();
+
+  // Interrupt that posts more than the ring holds
+  sim_event_init(&irqEvent, irq_handler, NULL, SIM_SOURCE_GPIO);
+  sim_event_schedule(&irqEvent, 1000);
+  test_run_ms(TEST_DRAIN_MS);
+
+  DeferredWorkStats_t stats;
+  deferred_work_get_stats(&stats);
+
+  TEST_CHECK(ranInIrq == 0, "%u handlers ran in interrupt context", ranInIrq);
+  TEST_CHECK(ran == DEFERRED_WORK_RING_SIZE, "%u of %u queued items ran", ran,
+             DEFERRED_WORK_RING_SIZE);
+  TEST_CHECK(outOfOrder == 0, "%u items ran out of order", outOfOrder);
+  TEST_CHECK(postsRefused == TEST_EXTRA_POSTS, "%u posts refused, expected %u", postsRefused,
+             TEST_EXTRA_POSTS);
+  TEST_CHECK(stats.overflows == TEST_EXTRA_POSTS, "%u overflows counted", stats.overflows);
+  TEST_CHECK(stats.posted == DEFERRED_WORK_RING_SIZE, "%u posted", stats.posted);
+  TEST_CHECK(stats.highWater == DEFERRED_WORK_RING_SIZE, "high water %u", stats.highWater);
+
+  // The ring is usable again once drained
+  ran = 0;
+  sim_event_schedule(&irqEvent, 1000);
+  test_run_ms(TEST_DRAIN_MS);
+  TEST_CHECK(ran == DEFERRED_WORK_RING_SIZE, "%u items ran after the overflow", ran);
+
+  // Thread context: runs at once
+  ran = 0;
+  TEST_CHECK(deferred_work_post(work, 0, 0), "thread post refused");
+  TEST_CHECK(ran == 1, "thread post did not run at once");
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static void irq_handler(void *context)
+{
+  (void)context;
+
+  for (uint32_t i = 0; i < DEFERRED_WORK_RING_SIZE + TEST_EXTRA_POSTS; i++) {
+    if (!deferred_work_post(work, i, 0)) {
+      postsRefused++;
+    }
+  }
+}
+
+static void work(uint32_t arg0, uint32_t arg1)
+{
+  (void)arg1;
+
+  if (CORE_InIrqContext()) {
+    ranInIrq++;
+  }
+  if (arg0 != ran) {
+    outOfOrder++;
+  }
+  ran++;
+}
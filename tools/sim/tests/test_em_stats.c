@@ -0,0 +1,132 @@
+/**
+ * @file test_em_stats.c
+ * @brief Host test: EM residency counters against the simulated clock
+ *
+ * The simulation knows exactly how long the core spent in each energy mode.
+ * em_stats only sees power-manager transitions and sleeptimer ticks, so its
+ * figures may differ by tick rounding but must otherwise agree: residency
+ * per mode, entries into EM2 against wakes, EM0 time split by reason, and
+ * EM1 time covered by the requirements that caused it.
+ */
+
+#include "test.h"
+#include "em_stats.h"
+#include <stdio.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_SETTLE_MS              60000
+#define TEST_HOURS                  1
+#define TEST_TICK_US                31      // One 32768 Hz sleeptimer tick
+#define TEST_MIN_SENSOR_WAKES       300     // One per 10 s read, less slack
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static uint64_t difference(uint64_t a, uint64_t b);
+static void check_run(const char *name, uint64_t ms);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(true, NULL);
+  test_run_ms(TEST_SETTLE_MS);
+
+  check_run("joined", (uint64_t)TEST_HOURS * 3600u * 1000u);
+
+  // Reset really restarts the counters
+  EmStats_t stats;
+
+  em_stats_reset();
+  em_stats_get(&stats);
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    TEST_CHECK(stats.residencyUs[i] <= TEST_TICK_US && stats.entries[i] == 0,
+               "EM%u after reset: %llu us, %u entries", i,
+               (unsigned long long)stats.residencyUs[i], stats.entries[i]);
+  }
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static uint64_t difference(uint64_t a, uint64_t b)
+{
+  return (a > b) ? a - b : b - a;
+}
+
+/**
+ * @brief Run for @p ms and compare em_stats with the simulation over it
+ */
+static void check_run(const char *name, uint64_t ms)
+{
+  SimStats_t simBefore;
+  SimStats_t simAfter;
+  EmStats_t stats;
+
+  em_stats_reset();
+  sim_get_stats(&simBefore);
+  test_run_ms(ms);
+  sim_get_stats(&simAfter);
+  em_stats_get(&stats);
+
+  uint32_t wakes = simAfter.wakes - simBefore.wakes;
+  uint32_t transitions = 0;
+  uint64_t total = 0;
+
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    transitions += stats.entries[i];
+    total += stats.residencyUs[i];
+  }
+
+  // Ticks telescope; each interval only loses its sub-microsecond remainder
+  uint64_t slack = TEST_TICK_US * 2u + transitions;
+
+  TEST_CHECK(difference(total, ms * 1000u) <= slack, "%s: %llu us counted in %llu us",
+             name, (unsigned long long)total, (unsigned long long)(ms * 1000u));
+
+  for (uint8_t i = 0; i < EM_STATS_MODE_COUNT; i++) {
+    uint64_t simUs = simAfter.residencyUs[i] - simBefore.residencyUs[i];
+    uint64_t modeSlack = (uint64_t)TEST_TICK_US * (stats.entries[i] + 2u);
+
+    TEST_CHECK(difference(stats.residencyUs[i], simUs) <= modeSlack,
+               "%s: EM%u %llu us, simulation %llu us", name, i,
+               (unsigned long long)stats.residencyUs[i], (unsigned long long)simUs);
+    printf("%s: EM%u %12.3f ms (simulation %12.3f ms), %u entries\n", name, i,
+           stats.residencyUs[i] / 1e3, simUs / 1e3, stats.entries[i]);
+  }
+
+  TEST_CHECK(difference(stats.entries[EM_STATS_EM2], wakes) <= 1,
+             "%s: %u EM2 entries, %u wakes", name, stats.entries[EM_STATS_EM2], wakes);
+
+  // EM0 time is attributed to exactly one reason at a time
+  uint64_t reasonsUs = 0;
+  for (uint8_t i = 0; i < EM_STATS_REASON_COUNT; i++) {
+    reasonsUs += stats.em0ReasonUs[i];
+  }
+  TEST_CHECK(reasonsUs == stats.residencyUs[EM_STATS_EM0], "%s: EM0 %llu us, by reason %llu us",
+             name, (unsigned long long)stats.residencyUs[EM_STATS_EM0],
+             (unsigned long long)reasonsUs);
+
+  TEST_CHECK(stats.em0ReasonCount[EM_STATS_REASON_SENSOR] >= TEST_MIN_SENSOR_WAKES,
+             "%s: %u sensor wakes", name, stats.em0ReasonCount[EM_STATS_REASON_SENSOR]);
+
+  // The core only sleeps in EM1 while something holds the requirement
+  uint64_t heldUs = 0;
+  for (uint8_t i = 0; i < EM_STATS_REASON_COUNT; i++) {
+    heldUs += stats.em1ReasonUs[i];
+  }
+  TEST_CHECK(stats.em1ReasonCount[EM_STATS_REASON_I2C] > 0, "%s: no I2C EM1 holds", name);
+  TEST_CHECK(stats.residencyUs[EM_STATS_EM1] <= heldUs + slack,
+             "%s: %llu us in EM1, requirements held %llu us", name,
+             (unsigned long long)stats.residencyUs[EM_STATS_EM1],
+             (unsigned long long)heldUs);
+}
@@ -0,0 +1,260 @@
+/**
+ * @file test_i2c_bus.c
+ * @brief Host test: I2C engine completion, deadline and bus recovery
+ *
+ * Drives i2c_bus directly against a scripted device at a spare address
+ * while the firmware idles unjoined. Every transfer must complete exactly
+ * once with the right status, a missed deadline must abort and recover the
+ * bus, and the engine must be usable (and let the core reach EM2) after
+ * every failure.
+ */
+
+#include "test.h"
+#include "i2c_bus.h"
+#include <stdio.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_ADDR                   0x50
+#define TEST_TIMEOUT_MS             10
+#define TEST_STRETCH_US             50000   // Well past the deadline
+#define TEST_HOLD_PULSES            3       // Clocks the held SDA needs
+#define TEST_IDLE_MS                1000
+#define TEST_IDLE_EM2_MIN_US        990000  // Released EM1 -> sleeps
+
+//==============================================================================
+// Types
+//==============================================================================
+
+typedef enum {
+  DEVICE_ACK,
+  DEVICE_NACK,
+  DEVICE_STRETCH,                           // Hold SCL past the deadline
+  DEVICE_HOLD_SDA                           // Hold SDA until clocked free
+} DeviceBehaviour_t;
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static DeviceBehaviour_t behaviour = DEVICE_ACK;
+static uint32_t pulsesToRelease = 0;
+static uint32_t sclPulses = 0;
+
+static uint32_t completions = 0;
+static I2cBusStatus_t lastStatus = I2C_BUS_OK;
+static uint64_t completedUs = 0;
+
+static uint8_t txData[2] = { 0xA5, 0x5A };
+static I2C_TransferSeq_TypeDef seq;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static bool device_start(void);
+static bool device_write(const uint8_t *data, uint16_t len);
+static bool device_read(uint8_t *data, uint16_t len);
+static void scl_watch(bool high);
+static void transfer_done(I2cBusStatus_t status, void *context);
+static void run_transfer(DeviceBehaviour_t next, uint64_t *startedUs);
+static void check_idle_sleeps(const char *after);
+
+static const SimI2cDevice_t device = {
+  .start = device_start,
+  .write = device_write,
+  .read = device_read
+};
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  uint64_t startedUs;
+
+  test_boot(false, NULL);
+  sim_i2c_attach(TEST_ADDR, &device);
+  sim_gpio_watch(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, scl_watch);
+
+  seq.addr = TEST_ADDR << 1;
+  seq.flags = I2C_FLAG_WRITE;
+  seq.buf[0].data = txData;
+  seq.buf[0].len = sizeof(txData);
+
+  // Plain write: completes once, OK, well inside the deadline
+  run_transfer(DEVICE_ACK, &startedUs);
+  TEST_CHECK(completions == 1, "ACK: %u completions", completions);
+  TEST_CHECK(lastStatus == I2C_BUS_OK, "ACK: status %d", lastStatus);
+  TEST_CHECK(completedUs - startedUs < TEST_TIMEOUT_MS * 1000u,
+             "ACK: took %llu us", (unsigned long long)(completedUs - startedUs));
+  check_idle_sleeps("ACK");
+
+  // Second transfer while one is in flight is refused, the first finishes
+  TEST_CHECK(i2c_bus_transfer(&seq, TEST_TIMEOUT_MS, transfer_done, NULL),
+             "busy: first transfer refused");
+  TEST_CHECK(i2c_bus_is_busy(), "busy: engine idle with a transfer in flight");
+  TEST_CHECK(!i2c_bus_transfer(&seq, TEST_TIMEOUT_MS, transfer_done, NULL),
+             "busy: overlapping transfer accepted");
+  completions = 0;
+  test_run_ms(TEST_TIMEOUT_MS * 2);
+  TEST_CHECK(completions == 1 && lastStatus == I2C_BUS_OK,
+             "busy: %u completions, status %d", completions, lastStatus);
+
+  // Address NACK
+  run_transfer(DEVICE_NACK, &startedUs);
+  TEST_CHECK(completions == 1, "NACK: %u completions", completions);
+  TEST_CHECK(lastStatus == I2C_BUS_NACK, "NACK: status %d", lastStatus);
+  check_idle_sleeps("NACK");
+
+  // Stretch past the deadline: TIMEOUT at the deadline, and the late end of
+  // the stretched transfer must not complete it a second time
+  run_transfer(DEVICE_STRETCH, &startedUs);
+  TEST_CHECK(completions == 1, "stretch: %u completions", completions);
+  TEST_CHECK(lastStatus == I2C_BUS_TIMEOUT, "stretch: status %d", lastStatus);
+  TEST_CHECK(completedUs - startedUs >= TEST_TIMEOUT_MS * 1000u
+             && completedUs - startedUs < TEST_TIMEOUT_MS * 1000u + 1000u,
+             "stretch: timed out after %llu us",
+             (unsigned long long)(completedUs - startedUs));
+  test_run_ms(TEST_STRETCH_US / 1000u);
+  TEST_CHECK(completions == 1, "stretch: %u completions after the stretch ends",
+             completions);
+  run_transfer(DEVICE_ACK, &startedUs);
+  TEST_CHECK(lastStatus == I2C_BUS_OK, "after stretch: status %d", lastStatus);
+  check_idle_sleeps("stretch");
+
+  // SDA held mid-transfer: the deadline aborts, recovery clocks SCL until
+  // the device lets go, and the bus works again
+  sclPulses = 0;
+  run_transfer(DEVICE_HOLD_SDA, &startedUs);
+  TEST_CHECK(completions == 1, "held SDA: %u completions", completions);
+  TEST_CHECK(lastStatus == I2C_BUS_TIMEOUT, "held SDA: status %d", lastStatus);
+  TEST_CHECK(sclPulses == I2C_BUS_RECOVERY_PULSES,
+             "held SDA: %u recovery pulses", sclPulses);
+  TEST_CHECK(pulsesToRelease == 0, "held SDA: still held");
+  run_transfer(DEVICE_ACK, &startedUs);
+  TEST_CHECK(lastStatus == I2C_BUS_OK, "after held SDA: status %d", lastStatus);
+  check_idle_sleeps("held SDA");
+
+  // SDA shorted low before the transfer: recovery cannot free it, the
+  // transfer fails at once rather than waiting for the deadline
+  sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, false);
+  run_transfer(DEVICE_ACK, &startedUs);
+  TEST_CHECK(completions == 1, "shorted: %u completions", completions);
+  TEST_CHECK(lastStatus == I2C_BUS_ERROR, "shorted: status %d", lastStatus);
+  TEST_CHECK(completedUs - startedUs < TEST_TIMEOUT_MS * 1000u,
+             "shorted: failed after %llu us",
+             (unsigned long long)(completedUs - startedUs));
+  sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, true);
+  run_transfer(DEVICE_ACK, &startedUs);
+  TEST_CHECK(lastStatus == I2C_BUS_OK, "after short: status %d", lastStatus);
+  check_idle_sleeps("short");
+
+  // Blocking wrapper reports the same results
+  behaviour = DEVICE_NACK;
+  TEST_CHECK(i2c_bus_transfer_blocking(&seq, TEST_TIMEOUT_MS) == I2C_BUS_NACK,
+             "blocking: NACK not reported");
+  behaviour = DEVICE_STRETCH;
+  TEST_CHECK(i2c_bus_transfer_blocking(&seq, TEST_TIMEOUT_MS) == I2C_BUS_TIMEOUT,
+             "blocking: timeout not reported");
+  test_run_ms(TEST_STRETCH_US / 1000u);
+  behaviour = DEVICE_ACK;
+  TEST_CHECK(i2c_bus_transfer_blocking(&seq, TEST_TIMEOUT_MS) == I2C_BUS_OK,
+             "blocking: OK not reported");
+  check_idle_sleeps("blocking");
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+static bool device_start(void)
+{
+  return behaviour != DEVICE_NACK;
+}
+
+static bool device_write(const uint8_t *data, uint16_t len)
+{
+  (void)data;
+  (void)len;
+
+  if (behaviour == DEVICE_STRETCH) {
+    sim_i2c_stretch(TEST_STRETCH_US);
+  } else if (behaviour == DEVICE_HOLD_SDA) {
+    pulsesToRelease = TEST_HOLD_PULSES;
+    sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, false);
+  }
+
+  return true;
+}
+
+static bool device_read(uint8_t *data, uint16_t len)
+{
+  for (uint16_t i = 0; i < len; i++) {
+    data[i] = 0;
+  }
+  return true;
+}
+
+/**
+ * @brief Count rising SCL edges; a held SDA lets go after enough of them
+ */
+static void scl_watch(bool high)
+{
+  if (!high) {
+    return;
+  }
+
+  sclPulses++;
+  if (pulsesToRelease > 0 && --pulsesToRelease == 0) {
+    sim_gpio_set_input(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, true);
+  }
+}
+
+static void transfer_done(I2cBusStatus_t status, void *context)
+{
+  (void)context;
+
+  completions++;
+  lastStatus = status;
+  completedUs = sim_now_us();
+}
+
+/**
+ * @brief Start one transfer and run until well past its deadline
+ */
+static void run_transfer(DeviceBehaviour_t next, uint64_t *startedUs)
+{
+  behaviour = next;
+  completions = 0;
+  *startedUs = sim_now_us();
+
+  if (!i2c_bus_transfer(&seq, TEST_TIMEOUT_MS, transfer_done, NULL)) {
+    TEST_CHECK(false, "transfer refused (behaviour %d)", next);
+    return;
+  }
+  test_run_ms(TEST_TIMEOUT_MS * 2);
+  TEST_CHECK(!i2c_bus_is_busy(), "engine still busy (behaviour %d)", next);
+}
+
+/**
+ * @brief The engine dropped its EM1 requirement: an idle second is EM2
+ */
+static void check_idle_sleeps(const char *after)
+{
+  SimStats_t before;
+  SimStats_t now;
+
+  sim_get_stats(&before);
+  test_run_ms(TEST_IDLE_MS);
+  sim_get_stats(&now);
+
+  uint64_t em2Us = now.residencyUs[SIM_MODE_EM2] - before.residencyUs[SIM_MODE_EM2];
+  TEST_CHECK(em2Us >= TEST_IDLE_EM2_MIN_US, "%s: only %llu us of EM2 in an idle second",
+             after, (unsigned long long)em2Us);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file test_report_filter.c
+ * @brief Host test: a constant reading with noise is written once
+ *
+ * Noise of up to one quantum either way flips the rounded value between
+ * neighbouring quanta, worst when the reading sits on a rounding boundary.
+ * With the application's quantum and hysteresis none of that may reach the
+ * attribute: the first sample is written and nothing after it. Checked on
+ * the filter for every offset within a quantum, then end to end on the
+ * SHT31 model at a constant reading with its repeatability noise.
+ */
+
+#include "test.h"
+#include "app.h"
+#include "report_filter.h"
+#include <stdio.h>
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_SAMPLES                2000
+#define TEST_SEED                   0x2545F491u
+#define TEST_BOOT_MS                1000
+#define TEST_STEADY_MS              (6u * 3600u * 1000u)
+
+// Constant air on rounding boundaries of both attributes
+#define TEST_TEMPERATURE_C          21.05
+#define TEST_HUMIDITY_RH            45.05
+
+//==============================================================================
+// Private Variables
+//==============================================================================
+
+static uint32_t rngState = TEST_SEED;
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void check_filter(const char *name, int32_t quantum, int32_t hysteresis, int32_t base);
+static int32_t noise(int32_t amplitude);
+static uint32_t count_writes(uint16_t clusterId);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  for (int32_t offset = 0; offset < APP_TEMP_QUANTUM_CENTI; offset++) {
+    check_filter("temperature", APP_TEMP_QUANTUM_CENTI, APP_TEMP_HYSTERESIS_CENTI,
+                 2100 + offset);
+    check_filter("temperature", APP_TEMP_QUANTUM_CENTI, APP_TEMP_HYSTERESIS_CENTI,
+                 -500 - offset);
+  }
+  for (int32_t offset = 0; offset < APP_HUMIDITY_QUANTUM_CENTI; offset++) {
+    check_filter("humidity", APP_HUMIDITY_QUANTUM_CENTI, APP_HUMIDITY_HYSTERESIS_CENTI,
+                 4500 + offset);
+  }
+
+  // End to end: one write per attribute after the first sample
+  test_boot(true, NULL);
+
+  SimSht31Signal_t signal;
+
+  sim_sht31_get_signal(&signal);
+  signal.shape = SIM_SHT31_SHAPE_CONSTANT;
+  signal.temperatureC = TEST_TEMPERATURE_C;
+  signal.humidityRh = TEST_HUMIDITY_RH;
+  signal.noise = true;
+  sim_sht31_set_signal(&signal);
+
+  test_run_ms(TEST_BOOT_MS);
+  uint32_t temperatureBefore = count_writes(ZCL_TEMP_MEASUREMENT_CLUSTER_ID);
+  uint32_t humidityBefore = count_writes(ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID);
+
+  test_run_ms(TEST_STEADY_MS);
+  uint32_t temperatureWrites = count_writes(ZCL_TEMP_MEASUREMENT_CLUSTER_ID) - temperatureBefore;
+  uint32_t humidityWrites = count_writes(ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID)
+                            - humidityBefore;
+
+  TEST_CHECK(temperatureBefore > 0, "no temperature written after boot");
+  TEST_CHECK(temperatureWrites == 0, "%u temperature writes at a constant %.2f C",
+             temperatureWrites, TEST_TEMPERATURE_C);
+  TEST_CHECK(humidityWrites == 0, "%u humidity writes at a constant %.2f %%RH",
+             humidityWrites, TEST_HUMIDITY_RH);
+  printf("constant air: %u temperature, %u humidity writes in %u h after the first\n",
+         temperatureWrites, humidityWrites, TEST_STEADY_MS / 3600000u);
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Feed @p base plus up to one quantum of noise either way
+ * Only the first sample may be written; a real move past the hysteresis
+ * still is.
+ */
+static void check_filter(const char *name, int32_t quantum, int32_t hysteresis, int32_t base)
+{
+  ReportFilter_t filter = REPORT_FILTER_INIT(quantum, hysteresis);
+  int32_t written = 0;
+  int32_t out;
+
+  for (uint32_t i = 0; i < TEST_SAMPLES; i++) {
+    if (report_filter_update(&filter, base + noise(quantum), &out)) {
+      written = out;
+    }
+  }
+
+  TEST_CHECK(filter.committed == 1, "%s %d +/- %d: %u writes", name, base, quantum,
+             filter.committed);
+  TEST_CHECK(filter.committed + filter.suppressed == TEST_SAMPLES, "%s %d: %u samples counted",
+             name, base, filter.committed + filter.suppressed);
+
+  int32_t step = hysteresis + quantum;
+  TEST_CHECK(report_filter_update(&filter, written + step, &out) && out == written + step,
+             "%s %d: a move of %d not written", name, base, step);
+}
+
+/**
+ * @brief Uniform in [-amplitude, amplitude] (xorshift32)
+ */
+static int32_t noise(int32_t amplitude)
+{
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+
+  return (int32_t)(rngState % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+/**
+ * @brief MeasuredValue writes to @p clusterId so far
+ */
+static uint32_t count_writes(uint16_t clusterId)
+{
+  uint32_t writes = 0;
+
+  for (uint32_t i = 0; i < sim_stack_get_history_count(); i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+
+    if (write->clusterId == clusterId && write->attributeId == 0x0000
+        && write->manufacturerCode == 0) {
+      writes++;
+    }
+  }
+
+  return writes;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_sensor_health.c
+ * @brief Host test: sensor health from boot and with a dead sensor
+ *
+ * A healthy sensor must be healthy from the first sample: the soft reset
+ * at init is waited out, so no command is NACKed and no invalid value is
+ * written. In periodic mode a fetch NACK usually means "no new data", but
+ * a sensor that has gone away must still be reported as not responding.
+ */
+
+#include "test.h"
+#include "app.h"
+#include "sht31.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_BOOT_MS                2000
+#define TEST_SETTLE_MS              1000
+#define TEST_PERIODIC_RATE          SHT31_RATE_1_MPS
+#define TEST_PERIOD_MS              1000    // One result per fetch interval
+#define TEST_FAST_FETCH_MS          100     // Well inside one result period
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static uint32_t count_invalid_writes(void);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(true, NULL);
+  TEST_CHECK(sht31_is_present(), "sensor not detected at init");
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK, "health %d after init",
+             sht31_get_health());
+
+  // The boot sample succeeds: nothing invalid is ever written
+  test_run_ms(TEST_BOOT_MS);
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK, "health %d after the first sample",
+             sht31_get_health());
+  TEST_CHECK(sim_stack_get_history_count() > 0, "no sample written after boot");
+  TEST_CHECK(count_invalid_writes() == 0, "%u invalid values written after boot",
+             count_invalid_writes());
+
+  // Periodic mode, fetching faster than the rate: NACKs are "no data"
+  TEST_CHECK(sht31_set_mode(SHT31_MODE_PERIODIC, TEST_PERIODIC_RATE),
+             "periodic mode refused");
+  test_run_ms(TEST_PERIOD_MS + TEST_SETTLE_MS);
+
+  // Blocking reads (sht31_read()) take a no-data NACK the same way
+  int16_t temperature;
+  uint16_t humidity;
+
+  TEST_CHECK(sht31_read(&temperature, &humidity), "blocking fetch of a new result failed");
+  TEST_CHECK(!sht31_read(&temperature, &humidity), "blocking fetch returned data twice");
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK && sht31_is_present(),
+             "health %d after a blocking fetch with no new data", sht31_get_health());
+
+  for (uint32_t i = 0; i < 20; i++) {
+    app_start_sensor_measurement();
+    test_run_ms((i % 4 == 3) ? TEST_PERIOD_MS : TEST_FAST_FETCH_MS);
+  }
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK,
+             "health %d after fetching faster than the rate", sht31_get_health());
+
+  // Sensor gone: NACKs stay "no data" until no result has come for
+  // SHT31_FETCH_MISSED_PERIODS periods, then the sensor is not responding
+  app_start_sensor_measurement();
+  test_run_ms(TEST_SETTLE_MS);
+  sim_i2c_detach(SHT31_I2C_ADDR);
+  for (uint32_t i = 1; i < SHT31_FETCH_MISSED_PERIODS; i++) {
+    app_start_sensor_measurement();
+    test_run_ms(TEST_PERIOD_MS);
+    TEST_CHECK(sht31_get_health() == SHT31_HEALTH_OK,
+               "health %d %u periods after the last result", sht31_get_health(), i);
+  }
+  test_run_ms(TEST_FAST_FETCH_MS);
+  app_start_sensor_measurement();
+  test_run_ms(TEST_PERIOD_MS);
+  TEST_CHECK(sht31_get_health() == SHT31_HEALTH_NOT_RESPONDING,
+             "health %d %u periods after the last result", sht31_get_health(),
+             SHT31_FETCH_MISSED_PERIODS);
+  TEST_CHECK(!sht31_is_present(), "sensor still present");
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Invalid-measurement writes to either measured value
+ */
+static uint32_t count_invalid_writes(void)
+{
+  uint32_t invalid = 0;
+
+  for (uint32_t i = 0; i < sim_stack_get_history_count(); i++) {
+    const SimAttributeWrite_t *write = sim_stack_get_history(i);
+
+    // MeasuredValue is attribute 0x0000 in both clusters
+    if (write->attributeId != ZCL_TEMP_MEASURED_VALUE_ATTRIBUTE_ID) {
+      continue;
+    }
+    if ((write->clusterId == ZCL_TEMP_MEASUREMENT_CLUSTER_ID
+         && (int16_t)write->value == SHT31_INVALID_TEMPERATURE)
+        || (write->clusterId == ZCL_RELATIVE_HUMIDITY_MEASUREMENT_CLUSTER_ID
+            && (uint16_t)write->value == SHT31_INVALID_HUMIDITY)) {
+      invalid++;
+    }
+  }
+
+  return invalid;
+}
@@ -0,0 +1,106 @@
+/**
+ * @file test_state_timers.c
+ * @brief Host test: application timers follow the network state
+ *
+ * enter_state() arms the sensor, battery and fast-poll schedules on the way
+ * into the joined states and disarms them on the way out. An unjoined
+ * device must therefore have nothing armed once it settles, and take no
+ * wakes at all: after boot without a network, and again after a join and
+ * a leave taken with ALERT mode on, so the sensor was converting on its own.
+ */
+
+#include "test.h"
+#include "app.h"
+#include "sht31.h"
+
+//==============================================================================
+// Configuration
+//==============================================================================
+
+#define TEST_SETTLE_MS              5000    // In-flight work drains
+#define TEST_STEADY_MS              (3600u * 1000u)
+#define TEST_JOINED_MS              (APP_FAST_POLL_TIMEOUT_MS + APP_SENSOR_READ_PERIOD_MS * 3)
+
+//==============================================================================
+// Forward Declarations
+//==============================================================================
+
+static void check_unjoined_steady(const char *when);
+
+//==============================================================================
+// Public Functions
+//==============================================================================
+
+int main(void)
+{
+  test_boot(false, NULL);
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(app_get_state() == APP_STATE_NOT_JOINED, "state %d after boot", app_get_state());
+  check_unjoined_steady("after boot");
+
+  // Join: the fast-poll timeout and the sensor schedule are armed and run
+  uint32_t writesBefore = sim_stack_get_history_count();
+
+  app_start_join();
+  TEST_CHECK(app_get_state() == APP_STATE_JOINING, "state %d after join start",
+             app_get_state());
+  test_run_ms(sim_config()->joinMs + TEST_SETTLE_MS);
+  TEST_CHECK(app_get_state() == APP_STATE_JOINED_FAST_POLL, "state %d after join",
+             app_get_state());
+  TEST_CHECK(sim_event_count(SIM_SOURCE_TIMER) > 0, "no timer armed after join");
+
+  test_run_ms(TEST_JOINED_MS);
+  TEST_CHECK(app_get_state() == APP_STATE_JOINED_NORMAL, "state %d after the fast-poll timeout",
+             app_get_state());
+  TEST_CHECK(sim_stack_get_history_count() > writesBefore, "no sensor value written while joined");
+
+  // ALERT mode keeps the sensor converting on its own
+  app_set_sensor_alert_mode(true);
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(sht31_alert_is_enabled(), "ALERT not enabled while joined");
+
+  // Leave: everything is disarmed, ALERT included
+  app_leave_network();
+  TEST_CHECK(app_get_state() == APP_STATE_LEAVING, "state %d after leave start",
+             app_get_state());
+  test_run_ms(TEST_SETTLE_MS);
+  TEST_CHECK(app_get_state() == APP_STATE_NOT_JOINED, "state %d after leave", app_get_state());
+  TEST_CHECK(!sht31_alert_is_enabled(), "ALERT still enabled after leave");
+  TEST_CHECK(sht31_get_mode() == SHT31_MODE_SINGLE_SHOT, "sensor mode %d after leave",
+             sht31_get_mode());
+  check_unjoined_steady("after leave");
+
+  return test_finish();
+}
+
+//==============================================================================
+// Private Functions
+//==============================================================================
+
+/**
+ * @brief Nothing armed, and an hour passes without a single wake
+ */
+static void check_unjoined_steady(const char *when)
+{
+  SimStats_t before;
+  SimStats_t after;
+
+  TEST_CHECK(sim_event_count(SIM_SOURCE_TIMER) == 0, "%s: %u timers armed", when,
+             sim_event_count(SIM_SOURCE_TIMER));
+  TEST_CHECK(sim_periodic_timer_count() == 0, "%s: %u periodic timers running", when,
+             sim_periodic_timer_count());
+
+  sim_get_stats(&before);
+  test_run_ms(TEST_STEADY_MS);
+  sim_get_stats(&after);
+
+  TEST_CHECK(after.wakes == before.wakes, "%s: %u wakes in an hour unjoined", when,
+             after.wakes - before.wakes);
+  for (uint8_t i = 0; i < SIM_SOURCE_COUNT; i++) {
+    TEST_CHECK(after.wakesBySource[i] == before.wakesBySource[i],
+               "%s: %u wakes from source %u", when,
+               after.wakesBySource[i] - before.wakesBySource[i], i);
+  }
+  TEST_CHECK(app_get_state() == APP_STATE_NOT_JOINED, "%s: state %d an hour later", when,
+             app_get_state());
+}